@@ -64,6 +64,45 @@ void AST::convert(hlim::Circuit &circuit)
 
     for (auto &clk : circuit.getClocks())
         m_namespaceScope.allocateName(clk.get(), clk->getName());
+
+    deduplicateEntities();
+}
+
+/**
+ * @brief Emits structurally identical entities (e.g. multiple instances of the same generator) only once.
+ * @details Entities are compared by their VHDL code with the entity name masked out. They are processed by increasing height in the
+ * hierarchy so that parents of identical children refer to the same child entity and can in turn be identical. The first created
+ * entity of each set of identical ones keeps its declaration.
+ */
+void AST::deduplicateEntities()
+{
+    std::map<Entity*, size_t> heights;
+    std::function<size_t(Entity*)> computeHeight;
+    computeHeight = [&](Entity *entity) -> size_t {
+        size_t height = 0;
+        for (auto *subEnt : entity->getSubEntities())
+            height = std::max(height, computeHeight(subEnt) + 1);
+        for (auto &block : entity->getBlocks())
+            for (auto *subEnt : block->getSubEntities())
+                height = std::max(height, computeHeight(subEnt) + 1);
+        heights[entity] = height;
+        return height;
+    };
+    computeHeight(getRootEntity());
+
+    std::vector<std::pair<size_t, size_t>> order;
+    for (auto i : utils::Range<size_t>(1, m_entities.size()))
+        if (heights.contains(m_entities[i].get()))
+            order.push_back({heights[m_entities[i].get()], i});
+    std::sort(order.begin(), order.end());
+
+    std::map<std::string, Entity*> canonicalEntities;
+    for (auto [height, idx] : order) {
+        auto *entity = m_entities[idx].get();
+        auto [it, inserted] = canonicalEntities.try_emplace(entity->getStructuralVHDL(), entity);
+        if (!inserted)
+            entity->makeDuplicateOf(it->second);
+    }
 }
 
 Entity &AST::createEntity(const std::string &desiredName, BasicBlock *parent)
@@ -105,6 +144,7 @@ void AST::writeVHDL(std::filesystem::path destination)
         }
 
         for (auto& entity : m_entities) {
+            if (entity->isDuplicate()) continue;
             std::filesystem::path filePath = getFilename(destination, entity->getName());
 
             std::fstream file(filePath.string().c_str(), std::fstream::out);
@@ -120,7 +160,8 @@ std::vector<Entity*> AST::getDependencySortedEntities()
 
     std::function<void(Entity*)> reccurEntity;
     reccurEntity = [&](Entity *entity) {
-        reverseList.push_back(entity);
+        if (!entity->isDuplicate())
+            reverseList.push_back(entity);
         for (auto *subEnt : entity->getSubEntities())
             reccurEntity(subEnt);
         for (auto &block : entity->getBlocks())
@@ -85,6 +85,7 @@ class AST
 
         bool findLocalDeclaration(hlim::NodePort driver, std::vector<BaseGrouping*> &reversePath);
 
+        /// All entities that are written, children before their parents.
         std::vector<Entity*> getDependencySortedEntities();
     protected:
         CodeFormatting *m_codeFormatting;
@@ -94,6 +95,8 @@ class AST
         std::vector<std::unique_ptr<Package>> m_packages;
         Hlim2AstMapping m_mapping;
 
+        void deduplicateEntities();
+
 };
 
 }
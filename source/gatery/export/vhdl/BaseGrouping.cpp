@@ -140,12 +140,27 @@ void BaseGrouping::formatConstant(std::ostream &stream, const hlim::Node_Constan
     }
 }
 
+std::vector<hlim::NodePort> BaseGrouping::sortedByName(const std::set<hlim::NodePort> &signals) const
+{
+    std::vector<std::pair<std::string, hlim::NodePort>> named;
+    named.reserve(signals.size());
+    for (const auto &signal : signals)
+        named.push_back({m_namespaceScope.getName(signal), signal});
+    std::sort(named.begin(), named.end(), [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+
+    std::vector<hlim::NodePort> result;
+    result.reserve(named.size());
+    for (auto &entry : named)
+        result.push_back(entry.second);
+    return result;
+}
+
 void BaseGrouping::declareLocalSignals(std::ostream &stream, bool asVariables, unsigned indentation)
 {
    CodeFormatting &cf = m_ast.getCodeFormatting();
 
 
-    for (const auto &signal : m_constants) {
+    for (const auto &signal : sortedByName(m_constants)) {
         auto targetContext = hlim::outputIsBVec(signal)?Context::STD_LOGIC_VECTOR:Context::STD_LOGIC;
 
         cf.indent(stream, indentation+1);
@@ -156,7 +171,7 @@ void BaseGrouping::declareLocalSignals(std::ostream &stream, bool asVariables, u
         stream << "; "<< std::endl;
     }
 
-    for (const auto &signal : m_localSignals) {
+    for (const auto &signal : sortedByName(m_localSignals)) {
         cf.indent(stream, indentation+1);
         if (asVariables)
             stream << "VARIABLE ";
@@ -171,7 +186,7 @@ void BaseGrouping::declareLocalSignals(std::ostream &stream, bool asVariables, u
 
     hlim::ResolvedAttributes resolvedAttribs;
 
-    for (const auto &signal : m_localSignals) {
+    for (const auto &signal : sortedByName(m_localSignals)) {
 
         resolvedAttribs.clear();
 
@@ -83,6 +83,9 @@ class BaseGrouping
 
         void verifySignalsDisjoint();
 
+        /// Orders signals by their allocated names, so that the code does not depend on where nodes were allocated.
+        std::vector<hlim::NodePort> sortedByName(const std::set<hlim::NodePort> &signals) const;
+
         enum class Context {
             BOOL,
             STD_LOGIC,
@@ -348,7 +348,10 @@ void BasicBlock::writeStatementsVHDL(std::ostream &stream, unsigned indent)
             case ConcurrentStatement::TYPE_EXT_NODE_INSTANTIATION: {
                 auto *node = m_externalNodes[statement.ref.externalNodeIdx];
                 cf.indent(stream, indent);
-                stream << m_externalNodeInstanceNames[statement.ref.externalNodeIdx] << " : entity " << node->getName() << std::endl;
+                stream << m_externalNodeInstanceNames[statement.ref.externalNodeIdx] << " : entity ";
+                if (!node->getLibraryName().empty())
+                    stream << node->getLibraryName() << '.';
+                stream << node->getName() << std::endl;
                 
                 if (!node->getGenericParameters().empty()) {
                     cf.indent(stream, indent);
@@ -391,13 +394,20 @@ void BasicBlock::writeStatementsVHDL(std::ostream &stream, unsigned indent)
                     if (node->getDriver(i).node != nullptr) {
                         std::stringstream line;
                         line << node->getInputName(i) << " => ";
-                        line << m_namespaceScope.getName(node->getDriver(i));
+                        // Vendor primitives take STD_LOGIC_VECTOR while bit vectors are exported as UNSIGNED
+                        if (hlim::outputIsBVec(node->getDriver(i)))
+                            line << "STD_LOGIC_VECTOR(" << m_namespaceScope.getName(node->getDriver(i)) << ')';
+                        else
+                            line << m_namespaceScope.getName(node->getDriver(i));
                         portmapList.push_back(line.str());
                     }
 
                 for (auto i : utils::Range(node->getNumOutputPorts())) {
                     std::stringstream line;
-                    line << node->getOutputName(i) << " => ";
+                    if (hlim::outputIsBVec({.node = node, .port = i}))
+                        line << "UNSIGNED(" << node->getOutputName(i) << ") => ";
+                    else
+                        line << node->getOutputName(i) << " => ";
                     line << m_namespaceScope.getName({.node = node, .port = i});
                     portmapList.push_back(line.str());
                 }
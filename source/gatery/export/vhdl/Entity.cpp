@@ -26,9 +26,11 @@
 
 #include "../../hlim/Clock.h"
 #include "../../hlim/coreNodes/Node_Pin.h"
+#include "../../hlim/supportNodes/Node_External.h"
 
 
 #include <memory>
+#include <set>
 
 namespace gtry::vhdl {
 
@@ -121,6 +123,20 @@ void Entity::writeLibrariesVHDL(std::ostream &stream)
            << "USE ieee.std_logic_1164.ALL;" << std::endl
            << "USE ieee.numeric_std.all;" << std::endl << std::endl;
 
+    // Libraries of instantiated vendor primitives
+    std::set<std::string> libraries;
+    for (auto *extNode : m_externalNodes)
+        if (!extNode->getLibraryName().empty())
+            libraries.insert(extNode->getLibraryName());
+    for (const auto &block : m_blocks)
+        for (auto *extNode : block->getExternalNodes())
+            if (!extNode->getLibraryName().empty())
+                libraries.insert(extNode->getLibraryName());
+    for (const auto &library : libraries)
+        stream << "LIBRARY " << library << ';' << std::endl;
+    if (!libraries.empty())
+        stream << std::endl;
+
     // Import everything for now
     for (const auto &package : m_ast.getPackages())
         package->writeImportStatement(stream);
@@ -222,6 +238,23 @@ void Entity::writeVHDL(std::ostream &stream)
     stream << "END impl;" << std::endl;
 }
 
+void Entity::makeDuplicateOf(Entity *canonical)
+{
+    HCL_ASSERT(!canonical->isDuplicate());
+    m_canonicalEntity = canonical;
+    m_name = canonical->getName();
+}
+
+std::string Entity::getStructuralVHDL()
+{
+    std::string name = std::move(m_name);
+    m_name = "structurally_identical_entity";
+    std::stringstream stream;
+    writeVHDL(stream);
+    m_name = std::move(name);
+    return stream.str();
+}
+
 void Entity::writeInstantiationVHDL(std::ostream &stream, unsigned indent, const std::string &instanceName)
 {
     CodeFormatting &cf = m_ast.getCodeFormatting();
@@ -39,6 +39,12 @@ class Entity : public BasicBlock
 
         inline const std::string &getName() const { return m_name; }
 
+        /// Marks this entity as structurally identical to canonical, it is then instantiated under the name of canonical and not written itself.
+        void makeDuplicateOf(Entity *canonical);
+        inline bool isDuplicate() const { return m_canonicalEntity != nullptr; }
+        /// The VHDL code of this entity with a placeholder name, equal for entities that can share one declaration.
+        std::string getStructuralVHDL();
+
         void buildFrom(hlim::NodeGroup *nodeGroup);
 
         virtual void extractSignals() override;
@@ -57,6 +63,7 @@ class Entity : public BasicBlock
         virtual std::string getInstanceName() override;
     protected:
         std::vector<std::unique_ptr<Block>> m_blocks;
+        Entity *m_canonicalEntity = nullptr;
 
         virtual void writeLibrariesVHDL(std::ostream &stream);
         virtual std::vector<std::string> getPortsVHDL();
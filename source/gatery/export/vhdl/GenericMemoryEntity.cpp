@@ -49,6 +49,7 @@ void GenericMemoryEntity::buildFrom(hlim::MemoryGroup *memGrp)
         auto enInput = wp.node->getDriver((unsigned)hlim::Node_MemPort::Inputs::enable);
         auto wrEnInput = wp.node->getDriver((unsigned)hlim::Node_MemPort::Inputs::wrEnable);
         auto dataInput = wp.node->getDriver((unsigned)hlim::Node_MemPort::Inputs::wrData);
+        auto byteEnableInput = wp.node->getDriver((unsigned)hlim::Node_MemPort::Inputs::wrByteEnable);
 
         HCL_ASSERT_HINT(enInput == wrEnInput, "For now I don't want to mix read and write ports, so wrEn == en always.");
 
@@ -58,6 +59,8 @@ void GenericMemoryEntity::buildFrom(hlim::MemoryGroup *memGrp)
             m_inputs.insert(enInput);
         if (dataInput.node != nullptr)
             m_inputs.insert(dataInput);
+        if (byteEnableInput.node != nullptr)
+            m_inputs.insert(byteEnableInput);
 
         m_inputClocks.insert(wp.node->getClocks()[0]);
     }
@@ -262,9 +265,25 @@ void GenericMemoryEntity::writeStatementsVHDL(std::ostream &stream, unsigned ind
 
                     auto addrPort = wp.node->getDriver((unsigned)hlim::Node_MemPort::Inputs::address);
                     auto dataPort = wp.node->getDriver((unsigned)hlim::Node_MemPort::Inputs::wrData);
+                    auto byteEnablePort = wp.node->getDriver((unsigned)hlim::Node_MemPort::Inputs::wrByteEnable);
 
-                    cf.indent(stream, indent);
-                    stream << "memory(to_integer(" << m_namespaceScope.getName(addrPort) << ")) <= " << m_namespaceScope.getName(dataPort) << ";\n";
+                    if (byteEnablePort.node == nullptr) {
+                        cf.indent(stream, indent);
+                        stream << "memory(to_integer(" << m_namespaceScope.getName(addrPort) << ")) <= " << m_namespaceScope.getName(dataPort) << ";\n";
+                    } else {
+                        // One write per lane, this is the pattern synthesis tools recognize as byte wide write enables.
+                        size_t numLanes = hlim::getOutputWidth(byteEnablePort);
+                        size_t laneWidth = wp.node->getBitWidth() / numLanes;
+                        for (auto lane : utils::Range(numLanes)) {
+                            cf.indent(stream, indent);
+                            stream << "IF (" << m_namespaceScope.getName(byteEnablePort) << "(" << lane << ") = '1') THEN\n";
+                            cf.indent(stream, indent+1);
+                            stream << "memory(to_integer(" << m_namespaceScope.getName(addrPort) << "))(" << (lane+1)*laneWidth-1 << " downto " << lane*laneWidth << ")"
+                                << " <= " << m_namespaceScope.getName(dataPort) << "(" << (lane+1)*laneWidth-1 << " downto " << lane*laneWidth << ");\n";
+                            cf.indent(stream, indent);
+                            stream << "END IF;\n";
+                        }
+                    }
 
                     if (enablePort.node != nullptr) {
                         indent--;
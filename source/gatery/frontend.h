@@ -31,10 +31,12 @@
 #include "frontend/ConditionalScope.h"
 #include "frontend/Constant.h"
 #include "frontend/ConstructFrom.h"
+#include "frontend/ElaborationCache.h"
 #include "frontend/FrontendUnitTestSimulationFixture.h"
 #include "frontend/FSM.h"
 #include "frontend/Memory.h"
 #include "frontend/Pack.h"
+#include "frontend/ParallelElaboration.h"
 #include "frontend/Pin.h"
 #include "frontend/PriorityConditional.h"
 #include "frontend/Reg.h"
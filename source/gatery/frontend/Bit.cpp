@@ -257,15 +257,25 @@ namespace gtry {
         {
             std::string in_name = in.node->getName();
 
-            auto* rewire = DesignScope::createNode<hlim::Node_Rewire>(2);
-            rewire->connectInput(0, getRawDriver());
-            rewire->connectInput(1, in);
-            rewire->changeOutputType(type);
-
             size_t offset = std::min(m_offset, type.width - 1); // used for msb alias, but can alias any future offset
-            rewire->setReplaceRange(offset);
 
-            in = SignalReadPort(rewire);
+            if (auto* fusableRewire = getFusableSliceRewire(m_node)) {
+                // Merge consecutive bit assignments into one rewire instead of building a chain of full width rewires.
+                hlim::Node_Rewire::RewireOperation op;
+                op.addInput(0, 0, offset);
+                op.addInput(1, 0, 1);
+                op.addInput(0, offset + 1, type.width - (offset + 1));
+                fusableRewire->fuseSubsequentOp(op, in);
+                in = SignalReadPort(fusableRewire);
+            } else {
+                auto* rewire = DesignScope::createNode<hlim::Node_Rewire>(2);
+                rewire->connectInput(0, getRawDriver());
+                rewire->connectInput(1, in);
+                rewire->changeOutputType(type);
+                rewire->setReplaceRange(offset);
+
+                in = SignalReadPort(rewire);
+            }
 /*
             {
                 auto* signal = DesignScope::createNode<hlim::Node_Signal>();
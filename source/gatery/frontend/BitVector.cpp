@@ -373,11 +373,18 @@ namespace gtry {
             HCL_ASSERT(!incrementWidth);
             std::string in_name = in.node->getName();
 
-            auto* rewire = DesignScope::createNode<hlim::Node_Rewire>(2);
-            rewire->connectInput(0, getRawDriver());
-            rewire->connectInput(1, in);
-            rewire->setOp(replaceSelection(m_range, m_node->getOutputConnectionType(0).width));
-            in.node = rewire;
+            auto op = replaceSelection(m_range, m_node->getOutputConnectionType(0).width);
+            if (auto* fusableRewire = getFusableSliceRewire(m_node)) {
+                // Merge consecutive slice assignments into one rewire instead of building a chain of full width rewires.
+                fusableRewire->fuseSubsequentOp(op, in);
+                in.node = fusableRewire;
+            } else {
+                auto* rewire = DesignScope::createNode<hlim::Node_Rewire>(2);
+                rewire->connectInput(0, getRawDriver());
+                rewire->connectInput(1, in);
+                rewire->setOp(std::move(op));
+                in.node = rewire;
+            }
             in.port = 0;
 /*
             {
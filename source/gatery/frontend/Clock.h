@@ -131,6 +131,7 @@ namespace gtry {
     {
         public:
             ClockScope(Clock &clock) : m_clock(clock) { }
+            static ClockScope *get() { return m_currentScope; }
             static Clock &getClk() {
                 HCL_DESIGNCHECK_HINT(m_currentScope != nullptr, "No clock scope active!");
                 return m_currentScope->m_clock;
@@ -39,6 +39,9 @@ namespace gtry {
             hlim::NodePort getFullCondition() const { return m_fullCondition; }
             size_t getId() const { return m_id; }
 
+            /// Reserves an id that no scope of this thread uses, for remapping the ids of nodes built on other threads.
+            static size_t allocateId() { return s_nextId++; }
+
         private:
             void setCondition(hlim::NodePort port);
 
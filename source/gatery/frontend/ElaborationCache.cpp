@@ -0,0 +1,251 @@
+/*  This file is part of Gatery, a library for circuit design.
+	Copyright (C) 2021 Michael Offel, Andreas Ley
+
+	Gatery is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 3 of the License, or (at your option) any later version.
+
+	Gatery is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#include "gatery/pch.h"
+#include "ElaborationCache.h"
+
+#include "Scope.h"
+#include "Clock.h"
+
+#include <gatery/hlim/Circuit.h>
+#include <gatery/hlim/coreNodes/Node_Signal.h>
+#include <gatery/hlim/postprocessing/MemoryDetector.h>
+
+namespace gtry {
+
+namespace {
+
+/// Mirrors the group hierarchy of src into dst and moves the mapped nodes into their groups.
+void cloneGroupTree(const hlim::NodeGroup *src, hlim::NodeGroup *dst, const std::map<hlim::BaseNode*, hlim::BaseNode*> &mapSrc2Dst)
+{
+    dst->setName(src->getName());
+    dst->setInstanceName(src->getInstanceName());
+    dst->setComment(src->getComment());
+
+    for (auto *node : src->getNodes())
+        mapSrc2Dst.at(node)->moveToGroup(dst);
+
+    for (const auto &child : src->getChildren())
+        cloneGroupTree(child.get(), dst->addChildNodeGroup(child->getGroupType()), mapSrc2Dst);
+}
+
+void collectNodes(const hlim::NodeGroup *group, std::vector<hlim::BaseNode*> &nodes)
+{
+    nodes.insert(nodes.end(), group->getNodes().begin(), group->getNodes().end());
+    for (const auto &child : group->getChildren())
+        collectNodes(child.get(), nodes);
+}
+
+bool containsSpecialGroups(const hlim::NodeGroup *group)
+{
+    if (dynamic_cast<const hlim::MemoryGroup*>(group)) return true;
+    for (const auto &child : group->getChildren())
+        if (containsSpecialGroups(child.get())) return true;
+    return false;
+}
+
+}
+
+ElaborationCache::ElaborationCache(std::filesystem::path directory) : m_cache(std::move(directory))
+{
+}
+
+ElaborationCache::~ElaborationCache() = default;
+
+std::vector<SignalReadPort> ElaborationCache::elaborate(std::string_view name, std::string_view fingerprint, const std::vector<SignalReadPort> &inputs, const Generator &generator)
+{
+    // The interface is part of the key since the generator can not produce the same entity for different input widths.
+    std::string key = std::string(name) + '\n' + std::string(fingerprint);
+    for (const auto &input : inputs)
+        key += '\n' + std::to_string(connType(input).interpretation) + ':' + std::to_string(connType(input).width);
+
+    if (const auto *tmpl = findTemplate(key)) {
+        m_numHits++;
+        return instantiate(*tmpl, inputs);
+    }
+    m_numMisses++;
+
+    GroupScope entity(GroupScope::GroupType::ENTITY);
+    entity.setName(std::string(name));
+
+    // Explicit boundary signals separate the entity from the design and mark the interface in the template.
+    std::vector<hlim::Node_Signal*> inputSignals;
+    std::vector<SignalReadPort> generatorInputs;
+    for (const auto &input : inputs) {
+        auto *signal = DesignScope::createNode<hlim::Node_Signal>();
+        signal->setConnectionType(connType(input));
+        signal->connectInput(input);
+        inputSignals.push_back(signal);
+        generatorInputs.push_back(SignalReadPort(signal, input.expansionPolicy));
+    }
+
+    auto generatorOutputs = generator(generatorInputs);
+
+    std::vector<hlim::Node_Signal*> outputSignals;
+    std::vector<SignalReadPort> outputs;
+    for (const auto &output : generatorOutputs) {
+        auto *signal = DesignScope::createNode<hlim::Node_Signal>();
+        signal->setConnectionType(connType(output));
+        signal->connectInput(output);
+        outputSignals.push_back(signal);
+        outputs.push_back(SignalReadPort(signal));
+    }
+
+    if (auto tmpl = buildTemplate(GroupScope::getCurrentNodeGroup(), inputSignals, outputSignals)) {
+        m_cache.store(key, *tmpl);
+        m_templates[key] = std::move(tmpl);
+    }
+
+    return outputs;
+}
+
+const hlim::Circuit *ElaborationCache::findTemplate(const std::string &key)
+{
+    auto it = m_templates.find(key);
+    if (it != m_templates.end())
+        return it->second.get();
+
+    auto tmpl = std::make_unique<hlim::Circuit>();
+    if (!m_cache.load(key, *tmpl))
+        return nullptr;
+    if (tmpl->getRootNodeGroup()->getChildren().size() != 1)
+        return nullptr;
+
+    auto &entry = m_templates[key];
+    entry = std::move(tmpl);
+    return entry.get();
+}
+
+std::unique_ptr<hlim::Circuit> ElaborationCache::buildTemplate(hlim::NodeGroup *group, const std::vector<hlim::Node_Signal*> &inputSignals, const std::vector<hlim::Node_Signal*> &outputSignals)
+{
+    if (containsSpecialGroups(group))
+        return {};
+
+    std::vector<hlim::BaseNode*> nodes;
+    collectNodes(group, nodes);
+    std::set<hlim::BaseNode*> insideNodes(nodes.begin(), nodes.end());
+    std::set<hlim::BaseNode*> inputNodes(inputSignals.begin(), inputSignals.end());
+    std::set<hlim::BaseNode*> boundaryNodes = inputNodes;
+    boundaryNodes.insert(outputSignals.begin(), outputSignals.end());
+
+    hlim::Clock *clock = nullptr;
+    for (auto *node : nodes) {
+        // Anything the generator read from the design other than its inputs would be lost on reuse.
+        if (!inputNodes.contains(node))
+            for (auto i : utils::Range(node->getNumInputPorts())) {
+                auto driver = node->getDriver(i);
+                if (driver.node != nullptr && !insideNodes.contains(driver.node))
+                    return {};
+            }
+
+        for (auto *nodeClock : node->getClocks()) {
+            if (nodeClock == nullptr) continue;
+            if (clock != nullptr && clock != nodeClock) return {};
+            clock = nodeClock;
+        }
+    }
+    if (clock != nullptr && (ClockScope::get() == nullptr || ClockScope::getClk().getClk() != clock))
+        return {};
+
+    // Boundary signals first so that they can be identified by their position, the rest in creation order for a stable content hash.
+    std::vector<hlim::BaseNode*> orderedNodes(inputSignals.begin(), inputSignals.end());
+    orderedNodes.insert(orderedNodes.end(), outputSignals.begin(), outputSignals.end());
+    std::vector<hlim::BaseNode*> innerNodes;
+    for (auto *node : nodes)
+        if (!boundaryNodes.contains(node))
+            innerNodes.push_back(node);
+    std::sort(innerNodes.begin(), innerNodes.end(), [](hlim::BaseNode *lhs, hlim::BaseNode *rhs) { return lhs->getId() < rhs->getId(); });
+    orderedNodes.insert(orderedNodes.end(), innerNodes.begin(), innerNodes.end());
+
+    auto tmpl = std::make_unique<hlim::Circuit>();
+
+    std::map<hlim::BaseNode*, hlim::BaseNode*> mapSrc2Dst;
+    for (auto *node : orderedNodes)
+        mapSrc2Dst[node] = tmpl->createUnconnectedClone(node);
+
+    cloneGroupTree(group, tmpl->getRootNodeGroup()->addChildNodeGroup(group->getGroupType()), mapSrc2Dst);
+    for (auto *node : inputSignals)
+        mapSrc2Dst[node]->moveToGroup(tmpl->getRootNodeGroup());
+    for (auto *node : outputSignals)
+        mapSrc2Dst[node]->moveToGroup(tmpl->getRootNodeGroup());
+
+    // Restored entities always use the clock of the current ClockScope, the template only needs a placeholder.
+    hlim::Clock *tmplClock = nullptr;
+    if (clock != nullptr)
+        tmplClock = tmpl->createClock<hlim::RootClock>(clock->getName(), clock->getAbsoluteFrequency());
+
+    for (auto *node : orderedNodes) {
+        auto *clone = mapSrc2Dst[node];
+        for (auto i : utils::Range(node->getNumInputPorts())) {
+            auto driver = node->getDriver(i);
+            if (driver.node != nullptr && insideNodes.contains(driver.node))
+                clone->rewireInput(i, {.node = mapSrc2Dst[driver.node], .port = driver.port});
+        }
+        for (auto i : utils::Range(node->getClocks().size()))
+            if (node->getClocks()[i] != nullptr)
+                clone->attachClock(tmplClock, i);
+    }
+
+    return tmpl;
+}
+
+std::vector<SignalReadPort> ElaborationCache::instantiate(const hlim::Circuit &tmpl, const std::vector<SignalReadPort> &inputs)
+{
+    auto &circuit = DesignScope::get()->getCircuit();
+    const auto *tmplEntity = tmpl.getRootNodeGroup()->getChildren().front().get();
+    const auto &boundaryNodes = tmpl.getRootNodeGroup()->getNodes();
+    HCL_ASSERT(boundaryNodes.size() >= inputs.size());
+
+    // Check before cloning, so that a missing clock scope does not leave a partial instance in the design.
+    bool clocked = false;
+    for (const auto &node : tmpl.getNodes())
+        for (auto *nodeClock : node->getClocks())
+            clocked |= nodeClock != nullptr;
+    HCL_DESIGNCHECK_HINT(!clocked || ClockScope::get() != nullptr, "A cached entity with registers or memories must be instantiated within a clock scope.");
+    hlim::Clock *clock = clocked ? ClockScope::getClk().getClk() : nullptr;
+
+    std::map<hlim::BaseNode*, hlim::BaseNode*> mapSrc2Dst;
+    for (const auto &node : tmpl.getNodes())
+        mapSrc2Dst[node.get()] = circuit.createUnconnectedClone(node.get());
+
+    GroupScope entity(tmplEntity->getGroupType());
+    cloneGroupTree(tmplEntity, GroupScope::getCurrentNodeGroup(), mapSrc2Dst);
+    for (auto *node : boundaryNodes)
+        mapSrc2Dst[node]->moveToGroup(GroupScope::getCurrentNodeGroup());
+
+    for (const auto &node : tmpl.getNodes()) {
+        auto *clone = mapSrc2Dst[node.get()];
+        for (auto i : utils::Range(node->getNumInputPorts())) {
+            auto driver = node->getDriver(i);
+            if (driver.node != nullptr)
+                clone->rewireInput(i, {.node = mapSrc2Dst[driver.node], .port = driver.port});
+        }
+        for (auto i : utils::Range(node->getClocks().size()))
+            if (node->getClocks()[i] != nullptr)
+                clone->attachClock(clock, i);
+    }
+
+    for (auto i : utils::Range(inputs.size()))
+        mapSrc2Dst[boundaryNodes[i]]->rewireInput(0, inputs[i]);
+
+    std::vector<SignalReadPort> outputs;
+    for (auto i : utils::Range(inputs.size(), boundaryNodes.size()))
+        outputs.push_back(SignalReadPort(mapSrc2Dst[boundaryNodes[i]]));
+    return outputs;
+}
+
+}
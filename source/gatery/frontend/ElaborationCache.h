@@ -0,0 +1,69 @@
+/*  This file is part of Gatery, a library for circuit design.
+	Copyright (C) 2021 Michael Offel, Andreas Ley
+
+	Gatery is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 3 of the License, or (at your option) any later version.
+
+	Gatery is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#pragma once
+
+#include "Signal.h"
+
+#include <gatery/hlim/CircuitCache.h>
+
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace gtry {
+
+/**
+ * @brief Reuses elaborated entities across elaboration runs instead of running their generators again.
+ * @details Each entity is identified by a fingerprint that the user derives from everything the generator depends on,
+ * e.g. its parameters and a hash of its source. On the first elaboration, the entity is stored as a small template circuit,
+ * in memory and on disk through a hlim::CircuitCache. Later elaborations with the same fingerprint, in this or in a later run,
+ * clone the template into the design and only dirty entities are elaborated again.
+ *
+ * The generator must access the rest of the design only through its inputs and may use at most the clock of the current ClockScope.
+ * Entities that violate this are elaborated normally every time, entities with nodes that can not be serialized are only reused within the same run.
+ * Signals inside restored entities are not accessible to the caller, only the returned outputs are.
+ */
+class ElaborationCache
+{
+    public:
+        using Generator = std::function<std::vector<SignalReadPort>(const std::vector<SignalReadPort> &inputs)>;
+
+        ElaborationCache(std::filesystem::path directory);
+        ~ElaborationCache();
+
+        /// Builds an entity of the given name from the inputs, either by running the generator or by restoring it from the cache.
+        std::vector<SignalReadPort> elaborate(std::string_view name, std::string_view fingerprint, const std::vector<SignalReadPort> &inputs, const Generator &generator);
+
+        inline size_t getNumHits() const { return m_numHits; }
+        inline size_t getNumMisses() const { return m_numMisses; }
+    protected:
+        hlim::CircuitCache m_cache;
+        std::map<std::string, std::unique_ptr<hlim::Circuit>, std::less<>> m_templates;
+        size_t m_numHits = 0;
+        size_t m_numMisses = 0;
+
+        const hlim::Circuit *findTemplate(const std::string &key);
+        std::vector<SignalReadPort> instantiate(const hlim::Circuit &tmpl, const std::vector<SignalReadPort> &inputs);
+        std::unique_ptr<hlim::Circuit> buildTemplate(hlim::NodeGroup *group, const std::vector<hlim::Node_Signal*> &inputSignals, const std::vector<hlim::Node_Signal*> &outputSignals);
+};
+
+}
@@ -61,6 +61,24 @@ namespace gtry {
             operator Data() const { return read(); }
 
             void write(const Data& value) {
+                createWritePort(value);
+            }
+
+            /// Writes only the lanes of the word whose byte enable bit is set, the word is split into byteEnable.size() equally sized lanes.
+            void write(const Data& value, const BVec& byteEnable) {
+                HCL_DESIGNCHECK_HINT(byteEnable.size() > 0 && m_wordSize % byteEnable.size() == 0, "The word width of a memory must be a multiple of the number of byte enable bits.");
+                auto *writePort = createWritePort(value);
+                writePort->connectWrByteEnable(byteEnable.getReadPort());
+            }
+
+            MemoryPortFactory<Data>& operator = (const Data& value) { write(value); return *this; }
+        protected:
+            hlim::NodePtr<hlim::Node_Memory> m_memoryNode;
+            Data m_defaultValue;
+            BVec m_address;
+            std::size_t m_wordSize;
+
+            hlim::Node_MemPort *createWritePort(const Data& value) {
                 BVec packedValue = pack(value);
 
                 HCL_DESIGNCHECK_HINT(packedValue.size() == m_wordSize, "The width of data assigned to a memory write port must match the previously specified word width of the memory or memory view.");
@@ -75,15 +93,9 @@ namespace gtry {
                 writePort->connectAddress(m_address.getReadPort());
                 writePort->connectWrData(packedValue.getReadPort());
                 writePort->setClock(ClockScope::getClk().getClk());
+                return writePort;
             }
 
-            MemoryPortFactory<Data>& operator = (const Data& value) { write(value); return *this; }
-        protected:
-            hlim::NodePtr<hlim::Node_Memory> m_memoryNode;
-            Data m_defaultValue;
-            BVec m_address;
-            std::size_t m_wordSize;
-
             Bit constructEnableBit() const {
                 Bit enable;
                 if (auto* scope = gtry::ConditionalScope::get())
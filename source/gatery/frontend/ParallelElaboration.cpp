@@ -0,0 +1,190 @@
+/*  This file is part of Gatery, a library for circuit design.
+	Copyright (C) 2021 Michael Offel, Andreas Ley
+
+	Gatery is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 3 of the License, or (at your option) any later version.
+
+	Gatery is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#include "gatery/pch.h"
+#include "ParallelElaboration.h"
+
+#include "Scope.h"
+#include "Clock.h"
+#include "ConditionalScope.h"
+
+#include <gatery/hlim/Circuit.h>
+#include <gatery/hlim/coreNodes/Node_Signal.h>
+#include <gatery/hlim/coreNodes/Node_Register.h>
+#include <gatery/hlim/coreNodes/Node_Multiplexer.h>
+
+#include <atomic>
+#include <exception>
+#include <thread>
+
+namespace gtry {
+
+struct ParallelElaboration::Task
+{
+    std::string name;
+    std::vector<SignalReadPort> inputs;
+    Generator generator;
+
+    /// Node pool the entity is moved into once it is built, the worker's own circuit dies with its DesignScope.
+    hlim::Circuit pool;
+    hlim::Clock *placeholderClock = nullptr;
+    std::vector<hlim::Node_Signal*> inputSignals;
+    std::vector<hlim::Node_Signal*> outputSignals;
+    std::exception_ptr exception;
+};
+
+namespace {
+
+struct ClockTemplate
+{
+    std::string name;
+    hlim::ClockRational frequency;
+    hlim::RegisterAttributes regAttribs;
+};
+
+}
+
+ParallelElaboration::ParallelElaboration(size_t numThreads) : m_numThreads(numThreads)
+{
+    if (m_numThreads == 0)
+        m_numThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+ParallelElaboration::~ParallelElaboration() = default;
+
+size_t ParallelElaboration::add(std::string name, std::vector<SignalReadPort> inputs, Generator generator)
+{
+    auto task = std::make_unique<Task>();
+    task->name = std::move(name);
+    task->inputs = std::move(inputs);
+    task->generator = std::move(generator);
+    m_tasks.push_back(std::move(task));
+    return m_tasks.size()-1;
+}
+
+std::vector<std::vector<SignalReadPort>> ParallelElaboration::run()
+{
+    // Workers must not attach nodes to clocks of the design since that modifies the clock, they get a placeholder clock instead.
+    hlim::Clock *clock = ClockScope::get() != nullptr ? ClockScope::getClk().getClk() : nullptr;
+    std::optional<ClockTemplate> clockTemplate;
+    if (clock != nullptr)
+        clockTemplate = ClockTemplate{ .name = clock->getName(), .frequency = clock->getAbsoluteFrequency(), .regAttribs = clock->getRegAttribs() };
+
+    auto elaborate = [&](Task &task) {
+        DesignScope design;
+
+        std::optional<Clock> placeholder;
+        std::optional<ClockScope> clockScope;
+        if (clockTemplate) {
+            placeholder.emplace(ClockConfig{}.setAbsoluteFrequency(clockTemplate->frequency).setName(clockTemplate->name));
+            placeholder->getClk()->getRegAttribs() = clockTemplate->regAttribs;
+            clockScope.emplace(*placeholder);
+        }
+
+        {
+            GroupScope entity(GroupScope::GroupType::ENTITY);
+            entity.setName(task.name);
+
+            // Inputs are only connected when merging since connecting them would modify the nodes of the design.
+            std::vector<SignalReadPort> generatorInputs;
+            for (const auto &input : task.inputs) {
+                auto *signal = DesignScope::createNode<hlim::Node_Signal>();
+                signal->setConnectionType(connType(input));
+                task.inputSignals.push_back(signal);
+                generatorInputs.push_back(SignalReadPort(signal, input.expansionPolicy));
+            }
+
+            for (const auto &output : task.generator(generatorInputs)) {
+                auto *signal = DesignScope::createNode<hlim::Node_Signal>();
+                signal->setConnectionType(connType(output));
+                signal->connectInput(output);
+                task.outputSignals.push_back(signal);
+            }
+        }
+
+        if (placeholder)
+            task.placeholderClock = placeholder->getClk();
+        task.pool.absorb(design.getCircuit(), task.pool.getRootNodeGroup());
+    };
+
+    std::atomic<size_t> nextTask = 0;
+    auto worker = [&] {
+        for (size_t idx = nextTask++; idx < m_tasks.size(); idx = nextTask++) {
+            try {
+                elaborate(*m_tasks[idx]);
+            } catch (...) {
+                m_tasks[idx]->exception = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for ([[maybe_unused]] auto i : utils::Range(std::min(m_numThreads, m_tasks.size())))
+        threads.emplace_back(worker);
+    for (auto &thread : threads)
+        thread.join();
+
+    for (auto &task : m_tasks)
+        if (task->exception)
+            std::rethrow_exception(task->exception);
+
+    // Merge in the order of addition so that the ids do not depend on the scheduling.
+    auto &circuit = DesignScope::get()->getCircuit();
+    std::vector<std::vector<SignalReadPort>> outputs;
+    for (auto &task : m_tasks) {
+        std::set<hlim::BaseNode*> poolNodes;
+        for (const auto &node : task->pool.getNodes())
+            poolNodes.insert(node.get());
+
+        std::map<size_t, size_t> conditionIds;
+        auto remapConditionId = [&](size_t id) -> size_t {
+            if (id == 0) return 0;
+            auto [it, inserted] = conditionIds.try_emplace(id, 0);
+            if (inserted)
+                it->second = ConditionalScope::allocateId();
+            return it->second;
+        };
+
+        for (const auto &node : task->pool.getNodes()) {
+            for (auto i : utils::Range(node->getNumInputPorts())) {
+                auto driver = node->getDriver(i);
+                HCL_DESIGNCHECK_HINT(driver.node == nullptr || poolNodes.contains(driver.node), "Entities elaborated in parallel may only access the design through their inputs!");
+            }
+            if (auto *reg = dynamic_cast<hlim::Node_Register*>(node.get()))
+                reg->setConditionId(remapConditionId(reg->getConditionId()));
+            else if (auto *mux = dynamic_cast<hlim::Node_Multiplexer*>(node.get()))
+                mux->setConditionId(remapConditionId(mux->getConditionId()));
+        }
+
+        std::map<hlim::Clock*, hlim::Clock*> replaceClocks;
+        if (task->placeholderClock != nullptr)
+            replaceClocks[task->placeholderClock] = clock;
+        circuit.absorb(task->pool, GroupScope::getCurrentNodeGroup(), replaceClocks);
+
+        for (auto i : utils::Range(task->inputs.size()))
+            task->inputSignals[i]->connectInput(task->inputs[i]);
+
+        auto &taskOutputs = outputs.emplace_back();
+        for (auto *signal : task->outputSignals)
+            taskOutputs.push_back(SignalReadPort(signal));
+    }
+    m_tasks.clear();
+
+    return outputs;
+}
+
+}
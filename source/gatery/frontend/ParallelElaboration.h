@@ -0,0 +1,55 @@
+/*  This file is part of Gatery, a library for circuit design.
+	Copyright (C) 2021 Michael Offel, Andreas Ley
+
+	Gatery is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 3 of the License, or (at your option) any later version.
+
+	Gatery is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#pragma once
+
+#include "Signal.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gtry {
+
+/**
+ * @brief Elaborates independent child entities on worker threads.
+ * @details Each entity is built in a thread private circuit with its own stack of scopes and merged into the design afterwards,
+ * in the order in which the entities were added. Node ids thus do not depend on the thread scheduling.
+ * Generators must access the design only through their inputs. Registers use the clock of the ClockScope that was active when run() was called.
+ */
+class ParallelElaboration
+{
+    public:
+        using Generator = std::function<std::vector<SignalReadPort>(const std::vector<SignalReadPort> &inputs)>;
+
+        /// @param numThreads Maximum number of worker threads, zero for one per hardware thread.
+        ParallelElaboration(size_t numThreads = 0);
+        ~ParallelElaboration();
+
+        /// Queues an entity of the given name for elaboration and returns its index in the result of run().
+        size_t add(std::string name, std::vector<SignalReadPort> inputs, Generator generator);
+
+        /// Elaborates all queued entities and merges them into the current GroupScope, returns the outputs of each entity.
+        std::vector<std::vector<SignalReadPort>> run();
+    protected:
+        struct Task;
+        std::vector<std::unique_ptr<Task>> m_tasks;
+        size_t m_numThreads;
+};
+
+}
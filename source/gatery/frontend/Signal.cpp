@@ -18,6 +18,7 @@
 #include "gatery/pch.h"
 #include "Signal.h"
 #include "ConditionalScope.h"
+#include "Scope.h"
 
 #include <gatery/hlim/coreNodes/Node_Rewire.h>
 
@@ -103,3 +104,25 @@ gtry::ElementarySignal::ElementarySignal()
 gtry::ElementarySignal::~ElementarySignal()
 {
 }
+
+gtry::hlim::Node_Rewire *gtry::ElementarySignal::getFusableSliceRewire(hlim::Node_Signal *signalNode) const
+{
+    // Inside a nested conditional scope the previous value is still needed as the mux input.
+    if (auto* scope = ConditionalScope::get(); scope && scope->getId() > m_initialScopeId)
+        return nullptr;
+
+    auto driver = signalNode->getDriver(0);
+    auto *rewire = dynamic_cast<hlim::Node_Rewire*>(driver.node);
+    if (rewire == nullptr || rewire->hasRef())
+        return nullptr;
+
+    // Only merge if the previous value is not observed by anything but the signal itself.
+    const auto &consumers = rewire->getDirectlyDriven(0);
+    if (consumers.size() != 1 || consumers.front().node != signalNode)
+        return nullptr;
+
+    if (rewire->getGroup() != GroupScope::getCurrentNodeGroup())
+        return nullptr;
+
+    return rewire;
+}
@@ -29,6 +29,10 @@
 
 #include "BitWidth.h"
 
+namespace gtry::hlim {
+    class Node_Rewire;
+}
+
 namespace gtry {
 
     class ConditionalScope;
@@ -79,6 +83,8 @@ namespace gtry {
     protected:
         size_t m_initialScopeId = 0;
 
+        /// Returns the rewire that drives signalNode if a slice assignment can be merged into it instead of stacking another rewire on top.
+        hlim::Node_Rewire *getFusableSliceRewire(hlim::Node_Signal *signalNode) const;
     };
 
 }
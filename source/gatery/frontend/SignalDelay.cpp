@@ -17,3 +17,41 @@
 */
 #include "gatery/pch.h"
 #include "SignalDelay.h"
+#include "Clock.h"
+#include "ConditionalScope.h"
+
+#include <gatery/hlim/coreNodes/Node_PipelineRegister.h>
+
+namespace gtry {
+
+namespace {
+
+hlim::Node_PipelineRegister *createPipelineRegister(const SignalReadPort &data, std::string_view name, size_t numStages)
+{
+    auto* reg = DesignScope::createNode<hlim::Node_PipelineRegister>(numStages);
+    reg->recordStackTrace();
+    reg->setName(std::string{ name });
+    reg->setClock(ClockScope::getClk().getClk());
+    reg->connectInput(hlim::Node_PipelineRegister::DATA, data);
+
+    ConditionalScope* scope = ConditionalScope::get();
+    if (scope)
+        reg->connectInput(hlim::Node_PipelineRegister::ENABLE, scope->getFullCondition());
+
+    return reg;
+}
+
+}
+
+BVec pipeline(const BVec &signal, size_t numStages)
+{
+    SignalReadPort data = signal.getReadPort();
+    return SignalReadPort(createPipelineRegister(data, signal.getName(), numStages), data.expansionPolicy);
+}
+
+Bit pipeline(const Bit &signal, size_t numStages)
+{
+    return SignalReadPort(createPipelineRegister(signal.getReadPort(), signal.getName(), numStages));
+}
+
+}
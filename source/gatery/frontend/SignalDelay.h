@@ -17,13 +17,19 @@
 */
 #pragma once
 
-namespace gtry {
-    
-    
-class SignalDelay
-{
-};
+#include "Bit.h"
+#include "BitVector.h"
 
-}
+namespace gtry {
 
+/**
+ * @brief Delays a signal by the given number of ticks of the current clock and allows these registers to be moved into the logic driving it.
+ * @details During postprocessing the registers are distributed through the combinational logic that exclusively feeds into this signal,
+ * splitting it into stages of roughly equal logic depth. All parallel paths are delayed equally.
+ * Inside a conditional scope, the registers are only enabled if the condition holds.
+ */
+BVec pipeline(const BVec &signal, size_t numStages);
+/// @copydoc pipeline(const BVec &, size_t)
+Bit pipeline(const Bit &signal, size_t numStages);
 
+}
@@ -27,10 +27,15 @@
 #include "coreNodes/Node_Pin.h"
 #include "coreNodes/Node_Rewire.h"
 #include "coreNodes/Node_Register.h"
+#include "coreNodes/Node_Arithmetic.h"
+#include "coreNodes/Node_Compare.h"
+#include "coreNodes/Node_Shift.h"
+#include "coreNodes/Node_PriorityConditional.h"
 
 #include "supportNodes/Node_Attributes.h"
 
 #include "postprocessing/MemoryDetector.h"
+#include "postprocessing/RegisterRetiming.h"
 #include "postprocessing/DefaultValueResolution.h"
 #include "postprocessing/AttributeFusion.h"
 
@@ -42,6 +47,8 @@
 #include <set>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <typeindex>
 
 #include <iostream>
 
@@ -141,6 +148,41 @@ BaseNode *Circuit::createUnconnectedClone(BaseNode *srcNode, bool noId)
 }
 
 
+void Circuit::absorb(Circuit &other, NodeGroup *targetGroup, const std::map<Clock*, Clock*> &replaceClocks)
+{
+    for (auto &node : other.m_nodes) {
+        for (auto i : utils::Range(node->getClocks().size())) {
+            auto it = replaceClocks.find(node->getClocks()[i]);
+            if (it != replaceClocks.end())
+                node->attachClock(it->second, i);
+        }
+        node->setId(m_nextNodeId++, {});
+        m_nodes.push_back(std::move(node));
+    }
+    other.m_nodes.clear();
+
+    for (auto &clock : other.m_clocks) {
+        if (replaceClocks.contains(clock.get())) continue;
+        HCL_DESIGNCHECK_HINT(!replaceClocks.contains(clock->getParentClock()), "Clocks derived from replaced clocks can not be moved to another circuit!");
+        m_clocks.push_back(std::move(clock));
+    }
+    other.m_clocks.clear();
+
+    for (auto &signalGroup : other.m_signalGroups)
+        m_signalGroups.push_back(std::move(signalGroup));
+    other.m_signalGroups.clear();
+
+    std::vector<BaseNode*> rootNodes = other.m_root->getNodes();
+    for (auto *node : rootNodes)
+        node->moveToGroup(targetGroup);
+
+    std::vector<NodeGroup*> rootChildren;
+    for (const auto &child : other.m_root->getChildren())
+        rootChildren.push_back(child.get());
+    for (auto *child : rootChildren)
+        child->moveInto(targetGroup);
+}
+
 Clock *Circuit::createUnconnectedClock(Clock *clock, Clock *newParent)
 {
     m_clocks.push_back(clock->cloneUnconnected(newParent));
@@ -345,61 +387,48 @@ void Circuit::cullUnusedNodes()
 }
 
 
+/**
+ * @brief Conjunction of conditions and negated conditions, as built by nested conditional scopes.
+ * @details The conditions are kept sorted by node port, so comparisons are linear merges.
+ */
 struct HierarchyCondition {
-    std::map<NodePort, bool> m_conditionsAndNegations;
+    std::vector<std::pair<NodePort, bool>> m_conditionsAndNegations;
     bool m_undefined = false;
     bool m_contradicting = false;
 
-    void parse(NodePort nodeInput) {
-        std::vector<std::pair<NodePort, bool>> stack;
-        if (nodeInput.node != nullptr)
-            stack.push_back({nodeInput.node->getNonSignalDriver(nodeInput.port), false});
-        else
-            m_undefined = true;
+    void negate() {
+        for (auto &pair : m_conditionsAndNegations)
+            pair.second = !pair.second;
+    }
 
-        while (!stack.empty()) {
-            auto top = stack.back();
-            stack.pop_back();
-            if (top.first.node == nullptr)
-                m_undefined = true;
-            else {
-                if (Node_Logic *logicNode = dynamic_cast<Node_Logic*>(top.first.node)) {
-                    if (logicNode->getOp() == Node_Logic::NOT) {
-                        auto driver = logicNode->getNonSignalDriver(0);
-                        stack.push_back({driver, !top.second});
-                    } else
-                    if (logicNode->getOp() == Node_Logic::AND) {
-                        for (auto j : utils::Range(logicNode->getNumInputPorts()))
-                            stack.push_back({logicNode->getNonSignalDriver(j), top.second});
-                    } else {
-                        auto it = m_conditionsAndNegations.find(top.first);
-                        if (it != m_conditionsAndNegations.end())
-                            m_contradicting |= it->second != top.second;
-                        else
-                            m_conditionsAndNegations[top.first] = top.second;
-                    }
-                } else {
-                    auto it = m_conditionsAndNegations.find(top.first);
-                    if (it != m_conditionsAndNegations.end())
-                        m_contradicting |= it->second != top.second;
-                    else
-                        m_conditionsAndNegations[top.first] = top.second;
-                }
+    /// Adds the conditions of other, on conflicts the negation already present in this condition is kept.
+    void conjoin(const HierarchyCondition &other) {
+        m_undefined |= other.m_undefined;
+        m_contradicting |= other.m_contradicting;
+
+        std::vector<std::pair<NodePort, bool>> merged;
+        merged.reserve(m_conditionsAndNegations.size() + other.m_conditionsAndNegations.size());
+        auto it = m_conditionsAndNegations.begin();
+        auto otherIt = other.m_conditionsAndNegations.begin();
+        while (it != m_conditionsAndNegations.end() || otherIt != other.m_conditionsAndNegations.end()) {
+            if (otherIt == other.m_conditionsAndNegations.end() || (it != m_conditionsAndNegations.end() && it->first < otherIt->first)) {
+                merged.push_back(*it++);
+            } else if (it == m_conditionsAndNegations.end() || otherIt->first < it->first) {
+                merged.push_back(*otherIt++);
+            } else {
+                m_contradicting |= it->second != otherIt->second;
+                merged.push_back(*it++);
+                otherIt++;
             }
         }
+        m_conditionsAndNegations = std::move(merged);
     }
 
     bool isEqualOf(const HierarchyCondition &other) const {
         if (m_undefined || other.m_undefined) return false;
         if (m_contradicting && other.m_contradicting) return true;
 
-        if (m_conditionsAndNegations.size() != other.m_conditionsAndNegations.size()) return false;
-        for (const auto &pair : m_conditionsAndNegations) {
-            auto it = other.m_conditionsAndNegations.find(pair.first);
-            if (it == other.m_conditionsAndNegations.end()) return false;
-            if (it->second != pair.second) return false;
-        }
-        return true;
+        return m_conditionsAndNegations == other.m_conditionsAndNegations;
     }
 
     bool isNegationOf(const HierarchyCondition &other) const {
@@ -407,10 +436,9 @@ struct HierarchyCondition {
         if (m_contradicting && other.m_contradicting) return false;
 
         if (m_conditionsAndNegations.size() != other.m_conditionsAndNegations.size()) return false;
-        for (const auto &pair : m_conditionsAndNegations) {
-            auto it = other.m_conditionsAndNegations.find(pair.first);
-            if (it == other.m_conditionsAndNegations.end()) return false;
-            if (it->second == pair.second) return false;
+        for (auto i : utils::Range(m_conditionsAndNegations.size())) {
+            if (m_conditionsAndNegations[i].first != other.m_conditionsAndNegations[i].first) return false;
+            if (m_conditionsAndNegations[i].second == other.m_conditionsAndNegations[i].second) return false;
         }
         return true;
     }
@@ -419,16 +447,83 @@ struct HierarchyCondition {
         if (m_undefined || other.m_undefined) return false;
         if (m_contradicting && other.m_contradicting) return false;
 
-        for (const auto &pair : m_conditionsAndNegations) {
-            auto it = other.m_conditionsAndNegations.find(pair.first);
-            if (it == other.m_conditionsAndNegations.end()) return false;
-            if (it->second != pair.second) return false;
-        }
-        return true;
+        return std::includes(other.m_conditionsAndNegations.begin(), other.m_conditionsAndNegations.end(),
+                            m_conditionsAndNegations.begin(), m_conditionsAndNegations.end());
     }
 };
 
+/**
+ * @brief Memoizes the conditions of all outputs within AND/NOT trees, so that shared subtrees are only walked once.
+ * @details Entries stay valid as long as no input of a node within a condition tree is rewired.
+ */
+class HierarchyConditionCache {
+    public:
+        /// Condition driving the given input, e.g. the selector of a multiplexer.
+        const HierarchyCondition &get(const NodePort &nodeInput) {
+            if (nodeInput.node == nullptr)
+                return getDriven({});
+            return getDriven(nodeInput.node->getNonSignalDriver(nodeInput.port));
+        }
+
+        void clear() { m_conditions.clear(); }
+    protected:
+        std::map<NodePort, HierarchyCondition> m_conditions;
+
+        const HierarchyCondition &getDriven(const NodePort &output) {
+            std::vector<std::pair<NodePort, bool>> stack = {{output, false}};
+            std::set<BaseNode*> inProgress;
+            while (!stack.empty()) {
+                auto [np, driversDone] = stack.back();
+                if (m_conditions.contains(np)) {
+                    stack.pop_back();
+                    continue;
+                }
+
+                Node_Logic *logicNode = dynamic_cast<Node_Logic*>(np.node);
+                if (logicNode != nullptr && logicNode->getOp() != Node_Logic::NOT && logicNode->getOp() != Node_Logic::AND)
+                    logicNode = nullptr;
+
+                if (np.node == nullptr) {
+                    m_conditions[np].m_undefined = true;
+                    stack.pop_back();
+                } else if (logicNode == nullptr || inProgress.contains(logicNode)) {
+                    m_conditions[np].m_conditionsAndNegations = {{np, false}};
+                    stack.pop_back();
+                } else if (!driversDone) {
+                    stack.back().second = true;
+                    inProgress.insert(logicNode);
+                    for (auto j : utils::Range(logicNode->getNumInputPorts())) {
+                        auto driver = logicNode->getNonSignalDriver(j);
+                        if (!m_conditions.contains(driver))
+                            stack.push_back({driver, false});
+                    }
+                } else {
+                    stack.pop_back();
+                    inProgress.erase(logicNode);
+
+                    HierarchyCondition condition;
+                    if (logicNode->getOp() == Node_Logic::NOT) {
+                        condition = m_conditions.at(logicNode->getNonSignalDriver(0));
+                        condition.negate();
+                    } else {
+                        // The last input takes precedence to match a depth first traversal.
+                        for (size_t j = logicNode->getNumInputPorts(); j > 0; j--)
+                            condition.conjoin(m_conditions.at(logicNode->getNonSignalDriver(j-1)));
+                    }
+                    m_conditions[np] = std::move(condition);
+                }
+            }
+            return m_conditions.at(output);
+        }
+};
+
 void Circuit::mergeMuxes()
+{
+    HierarchyConditionCache conditions;
+    mergeMuxes(conditions);
+}
+
+void Circuit::mergeMuxes(HierarchyConditionCache &conditions)
 {
     bool done;
     do {
@@ -440,8 +535,7 @@ void Circuit::mergeMuxes()
 
                 //std::cout << "Found 2-input mux" << std::endl;
 
-                HierarchyCondition condition;
-                condition.parse({.node = muxNode, .port = 0});
+                const HierarchyCondition &condition = conditions.get({.node = muxNode, .port = 0});
 
                 for (size_t muxInput : utils::Range(2)) {
 
@@ -456,8 +550,7 @@ void Circuit::mergeMuxes()
 
                         //std::cout << "Found 2 chained muxes" << std::endl;
 
-                        HierarchyCondition prevCondition;
-                        prevCondition.parse({.node = prevMuxNode, .port = 0});
+                        const HierarchyCondition &prevCondition = conditions.get({.node = prevMuxNode, .port = 0});
 
                         bool conditionsMatch = false;
                         bool prevConditionNegated;
@@ -513,6 +606,12 @@ void Circuit::mergeMuxes()
 
 
 void Circuit::removeIrrelevantMuxes()
+{
+    HierarchyConditionCache conditions;
+    removeIrrelevantMuxes(conditions);
+}
+
+void Circuit::removeIrrelevantMuxes(HierarchyConditionCache &conditions)
 {
     bool done;
     do {
@@ -524,8 +623,8 @@ void Circuit::removeIrrelevantMuxes()
 
                 //std::cout << "Found 2-input mux" << std::endl;
 
-                HierarchyCondition condition;
-                condition.parse({.node = muxNode, .port = 0});
+                // Copy, since rewiring below may invalidate the cache.
+                HierarchyCondition condition = conditions.get({.node = muxNode, .port = 0});
 
                 for (size_t muxInputPort : utils::Range(1,3)) {
 
@@ -555,8 +654,7 @@ void Circuit::removeIrrelevantMuxes()
 
                             if (Node_Multiplexer *subnetOutputMuxNode = dynamic_cast<Node_Multiplexer*>(input.node)) {
                                 if (muxNode->getNumInputPorts() == 3) {
-                                    HierarchyCondition subnetOutputMuxNodeCondition;
-                                    subnetOutputMuxNodeCondition.parse({.node = subnetOutputMuxNode, .port = 0});
+                                    const HierarchyCondition &subnetOutputMuxNodeCondition = conditions.get({.node = subnetOutputMuxNode, .port = 0});
 
                                     if (input.port == muxInputPort && condition.isEqualOf(subnetOutputMuxNodeCondition))
                                         continue;
@@ -574,6 +672,8 @@ void Circuit::removeIrrelevantMuxes()
                         if (allSubnetOutputsMuxed) {
                             //std::cout << "Rewiring past mux" << std::endl;
                             muxOutput.node->connectInput(muxOutput.port, muxNode->getDriver(muxInputPort));
+                            // The consumer might be part of a condition tree.
+                            conditions.clear();
                             done = false;
                         } else {
                             //std::cout << "Not rewiring past mux" << std::endl;
@@ -635,6 +735,158 @@ void Circuit::removeNoOps()
     }
 }
 
+namespace {
+
+/// Nodes that compute their outputs purely from their inputs and parameters.
+bool isMergeCandidate(BaseNode *node)
+{
+    if (node->hasSideEffects() || !node->isCombinatorial()) return false;
+    return dynamic_cast<Node_Logic*>(node) ||
+        dynamic_cast<Node_Arithmetic*>(node) ||
+        dynamic_cast<Node_Compare*>(node) ||
+        dynamic_cast<Node_Multiplexer*>(node) ||
+        dynamic_cast<Node_Rewire*>(node) ||
+        dynamic_cast<Node_Shift*>(node) ||
+        dynamic_cast<Node_Constant*>(node) ||
+        dynamic_cast<Node_PriorityConditional*>(node);
+}
+
+bool isCommutative(BaseNode *node)
+{
+    if (node->getNumInputPorts() != 2) return false;
+
+    if (auto *logic = dynamic_cast<Node_Logic*>(node))
+        return logic->getOp() != Node_Logic::NOT;
+    if (auto *arith = dynamic_cast<Node_Arithmetic*>(node))
+        return arith->getOp() == Node_Arithmetic::ADD || arith->getOp() == Node_Arithmetic::MUL;
+    if (auto *compare = dynamic_cast<Node_Compare*>(node))
+        return compare->getOp() == Node_Compare::EQ || compare->getOp() == Node_Compare::NEQ;
+    return false;
+}
+
+/// Compares everything but the inputs of two nodes of the same type.
+bool haveEqualParameters(BaseNode *lhs, BaseNode *rhs)
+{
+    if (lhs->getNumOutputPorts() != rhs->getNumOutputPorts()) return false;
+    for (auto i : utils::Range(lhs->getNumOutputPorts()))
+        if (!(lhs->getOutputConnectionType(i) == rhs->getOutputConnectionType(i)))
+            return false;
+
+    if (auto *logic = dynamic_cast<Node_Logic*>(lhs))
+        return logic->getOp() == ((Node_Logic*)rhs)->getOp();
+    if (auto *arith = dynamic_cast<Node_Arithmetic*>(lhs))
+        return arith->getOp() == ((Node_Arithmetic*)rhs)->getOp();
+    if (auto *compare = dynamic_cast<Node_Compare*>(lhs))
+        return compare->getOp() == ((Node_Compare*)rhs)->getOp();
+    if (auto *mux = dynamic_cast<Node_Multiplexer*>(lhs))
+        return mux->getConditionId() == ((Node_Multiplexer*)rhs)->getConditionId();
+    if (auto *shift = dynamic_cast<Node_Shift*>(lhs))
+        return shift->getDirection() == ((Node_Shift*)rhs)->getDirection() &&
+                shift->getFillMode() == ((Node_Shift*)rhs)->getFillMode();
+    if (auto *constant = dynamic_cast<Node_Constant*>(lhs)) {
+        const auto &lhsValue = constant->getValue();
+        const auto &rhsValue = ((Node_Constant*)rhs)->getValue();
+        return lhsValue.size() == rhsValue.size() && sim::equalOnDefinedValues(lhsValue, 0, rhsValue, 0, lhsValue.size());
+    }
+    if (auto *rewire = dynamic_cast<Node_Rewire*>(lhs)) {
+        const auto &lhsRanges = rewire->getOp().ranges;
+        const auto &rhsRanges = ((Node_Rewire*)rhs)->getOp().ranges;
+        if (lhsRanges.size() != rhsRanges.size()) return false;
+        for (auto i : utils::Range(lhsRanges.size()))
+            if (lhsRanges[i].subwidth != rhsRanges[i].subwidth ||
+                lhsRanges[i].source != rhsRanges[i].source ||
+                (lhsRanges[i].source == Node_Rewire::OutputRange::INPUT &&
+                    (lhsRanges[i].inputIdx != rhsRanges[i].inputIdx || lhsRanges[i].inputOffset != rhsRanges[i].inputOffset)))
+                return false;
+        return true;
+    }
+    return true;
+}
+
+struct MergeKey {
+    NodeGroup *group;
+    std::type_index type;
+    std::vector<NodePort> drivers;
+
+    bool operator==(const MergeKey &rhs) const { return group == rhs.group && type == rhs.type && drivers == rhs.drivers; }
+};
+
+struct MergeKeyHash {
+    size_t operator()(const MergeKey &key) const {
+        size_t hash = std::hash<NodeGroup*>()(key.group) ^ key.type.hash_code();
+        for (const auto &driver : key.drivers)
+            hash = hash * 31 + std::hash<BaseNode*>()(driver.node) + driver.port;
+        return hash;
+    }
+};
+
+}
+
+/**
+ * @brief Merges combinational nodes of the same type and parameters that are driven by the same signals.
+ * @details Drivers are merged before the nodes they drive, so whole duplicated subtrees collapse in one pass.
+ * Only nodes within the same node group are merged to keep the hierarchy of the export intact.
+ */
+void Circuit::mergeEquivalentNodes()
+{
+    std::unordered_map<MergeKey, std::vector<BaseNode*>, MergeKeyHash> buckets;
+    std::set<BaseNode*> visited;
+    std::set<BaseNode*> mergedNodes;
+
+    auto merge = [&](BaseNode *node) {
+        MergeKey key = {.group = node->getGroup(), .type = typeid(*node), .drivers = {}};
+        for (auto i : utils::Range(node->getNumInputPorts()))
+            key.drivers.push_back(node->getNonSignalDriver(i));
+        if (isCommutative(node))
+            std::sort(key.drivers.begin(), key.drivers.end());
+
+        auto &bucket = buckets[key];
+        for (auto *other : bucket)
+            if (haveEqualParameters(node, other)) {
+                for (auto i : utils::Range(node->getNumOutputPorts()))
+                    while (!node->getDirectlyDriven(i).empty()) {
+                        auto consumer = node->getDirectlyDriven(i).front();
+                        consumer.node->rewireInput(consumer.port, {.node = other, .port = i});
+                    }
+                mergedNodes.insert(node);
+                return;
+            }
+        bucket.push_back(node);
+    };
+
+    for (size_t i = 0; i < m_nodes.size(); i++) {
+        if (!isMergeCandidate(m_nodes[i].get()) || visited.contains(m_nodes[i].get())) continue;
+
+        std::vector<std::pair<BaseNode*, bool>> stack = {{m_nodes[i].get(), false}};
+        visited.insert(m_nodes[i].get());
+        while (!stack.empty()) {
+            auto [node, driversDone] = stack.back();
+            if (!driversDone) {
+                stack.back().second = true;
+                for (auto j : utils::Range(node->getNumInputPorts())) {
+                    auto driver = node->getNonSignalDriver(j);
+                    if (driver.node != nullptr && isMergeCandidate(driver.node) && !visited.contains(driver.node)) {
+                        visited.insert(driver.node);
+                        stack.push_back({driver.node, false});
+                    }
+                }
+                continue;
+            }
+            stack.pop_back();
+            merge(node);
+        }
+    }
+
+    // Nodes still referenced from the frontend (e.g. by signal defaults) are kept, they are culled once the references are gone.
+    for (size_t i = 0; i < m_nodes.size(); i++) {
+        if (mergedNodes.contains(m_nodes[i].get()) && !m_nodes[i]->hasRef()) {
+            m_nodes[i] = std::move(m_nodes.back());
+            m_nodes.pop_back();
+            i--;
+        }
+    }
+}
+
 void Circuit::foldRegisterMuxEnableLoops()
 {
     for (size_t i = 0; i < m_nodes.size(); i++) {
@@ -887,13 +1139,18 @@ void Circuit::postprocess(const PostProcessor &postProcessor)
             cullOrphanedSignalNodes();
             cullUnnamedSignalNodes();
             cullSequentiallyDuplicatedSignalNodes();
-            mergeMuxes();
-            removeIrrelevantMuxes();
+            mergeEquivalentNodes();
+            {
+                HierarchyConditionCache conditions;
+                mergeMuxes(conditions);
+                removeIrrelevantMuxes(conditions);
+            }
             cullMuxConditionNegations();
             removeNoOps();
             foldRegisterMuxEnableLoops();
             removeConstSelectMuxes();
             propagateConstants(); // do again after muxes are removed
+            retimePipelineRegisters(*this);
             cullUnusedNodes();
             attributeFusion(*this);
             ensureSignalNodePlacement();
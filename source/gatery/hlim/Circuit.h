@@ -26,9 +26,12 @@
 #include <vector>
 #include <memory>
 #include <map>
+#include <iosfwd>
 
 namespace gtry::hlim {
 
+class HierarchyConditionCache;
+
 /*
 class Circuit;
 class Report;
@@ -87,6 +90,13 @@ class Circuit
 
         BaseNode *createUnconnectedClone(BaseNode *srcNode, bool noId = false);
 
+        /**
+         * @brief Moves all nodes, clocks, and node groups of other into this circuit, leaving other empty.
+         * @details The content of the root group of other is moved into targetGroup. Nodes receive new ids in the order they had in other.
+         * Clocks that are keys of replaceClocks are not moved, the nodes attached to them get attached to the mapped clocks of this circuit instead.
+         */
+        void absorb(Circuit &other, NodeGroup *targetGroup, const std::map<Clock*, Clock*> &replaceClocks = {});
+
         template<typename... Args>
         SignalGroup *createSignalGroup(Args&&... args);
 
@@ -108,9 +118,13 @@ class Circuit
         void cullUnnamedSignalNodes();
         void cullOrphanedSignalNodes();
         void cullUnusedNodes();
+        void mergeEquivalentNodes();
         void mergeMuxes();
+        /// Merges chained multiplexers with equal or negated conditions, reusing the parsed conditions of previous passes.
+        void mergeMuxes(HierarchyConditionCache &conditions);
         void cullMuxConditionNegations();
         void removeIrrelevantMuxes();
+        void removeIrrelevantMuxes(HierarchyConditionCache &conditions);
         void removeNoOps();
         void foldRegisterMuxEnableLoops();
         void propagateConstants();
@@ -126,6 +140,16 @@ class Circuit
         Node_Signal *appendSignal(RefCtdNodePort &nodePort);
 
         Node_Attributes *getCreateAttribNode(NodePort &nodePort);
+
+        /// Whether all nodes can be serialized, which excludes external nodes, clock to signal nodes, and signal generators.
+        bool isSerializable() const;
+        /**
+         * @brief Writes nodes, connections, node groups, clocks, and attributes in a compact binary form.
+         * @details Signal groups and stack traces are not written. Serializing the same circuit twice yields identical bytes.
+         */
+        void serialize(std::ostream &stream) const;
+        /// Restores a circuit written by serialize() into this circuit, which must still be empty.
+        void deserialize(std::istream &stream);
     protected:
         std::vector<std::unique_ptr<BaseNode>> m_nodes;
         std::unique_ptr<NodeGroup> m_root;
@@ -0,0 +1,136 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#include "gatery/pch.h"
+#include "CircuitCache.h"
+
+#include "Circuit.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <random>
+
+namespace gtry::hlim {
+
+namespace {
+
+/// 64 bit FNV-1a
+std::uint64_t hashBytes(std::string_view data)
+{
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : data) {
+        hash ^= (unsigned char) c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+std::string toHex(std::uint64_t value)
+{
+    std::stringstream str;
+    str << std::hex << std::setw(16) << std::setfill('0') << value;
+    return str.str();
+}
+
+bool readFile(const std::filesystem::path &path, std::string &content)
+{
+    std::ifstream file(path.string().c_str(), std::fstream::binary);
+    if (!file) return false;
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    content = buffer.str();
+    return true;
+}
+
+/// Writes to a temporary file first so that concurrent readers (e.g. parallel CI jobs) never see partial files.
+void writeFileAtomic(const std::filesystem::path &path, std::string_view content)
+{
+    std::filesystem::create_directories(path.parent_path());
+
+    auto tmpPath = path;
+    tmpPath += ".tmp" + toHex(std::random_device{}());
+    {
+        std::ofstream file(tmpPath.string().c_str(), std::fstream::binary);
+        HCL_DESIGNCHECK_HINT(file, "Could not write to circuit cache!");
+        file.write(content.data(), content.size());
+        HCL_DESIGNCHECK_HINT(file, "Could not write to circuit cache!");
+    }
+    std::filesystem::rename(tmpPath, path);
+}
+
+}
+
+CircuitCache::CircuitCache(std::filesystem::path directory) : m_directory(std::move(directory))
+{
+}
+
+std::filesystem::path CircuitCache::keyPath(std::string_view key) const
+{
+    return m_directory / "keys" / toHex(hashBytes(key));
+}
+
+std::filesystem::path CircuitCache::circuitPath(std::string_view contentHash) const
+{
+    return m_directory / "circuits" / (std::string(contentHash) + ".gtc");
+}
+
+bool CircuitCache::load(std::string_view key, Circuit &circuit) const
+{
+    std::string keyFile;
+    if (!readFile(keyPath(key), keyFile)) return false;
+
+    // The key file holds the content hash followed by the full key to rule out collisions of the key hash.
+    auto separator = keyFile.find('\n');
+    if (separator == std::string::npos) return false;
+    std::string_view contentHash(keyFile.data(), separator);
+    if (std::string_view(keyFile).substr(separator+1) != key) return false;
+
+    std::string serialized;
+    if (!readFile(circuitPath(contentHash), serialized)) return false;
+    if (toHex(hashBytes(serialized)) != contentHash) return false;
+
+    std::istringstream stream(serialized);
+    circuit.deserialize(stream);
+    return true;
+}
+
+bool CircuitCache::store(std::string_view key, const Circuit &circuit)
+{
+    if (!circuit.isSerializable()) return false;
+
+    std::ostringstream stream;
+    circuit.serialize(stream);
+    std::string serialized = stream.str();
+    std::string contentHash = toHex(hashBytes(serialized));
+
+    auto path = circuitPath(contentHash);
+    if (!std::filesystem::exists(path))
+        writeFileAtomic(path, serialized);
+
+    writeFileAtomic(keyPath(key), contentHash + '\n' + std::string(key));
+    return true;
+}
+
+std::string CircuitCache::structuralHash(const Circuit &circuit)
+{
+    std::ostringstream stream;
+    circuit.serialize(stream);
+    return toHex(hashBytes(stream.str()));
+}
+
+}
@@ -0,0 +1,56 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+namespace gtry::hlim {
+
+class Circuit;
+
+/**
+ * @brief On-disk cache of serialized (usually postprocessed) circuits.
+ * @details Circuits are stored content addressed under the hash of their serialized form, keys merely point to them.
+ * Identical circuits stored under different keys thus share one file. The key is chosen by the user, it can be derived from
+ * the design parameters (to skip elaboration) or be the structural hash of the unprocessed circuit (to skip postprocessing).
+ */
+class CircuitCache
+{
+    public:
+        CircuitCache(std::filesystem::path directory);
+
+        /// Loads the circuit stored under the given key into the empty circuit, returns false if there is none.
+        bool load(std::string_view key, Circuit &circuit) const;
+        /// Stores the circuit under the given key, returns false if the circuit can not be serialized.
+        bool store(std::string_view key, const Circuit &circuit);
+
+        /// Hash of the serialized circuit, identical circuits always yield the same hash.
+        static std::string structuralHash(const Circuit &circuit);
+
+        inline const std::filesystem::path &getDirectory() const { return m_directory; }
+    protected:
+        std::filesystem::path m_directory;
+
+        std::filesystem::path keyPath(std::string_view key) const;
+        std::filesystem::path circuitPath(std::string_view contentHash) const;
+};
+
+}
@@ -0,0 +1,805 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#include "gatery/pch.h"
+#include "Circuit.h"
+
+#include "coreNodes/Node_Arithmetic.h"
+#include "coreNodes/Node_Clk2Signal.h"
+#include "coreNodes/Node_Compare.h"
+#include "coreNodes/Node_Constant.h"
+#include "coreNodes/Node_Logic.h"
+#include "coreNodes/Node_Multiplexer.h"
+#include "coreNodes/Node_Pin.h"
+#include "coreNodes/Node_PriorityConditional.h"
+#include "coreNodes/Node_PipelineRegister.h"
+#include "coreNodes/Node_Register.h"
+#include "coreNodes/Node_Rewire.h"
+#include "coreNodes/Node_Shift.h"
+#include "coreNodes/Node_Signal.h"
+#include "supportNodes/Node_Attributes.h"
+#include "supportNodes/Node_Default.h"
+#include "supportNodes/Node_ExportOverride.h"
+#include "supportNodes/Node_External.h"
+#include "supportNodes/Node_MemPort.h"
+#include "supportNodes/Node_Memory.h"
+#include "supportNodes/Node_PathAttributes.h"
+#include "supportNodes/Node_SignalGenerator.h"
+#include "supportNodes/Node_SignalTap.h"
+
+#include "postprocessing/MemoryDetector.h"
+
+#include "../utils/Range.h"
+
+#include <istream>
+#include <ostream>
+#include <map>
+
+namespace gtry::hlim {
+
+/*
+ * Format (all integers are unsigned LEB128, strings are length prefixed):
+ *
+ *  magic, version
+ *  clocks:       kind, parent index, name, reset name, trigger event, phase sync, register attributes, frequency or multiplier
+ *  node groups:  pre-order tree of kind, group type, name, instance name, comment, node indices, memory group bookkeeping, children
+ *  nodes:        type, id, name, comment, port layout, clock indices, type specific parameters
+ *  connections:  consumer node indices and ports for every output of every node
+ *
+ * Group membership and connections are stored in the order of the respective lists so that the export of a loaded circuit
+ * emits signals and ports in the same order as the export of the original circuit.
+ *  next node id
+ */
+
+namespace {
+
+const char CIRCUIT_MAGIC[8] = { 'G', 'T', 'R', 'Y', 'C', 'I', 'R', 'C' };
+/// Version 2: memory ports gained the write byte enable input.
+const std::uint64_t CIRCUIT_FORMAT_VERSION = 2;
+const std::uint64_t NONE = ~0ull;
+
+enum class NodeType {
+    ARITHMETIC,
+    COMPARE,
+    CONSTANT,
+    LOGIC,
+    MULTIPLEXER,
+    PIN,
+    PRIORITY_CONDITIONAL,
+    REGISTER,
+    REWIRE,
+    SHIFT,
+    SIGNAL,
+    SIGNAL_TAP,
+    MEMORY,
+    MEM_PORT,
+    DEFAULT,
+    EXPORT_OVERRIDE,
+    ATTRIBUTES,
+    PATH_ATTRIBUTES,
+    PIPELINE_REGISTER,
+};
+
+enum class ClockKind {
+    ROOT,
+    DERIVED,
+};
+
+enum class GroupKind {
+    PLAIN,
+    MEMORY,
+};
+
+class Writer
+{
+    public:
+        Writer(std::ostream &stream) : m_stream(stream) { }
+
+        void uint(std::uint64_t value) {
+            do {
+                std::uint8_t byte = value & 0x7F;
+                value >>= 7;
+                if (value) byte |= 0x80;
+                m_stream.put((char) byte);
+            } while (value);
+        }
+
+        void boolean(bool value) { uint(value?1:0); }
+
+        void string(const std::string &str) {
+            uint(str.size());
+            m_stream.write(str.data(), str.size());
+        }
+
+        void rational(const ClockRational &value) {
+            uint(value.numerator());
+            uint(value.denominator());
+        }
+
+        void state(const sim::DefaultBitVectorState &state) {
+            uint(state.size());
+            for (auto p : utils::Range<size_t>(sim::DefaultConfig::NUM_PLANES))
+                for (auto i : utils::Range(state.getNumBlocks()))
+                    uint(state.data((sim::DefaultConfig::Plane) p)[i]);
+        }
+
+        void attributes(const Attributes &attribs) {
+            uint(attribs.userDefinedVendorAttributes.size());
+            for (const auto &vendor : attribs.userDefinedVendorAttributes) {
+                string(vendor.first);
+                uint(vendor.second.size());
+                for (const auto &attrib : vendor.second) {
+                    string(attrib.first);
+                    string(attrib.second.type);
+                    string(attrib.second.value);
+                }
+            }
+        }
+
+        void registerAttributes(const RegisterAttributes &attribs) {
+            attributes(attribs);
+            uint((unsigned) attribs.resetType);
+            boolean(attribs.initializeRegs);
+            boolean(attribs.resetHighActive);
+            uint((unsigned) attribs.registerResetPinUsage);
+            uint((unsigned) attribs.registerEnablePinUsage);
+        }
+
+        template<typename T>
+        void optional(const std::optional<T> &value) {
+            boolean((bool) value);
+            if (value) uint((std::uint64_t) *value);
+        }
+    protected:
+        std::ostream &m_stream;
+};
+
+class Reader
+{
+    public:
+        Reader(std::istream &stream) : m_stream(stream) { }
+
+        std::uint64_t uint() {
+            std::uint64_t value = 0;
+            for (unsigned shift = 0; ; shift += 7) {
+                int c = m_stream.get();
+                HCL_DESIGNCHECK_HINT(c != std::istream::traits_type::eof() && shift < 64, "Serialized circuit is truncated or corrupt!");
+                value |= std::uint64_t(c & 0x7F) << shift;
+                if (!(c & 0x80)) break;
+            }
+            return value;
+        }
+
+        template<typename Enum>
+        Enum enumeration(size_t numValues) {
+            auto v = uint();
+            HCL_DESIGNCHECK_HINT(v < numValues, "Serialized circuit is corrupt!");
+            return (Enum) v;
+        }
+
+        bool boolean() { return uint() != 0; }
+
+        std::string string() {
+            std::string str(uint(), '\0');
+            m_stream.read(str.data(), str.size());
+            HCL_DESIGNCHECK_HINT(m_stream, "Serialized circuit is truncated or corrupt!");
+            return str;
+        }
+
+        ClockRational rational() {
+            auto num = uint();
+            auto den = uint();
+            HCL_DESIGNCHECK_HINT(den != 0, "Serialized circuit is corrupt!");
+            return ClockRational(num, den);
+        }
+
+        sim::DefaultBitVectorState state() {
+            sim::DefaultBitVectorState state;
+            state.resize(uint());
+            for (auto p : utils::Range<size_t>(sim::DefaultConfig::NUM_PLANES))
+                for (auto i : utils::Range(state.getNumBlocks()))
+                    state.data((sim::DefaultConfig::Plane) p)[i] = uint();
+            return state;
+        }
+
+        void attributes(Attributes &attribs) {
+            auto numVendors = uint();
+            for ([[maybe_unused]] auto i : utils::Range(numVendors)) {
+                auto &vendor = attribs.userDefinedVendorAttributes[string()];
+                auto numAttribs = uint();
+                for ([[maybe_unused]] auto j : utils::Range(numAttribs)) {
+                    auto &attrib = vendor[string()];
+                    attrib.type = string();
+                    attrib.value = string();
+                }
+            }
+        }
+
+        void registerAttributes(RegisterAttributes &attribs) {
+            attributes(attribs);
+            attribs.resetType = enumeration<RegisterAttributes::ResetType>(3);
+            attribs.initializeRegs = boolean();
+            attribs.resetHighActive = boolean();
+            attribs.registerResetPinUsage = enumeration<RegisterAttributes::UsageType>(3);
+            attribs.registerEnablePinUsage = enumeration<RegisterAttributes::UsageType>(3);
+        }
+
+        template<typename T>
+        void optional(std::optional<T> &value) {
+            if (boolean())
+                value = (T) uint();
+            else
+                value.reset();
+        }
+
+        size_t index(size_t count) {
+            auto idx = uint();
+            HCL_DESIGNCHECK_HINT(idx == NONE || idx < count, "Serialized circuit is corrupt!");
+            return idx;
+        }
+    protected:
+        std::istream &m_stream;
+};
+
+
+class NodeParameterWriter : public ConstNodeVisitor
+{
+    public:
+        NodeParameterWriter(Writer &writer) : m_writer(writer) { }
+
+        virtual void operator()(const Node_Arithmetic &node) override { m_writer.uint(node.getOp()); }
+        virtual void operator()(const Node_Clk2Signal &node) override { HCL_DESIGNCHECK_HINT(false, "Clock to signal nodes can not be serialized!"); }
+        virtual void operator()(const Node_Compare &node) override { m_writer.uint(node.getOp()); }
+        virtual void operator()(const Node_Constant &node) override { m_writer.state(node.getValue()); }
+        virtual void operator()(const Node_External &node) override { HCL_DESIGNCHECK_HINT(false, "External nodes can not be serialized!"); }
+        virtual void operator()(const Node_Logic &node) override { m_writer.uint(node.getOp()); }
+        virtual void operator()(const Node_Multiplexer &node) override { m_writer.uint(node.getConditionId()); }
+        virtual void operator()(const Node_Pin &node) override {
+            m_writer.boolean(node.isDifferential());
+            if (node.isDifferential()) {
+                m_writer.string(node.getDifferentialPosName());
+                m_writer.string(node.getDifferentialNegName());
+            }
+        }
+        virtual void operator()(const Node_PipelineRegister &node) override { m_writer.uint(node.getNumStages()); }
+        virtual void operator()(const Node_PriorityConditional &node) override { }
+        virtual void operator()(const Node_Register &node) override { m_writer.uint(node.getConditionId()); }
+        virtual void operator()(const Node_Rewire &node) override {
+            const auto &ranges = node.getOp().ranges;
+            m_writer.uint(ranges.size());
+            for (const auto &range : ranges) {
+                m_writer.uint(range.subwidth);
+                m_writer.uint(range.source);
+                m_writer.uint(range.inputIdx);
+                m_writer.uint(range.inputOffset);
+            }
+        }
+        virtual void operator()(const Node_Shift &node) override {
+            m_writer.uint((unsigned) node.getDirection());
+            m_writer.uint((unsigned) node.getFillMode());
+        }
+        virtual void operator()(const Node_Signal &node) override { }
+        virtual void operator()(const Node_SignalGenerator &node) override { HCL_DESIGNCHECK_HINT(false, "Signal generators can not be serialized!"); }
+        virtual void operator()(const Node_SignalTap &node) override {
+            m_writer.uint(node.getLevel());
+            m_writer.uint(node.getTrigger());
+            m_writer.uint(node.getLogMessage().size());
+            for (const auto &part : node.getLogMessage()) {
+                if (const auto *str = boost::get<std::string>(&part)) {
+                    m_writer.uint(0);
+                    m_writer.string(*str);
+                } else {
+                    const auto &signal = boost::get<Node_SignalTap::FormattedSignal>(part);
+                    m_writer.uint(1);
+                    m_writer.uint(signal.inputIdx);
+                    m_writer.uint(signal.format);
+                }
+            }
+        }
+        virtual void operator()(const Node_Memory &node) override {
+            m_writer.uint((unsigned) node.type());
+            m_writer.boolean(node.noConflicts());
+            m_writer.state(node.getPowerOnState());
+        }
+        virtual void operator()(const Node_MemPort &node) override { m_writer.uint(node.getBitWidth()); }
+        virtual void operator()(const Node_Default &node) override { }
+        virtual void operator()(const Node_ExportOverride &node) override { }
+        virtual void operator()(const Node_Attributes &node) override {
+            const auto &attribs = node.getAttribs();
+            m_writer.attributes(attribs);
+            m_writer.optional(attribs.maxFanout);
+            m_writer.optional(attribs.crossingClockDomain);
+            m_writer.optional(attribs.allowFusing);
+        }
+        virtual void operator()(const Node_PathAttributes &node) override {
+            const auto &attribs = node.getAttribs();
+            m_writer.attributes(attribs);
+            m_writer.uint(attribs.multiCycle);
+            m_writer.boolean(attribs.falsePath);
+        }
+    protected:
+        Writer &m_writer;
+};
+
+/// Determines the type tag of a node, separate from NodeParameterWriter since the tag precedes the generic node data.
+class NodeTypeVisitor : public ConstNodeVisitor
+{
+    public:
+        virtual void operator()(const Node_Arithmetic &node) override { type = NodeType::ARITHMETIC; }
+        virtual void operator()(const Node_Clk2Signal &node) override { serializable = false; }
+        virtual void operator()(const Node_Compare &node) override { type = NodeType::COMPARE; }
+        virtual void operator()(const Node_Constant &node) override { type = NodeType::CONSTANT; }
+        virtual void operator()(const Node_External &node) override { serializable = false; }
+        virtual void operator()(const Node_Logic &node) override { type = NodeType::LOGIC; }
+        virtual void operator()(const Node_Multiplexer &node) override { type = NodeType::MULTIPLEXER; }
+        virtual void operator()(const Node_Pin &node) override { type = NodeType::PIN; }
+        virtual void operator()(const Node_PipelineRegister &node) override { type = NodeType::PIPELINE_REGISTER; }
+        virtual void operator()(const Node_PriorityConditional &node) override { type = NodeType::PRIORITY_CONDITIONAL; }
+        virtual void operator()(const Node_Register &node) override { type = NodeType::REGISTER; }
+        virtual void operator()(const Node_Rewire &node) override { type = NodeType::REWIRE; }
+        virtual void operator()(const Node_Shift &node) override { type = NodeType::SHIFT; }
+        virtual void operator()(const Node_Signal &node) override { type = NodeType::SIGNAL; }
+        virtual void operator()(const Node_SignalGenerator &node) override { serializable = false; }
+        virtual void operator()(const Node_SignalTap &node) override { type = NodeType::SIGNAL_TAP; }
+        virtual void operator()(const Node_Memory &node) override { type = NodeType::MEMORY; }
+        virtual void operator()(const Node_MemPort &node) override { type = NodeType::MEM_PORT; }
+        virtual void operator()(const Node_Default &node) override { type = NodeType::DEFAULT; }
+        virtual void operator()(const Node_ExportOverride &node) override { type = NodeType::EXPORT_OVERRIDE; }
+        virtual void operator()(const Node_Attributes &node) override { type = NodeType::ATTRIBUTES; }
+        virtual void operator()(const Node_PathAttributes &node) override { type = NodeType::PATH_ATTRIBUTES; }
+
+        NodeType type = NodeType::SIGNAL;
+        bool serializable = true;
+};
+
+struct PendingMemoryGroup {
+    MemoryGroup *group;
+    size_t memory;
+    std::vector<size_t> writePorts;
+    struct ReadPort {
+        size_t node;
+        size_t syncReadDataReg;
+        size_t outputReg;
+        size_t dataOutputNode;
+        size_t dataOutputPort;
+    };
+    std::vector<ReadPort> readPorts;
+};
+
+}
+
+bool Circuit::isSerializable() const
+{
+    for (const auto &node : m_nodes) {
+        NodeTypeVisitor visitor;
+        node->visit(visitor);
+        if (!visitor.serializable)
+            return false;
+    }
+    return true;
+}
+
+void Circuit::serialize(std::ostream &stream) const
+{
+    Writer writer(stream);
+
+    std::map<const BaseNode*, size_t> node2idx;
+    for (auto i : utils::Range(m_nodes.size()))
+        node2idx[m_nodes[i].get()] = i;
+    auto nodeIdx = [&](const BaseNode *node)->std::uint64_t {
+        if (node == nullptr) return NONE;
+        return node2idx.at(node);
+    };
+
+    std::map<const Clock*, size_t> clock2idx;
+    for (auto i : utils::Range(m_clocks.size()))
+        clock2idx[m_clocks[i].get()] = i;
+    auto clockIdx = [&](const Clock *clock)->std::uint64_t {
+        if (clock == nullptr) return NONE;
+        return clock2idx.at(clock);
+    };
+
+    stream.write(CIRCUIT_MAGIC, sizeof(CIRCUIT_MAGIC));
+    writer.uint(CIRCUIT_FORMAT_VERSION);
+
+    writer.uint(m_clocks.size());
+    for (const auto &clock : m_clocks) {
+        const auto *derived = dynamic_cast<const DerivedClock*>(clock.get());
+        writer.uint((unsigned) (derived?ClockKind::DERIVED:ClockKind::ROOT));
+        writer.uint(clockIdx(clock->getParentClock()));
+        writer.string(clock->getName());
+        writer.string(clock->getResetName());
+        writer.uint((unsigned) clock->getTriggerEvent());
+        writer.boolean(clock->getPhaseSynchronousWithParent());
+        writer.registerAttributes(clock->getRegAttribs());
+        if (derived)
+            writer.rational(derived->getFrequencyMuliplier());
+        else
+            writer.rational(clock->getAbsoluteFrequency());
+    }
+
+    std::function<void(const NodeGroup*)> writeGroup;
+    writeGroup = [&](const NodeGroup *group) {
+        const auto *memoryGroup = dynamic_cast<const MemoryGroup*>(group);
+        writer.uint((unsigned) (memoryGroup?GroupKind::MEMORY:GroupKind::PLAIN));
+        writer.uint((unsigned) group->getGroupType());
+        writer.string(group->getName());
+        writer.string(group->getInstanceName());
+        writer.string(group->getComment());
+
+        writer.uint(group->getNodes().size());
+        for (const auto *node : group->getNodes())
+            writer.uint(nodeIdx(node));
+
+        if (memoryGroup) {
+            writer.uint(nodeIdx(memoryGroup->getMemory()));
+            writer.uint(memoryGroup->getWritePorts().size());
+            for (const auto &wp : memoryGroup->getWritePorts())
+                writer.uint(nodeIdx(wp.node.get()));
+            writer.uint(memoryGroup->getReadPorts().size());
+            for (const auto &rp : memoryGroup->getReadPorts()) {
+                writer.uint(nodeIdx(rp.node.get()));
+                writer.uint(nodeIdx(rp.syncReadDataReg.get()));
+                writer.uint(nodeIdx(rp.outputReg.get()));
+                writer.uint(nodeIdx(rp.dataOutput.node.get()));
+                writer.uint(rp.dataOutput.port);
+            }
+        }
+
+        writer.uint(group->getChildren().size());
+        for (const auto &child : group->getChildren())
+            writeGroup(child.get());
+    };
+    writeGroup(m_root.get());
+
+    writer.uint(m_nodes.size());
+    for (const auto &node : m_nodes) {
+        NodeTypeVisitor typeVisitor;
+        node->visit(typeVisitor);
+        HCL_DESIGNCHECK_HINT(typeVisitor.serializable, "The circuit contains nodes which can not be serialized, see Circuit::isSerializable()!");
+
+        writer.uint((unsigned) typeVisitor.type);
+        writer.uint(node->getId());
+        writer.string(node->getName());
+        writer.boolean(node->nameWasInferred());
+        writer.string(node->getComment());
+
+        writer.uint(node->getNumInputPorts());
+        writer.uint(node->getNumOutputPorts());
+        for (auto i : utils::Range(node->getNumOutputPorts())) {
+            const auto &connectionType = node->getOutputConnectionType(i);
+            writer.uint(connectionType.interpretation);
+            writer.uint(connectionType.width);
+            writer.uint(node->getOutputType(i));
+        }
+
+        writer.uint(node->getClocks().size());
+        for (auto *clock : node->getClocks())
+            writer.uint(clockIdx(clock));
+
+        NodeParameterWriter parameterWriter(writer);
+        node->visit(parameterWriter);
+    }
+
+    for (const auto &node : m_nodes)
+        for (auto i : utils::Range(node->getNumOutputPorts())) {
+            const auto &consumers = node->getDirectlyDriven(i);
+            writer.uint(consumers.size());
+            for (const auto &consumer : consumers) {
+                writer.uint(nodeIdx(consumer.node));
+                writer.uint(consumer.port);
+            }
+        }
+
+    writer.uint(m_nextNodeId);
+}
+
+void Circuit::deserialize(std::istream &stream)
+{
+    HCL_ASSERT_HINT(m_nodes.empty() && m_clocks.empty() && m_root->getChildren().empty(), "Circuits can only be deserialized into empty circuits!");
+
+    Reader reader(stream);
+
+    char magic[sizeof(CIRCUIT_MAGIC)];
+    stream.read(magic, sizeof(magic));
+    HCL_DESIGNCHECK_HINT(stream && std::equal(magic, magic+sizeof(magic), CIRCUIT_MAGIC), "Not a serialized circuit!");
+    HCL_DESIGNCHECK_HINT(reader.uint() == CIRCUIT_FORMAT_VERSION, "Serialized circuit was written with an incompatible format version!");
+
+    auto numClocks = reader.uint();
+    for (auto i : utils::Range(numClocks)) {
+        auto kind = reader.enumeration<ClockKind>(2);
+        auto parentIdx = reader.index(i);
+        auto name = reader.string();
+        auto resetName = reader.string();
+        auto triggerEvent = reader.enumeration<Clock::TriggerEvent>(3);
+        bool phaseSync = reader.boolean();
+        RegisterAttributes regAttribs;
+        reader.registerAttributes(regAttribs);
+        auto frequency = reader.rational();
+
+        Clock *clock;
+        if (kind == ClockKind::DERIVED) {
+            HCL_DESIGNCHECK_HINT(parentIdx != NONE, "Serialized circuit is corrupt!");
+            auto *derived = createClock<DerivedClock>(m_clocks[parentIdx].get());
+            derived->setFrequencyMuliplier(frequency);
+            clock = derived;
+        } else
+            clock = createClock<RootClock>(name, frequency);
+
+        clock->setName(std::move(name));
+        clock->setResetName(std::move(resetName));
+        clock->setTriggerEvent(triggerEvent);
+        clock->setPhaseSynchronousWithParent(phaseSync);
+        clock->getRegAttribs() = std::move(regAttribs);
+    }
+
+    std::vector<std::pair<NodeGroup*, std::vector<size_t>>> groupNodes;
+    std::vector<PendingMemoryGroup> memoryGroups;
+    std::function<void(NodeGroup*)> readGroup;
+    readGroup = [&](NodeGroup *parent) {
+        auto kind = reader.enumeration<GroupKind>(2);
+        auto groupType = (NodeGroup::GroupType) reader.uint();
+
+        NodeGroup *group;
+        if (parent == nullptr) {
+            HCL_DESIGNCHECK_HINT(kind == GroupKind::PLAIN, "Serialized circuit is corrupt!");
+            group = m_root.get();
+        } else if (kind == GroupKind::MEMORY)
+            group = parent->addSpecialChildNodeGroup<MemoryGroup>();
+        else
+            group = parent->addChildNodeGroup(groupType);
+
+        group->setName(reader.string());
+        group->setInstanceName(reader.string());
+        group->setComment(reader.string());
+
+        std::vector<size_t> nodes(reader.uint());
+        for (auto &n : nodes)
+            n = reader.uint();
+        groupNodes.push_back({group, std::move(nodes)});
+
+        if (kind == GroupKind::MEMORY) {
+            PendingMemoryGroup pending;
+            pending.group = (MemoryGroup*) group;
+            pending.memory = reader.uint();
+            pending.writePorts.resize(reader.uint());
+            for (auto &wp : pending.writePorts)
+                wp = reader.uint();
+            pending.readPorts.resize(reader.uint());
+            for (auto &rp : pending.readPorts) {
+                rp.node = reader.uint();
+                rp.syncReadDataReg = reader.uint();
+                rp.outputReg = reader.uint();
+                rp.dataOutputNode = reader.uint();
+                rp.dataOutputPort = reader.uint();
+            }
+            memoryGroups.push_back(std::move(pending));
+        }
+
+        auto numChildren = reader.uint();
+        for ([[maybe_unused]] auto i : utils::Range(numChildren))
+            readGroup(group);
+    };
+    readGroup(nullptr);
+
+    auto numNodes = reader.uint();
+    for ([[maybe_unused]] auto nodeIdx : utils::Range(numNodes)) {
+        auto type = reader.enumeration<NodeType>((size_t) NodeType::PIPELINE_REGISTER + 1);
+        auto id = reader.uint();
+        auto name = reader.string();
+        bool nameInferred = reader.boolean();
+        auto comment = reader.string();
+
+        auto numInputs = reader.uint();
+        auto numOutputs = reader.uint();
+        std::vector<std::pair<ConnectionType, NodeIO::OutputType>> outputs(numOutputs);
+        for (auto &output : outputs) {
+            output.first.interpretation = reader.enumeration<ConnectionType::Interpretation>(3);
+            output.first.width = reader.uint();
+            output.second = reader.enumeration<NodeIO::OutputType>(3);
+        }
+
+        std::vector<size_t> clocks(reader.uint());
+        for (auto &c : clocks)
+            c = reader.index(m_clocks.size());
+
+        BaseNode *node = nullptr;
+        switch (type) {
+            case NodeType::ARITHMETIC:
+                node = createNode<Node_Arithmetic>(reader.enumeration<Node_Arithmetic::Op>(Node_Arithmetic::REM+1));
+            break;
+            case NodeType::COMPARE:
+                node = createNode<Node_Compare>(reader.enumeration<Node_Compare::Op>(Node_Compare::GEQ+1));
+            break;
+            case NodeType::CONSTANT:
+                HCL_DESIGNCHECK_HINT(numOutputs == 1, "Serialized circuit is corrupt!");
+                node = createNode<Node_Constant>(reader.state(), outputs[0].first.interpretation);
+            break;
+            case NodeType::LOGIC:
+                node = createNode<Node_Logic>(reader.enumeration<Node_Logic::Op>(Node_Logic::NOT+1));
+            break;
+            case NodeType::MULTIPLEXER: {
+                HCL_DESIGNCHECK_HINT(numInputs >= 1, "Serialized circuit is corrupt!");
+                auto *mux = createNode<Node_Multiplexer>(numInputs-1);
+                mux->setConditionId(reader.uint());
+                node = mux;
+            } break;
+            case NodeType::PIN: {
+                auto *pin = createNode<Node_Pin>();
+                if (reader.boolean()) {
+                    auto posName = reader.string();
+                    auto negName = reader.string();
+                    pin->setDifferentialNames(std::move(posName), std::move(negName));
+                }
+                node = pin;
+            } break;
+            case NodeType::PRIORITY_CONDITIONAL:
+                node = createNode<Node_PriorityConditional>();
+            break;
+            case NodeType::PIPELINE_REGISTER: {
+                size_t numStages = reader.uint();
+                HCL_DESIGNCHECK_HINT(numStages > 0, "Serialized circuit is corrupt!");
+                node = createNode<Node_PipelineRegister>(numStages);
+            } break;
+            case NodeType::REGISTER: {
+                auto *reg = createNode<Node_Register>();
+                reg->setConditionId(reader.uint());
+                node = reg;
+            } break;
+            case NodeType::REWIRE: {
+                auto *rewire = createNode<Node_Rewire>(numInputs);
+                Node_Rewire::RewireOperation op;
+                op.ranges.resize(reader.uint());
+                for (auto &range : op.ranges) {
+                    range.subwidth = reader.uint();
+                    range.source = reader.enumeration<Node_Rewire::OutputRange::Source>(3);
+                    range.inputIdx = reader.uint();
+                    range.inputOffset = reader.uint();
+                }
+                rewire->setOp(std::move(op));
+                if (numOutputs == 1)
+                    rewire->changeOutputType(outputs[0].first);
+                node = rewire;
+            } break;
+            case NodeType::SHIFT: {
+                auto dir = reader.enumeration<Node_Shift::dir>(2);
+                auto fill = reader.enumeration<Node_Shift::fill>(4);
+                node = createNode<Node_Shift>(dir, fill);
+            } break;
+            case NodeType::SIGNAL:
+                node = createNode<Node_Signal>();
+            break;
+            case NodeType::SIGNAL_TAP: {
+                auto *tap = createNode<Node_SignalTap>();
+                tap->setLevel(reader.enumeration<Node_SignalTap::Level>(Node_SignalTap::LVL_WATCH+1));
+                tap->setTrigger(reader.enumeration<Node_SignalTap::Trigger>(Node_SignalTap::TRIG_FIRST_CLOCK+1));
+                auto numParts = reader.uint();
+                for ([[maybe_unused]] auto i : utils::Range(numParts)) {
+                    if (reader.boolean()) {
+                        Node_SignalTap::FormattedSignal signal;
+                        signal.inputIdx = (unsigned) reader.uint();
+                        signal.format = (unsigned) reader.uint();
+                        tap->addMessagePart(signal);
+                    } else
+                        tap->addMessagePart(reader.string());
+                }
+                node = tap;
+            } break;
+            case NodeType::MEMORY: {
+                auto *memory = createNode<Node_Memory>();
+                memory->setType(reader.enumeration<Node_Memory::MemType>(3));
+                if (reader.boolean())
+                    memory->setNoConflicts();
+                memory->setPowerOnState(reader.state());
+                node = memory;
+            } break;
+            case NodeType::MEM_PORT:
+                node = createNode<Node_MemPort>(reader.uint());
+            break;
+            case NodeType::DEFAULT:
+                node = createNode<Node_Default>();
+            break;
+            case NodeType::EXPORT_OVERRIDE:
+                node = createNode<Node_ExportOverride>();
+            break;
+            case NodeType::ATTRIBUTES: {
+                auto *attribNode = createNode<Node_Attributes>();
+                auto &attribs = attribNode->getAttribs();
+                reader.attributes(attribs);
+                reader.optional(attribs.maxFanout);
+                reader.optional(attribs.crossingClockDomain);
+                reader.optional(attribs.allowFusing);
+                node = attribNode;
+            } break;
+            case NodeType::PATH_ATTRIBUTES: {
+                auto *attribNode = createNode<Node_PathAttributes>();
+                auto &attribs = attribNode->getAttribs();
+                reader.attributes(attribs);
+                attribs.multiCycle = reader.uint();
+                attribs.falsePath = reader.boolean();
+                node = attribNode;
+            } break;
+        }
+
+        node->setId(id, {});
+        if (nameInferred)
+            node->setInferredName(std::move(name));
+        else
+            node->setName(std::move(name));
+        node->setComment(std::move(comment));
+
+        node->resizeInputs(numInputs);
+        node->resizeOutputs(numOutputs);
+        for (auto i : utils::Range(numOutputs)) {
+            node->setOutputConnectionType(i, outputs[i].first);
+            node->setOutputType(i, outputs[i].second);
+        }
+
+        HCL_DESIGNCHECK_HINT(clocks.size() == node->getClocks().size(), "Serialized circuit is corrupt!");
+        for (auto i : utils::Range(clocks.size()))
+            if (clocks[i] != NONE)
+                node->attachClock(m_clocks[clocks[i]].get(), i);
+    }
+
+    auto getNode = [&](size_t idx)->BaseNode* {
+        if (idx == NONE) return nullptr;
+        HCL_DESIGNCHECK_HINT(idx < m_nodes.size(), "Serialized circuit is corrupt!");
+        return m_nodes[idx].get();
+    };
+
+    for (auto &group : groupNodes)
+        for (auto idx : group.second) {
+            auto *node = getNode(idx);
+            HCL_DESIGNCHECK_HINT(node != nullptr && node->getGroup() == nullptr, "Serialized circuit is corrupt!");
+            node->moveToGroup(group.first);
+        }
+
+    for (auto &node : m_nodes)
+        for (auto i : utils::Range(node->getNumOutputPorts())) {
+            auto numConsumers = reader.uint();
+            for ([[maybe_unused]] auto j : utils::Range(numConsumers)) {
+                auto *consumer = getNode(reader.uint());
+                auto port = reader.uint();
+                HCL_DESIGNCHECK_HINT(consumer != nullptr && port < consumer->getNumInputPorts() && consumer->getDriver(port).node == nullptr, "Serialized circuit is corrupt!");
+                consumer->connectInput(port, {.node = node.get(), .port = i});
+            }
+        }
+
+    for (auto &pending : memoryGroups) {
+        auto *memory = dynamic_cast<Node_Memory*>(getNode(pending.memory));
+        HCL_DESIGNCHECK_HINT(memory != nullptr, "Serialized circuit is corrupt!");
+
+        std::vector<MemoryGroup::WritePort> writePorts;
+        for (auto idx : pending.writePorts)
+            writePorts.push_back({.node = NodePtr<Node_MemPort>{dynamic_cast<Node_MemPort*>(getNode(idx))}});
+
+        std::vector<MemoryGroup::ReadPort> readPorts;
+        for (const auto &rp : pending.readPorts) {
+            readPorts.push_back({});
+            auto &readPort = readPorts.back();
+            readPort.node = dynamic_cast<Node_MemPort*>(getNode(rp.node));
+            readPort.syncReadDataReg = dynamic_cast<Node_Register*>(getNode(rp.syncReadDataReg));
+            readPort.outputReg = dynamic_cast<Node_Register*>(getNode(rp.outputReg));
+            readPort.dataOutput = NodePort{.node = getNode(rp.dataOutputNode), .port = rp.dataOutputPort};
+        }
+        pending.group->restore(memory, std::move(writePorts), std::move(readPorts));
+    }
+
+    m_nextNodeId = reader.uint();
+}
+
+}
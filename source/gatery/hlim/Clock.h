@@ -110,6 +110,7 @@ class DerivedClock : public Clock
         virtual ClockRational getFrequencyRelativeTo(Clock &other) const override;
         
         inline void setFrequencyMuliplier(ClockRational m) { m_parentRelativeMultiplicator = m; }
+        inline const ClockRational &getFrequencyMuliplier() const { return m_parentRelativeMultiplicator; }
 
         virtual std::unique_ptr<Clock> cloneUnconnected(Clock *newParent) override;
     protected:
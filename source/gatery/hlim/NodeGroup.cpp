@@ -79,6 +79,7 @@ void NodeGroup::moveInto(NodeGroup *newParent)
     newParent->m_children.push_back(std::move(m_parent->m_children[parentIdx]));
     m_parent->m_children[parentIdx] = std::move(m_parent->m_children.back());
     m_parent->m_children.pop_back();
+    m_parent = newParent;
 }
 
 bool NodeGroup::isChildOf(const NodeGroup *other) const
@@ -27,6 +27,7 @@ class Node_External;
 class Node_Logic;
 class Node_Multiplexer;
 class Node_Pin;
+class Node_PipelineRegister;
 class Node_PriorityConditional;
 class Node_Register;
 class Node_Rewire;
@@ -54,6 +55,7 @@ class NodeVisitor
         virtual void operator()(Node_Logic &node) = 0;
         virtual void operator()(Node_Multiplexer &node) = 0;
         virtual void operator()(Node_Pin &node) = 0;
+        virtual void operator()(Node_PipelineRegister &node) = 0;
         virtual void operator()(Node_PriorityConditional &node) = 0;
         virtual void operator()(Node_Register &node) = 0;
         virtual void operator()(Node_Rewire &node) = 0;
@@ -80,6 +82,7 @@ class ConstNodeVisitor
         virtual void operator()(const Node_Logic &node) = 0;
         virtual void operator()(const Node_Multiplexer &node) = 0;
         virtual void operator()(const Node_Pin &node) = 0;
+        virtual void operator()(const Node_PipelineRegister &node) = 0;
         virtual void operator()(const Node_PriorityConditional &node) = 0;
         virtual void operator()(const Node_Register &node) = 0;
         virtual void operator()(const Node_Rewire &node) = 0;
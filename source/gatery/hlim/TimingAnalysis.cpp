@@ -0,0 +1,324 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#include "gatery/pch.h"
+#include "TimingAnalysis.h"
+
+#include "Circuit.h"
+#include "coreNodes/Node_Arithmetic.h"
+#include "coreNodes/Node_Compare.h"
+#include "coreNodes/Node_Constant.h"
+#include "coreNodes/Node_Logic.h"
+#include "coreNodes/Node_Multiplexer.h"
+#include "coreNodes/Node_Pin.h"
+#include "coreNodes/Node_PriorityConditional.h"
+#include "coreNodes/Node_Rewire.h"
+#include "coreNodes/Node_Shift.h"
+#include "coreNodes/Node_Signal.h"
+#include "supportNodes/Node_Attributes.h"
+#include "supportNodes/Node_ExportOverride.h"
+#include "supportNodes/Node_External.h"
+#include "supportNodes/Node_Memory.h"
+#include "supportNodes/Node_SignalGenerator.h"
+
+#include "../utils/BitManipulation.h"
+#include "../utils/Range.h"
+
+#include <algorithm>
+#include <ostream>
+#include <set>
+
+namespace gtry::hlim {
+
+namespace {
+
+/// Inputs of the lookup tables that form one logic level.
+const size_t LUT_INPUTS = 6;
+/// Bits of a dedicated carry chain that amount to the delay of one logic level.
+const size_t CARRY_BITS_PER_LEVEL = 16;
+
+size_t lutLevels(size_t numInputs)
+{
+    size_t levels = 1;
+    for (size_t covered = LUT_INPUTS; covered < numInputs; covered *= LUT_INPUTS)
+        levels++;
+    return levels;
+}
+
+size_t carryChainLevels(size_t width)
+{
+    return 1 + width / CARRY_BITS_PER_LEVEL;
+}
+
+size_t getInputWidth(const BaseNode *node, size_t input)
+{
+    auto driver = node->getDriver(input);
+    if (driver.node == nullptr) return 0;
+    return getOutputWidth(driver);
+}
+
+/// Nodes whose outputs start paths instead of propagating them.
+bool isStartPoint(const BaseNode *node)
+{
+    return !node->isCombinatorial() ||
+        dynamic_cast<const Node_Pin*>(node) ||
+        dynamic_cast<const Node_Memory*>(node) ||
+        dynamic_cast<const Node_External*>(node) ||
+        dynamic_cast<const Node_SignalGenerator*>(node);
+}
+
+/// Nodes whose inputs end paths.
+bool isEndPoint(const BaseNode *node)
+{
+    return !node->isCombinatorial() || dynamic_cast<const Node_Pin*>(node);
+}
+
+const Clock *getFirstClock(const BaseNode *node)
+{
+    for (auto *clock : node->getClocks())
+        if (clock != nullptr)
+            return clock;
+    return nullptr;
+}
+
+std::string getGroupPath(const NodeGroup *group)
+{
+    std::string path;
+    for (; group != nullptr; group = group->getParent())
+        if (!group->getName().empty())
+            path = path.empty() ? group->getName() : group->getName() + "/" + path;
+    return path;
+}
+
+void writeNode(std::ostream &stream, const BaseNode *node)
+{
+    stream << node->getTypeName();
+    if (!node->getName().empty())
+        stream << " \"" << node->getName() << '"';
+    stream << " in " << getGroupPath(node->getGroup());
+}
+
+}
+
+size_t estimateLogicLevels(const BaseNode *node)
+{
+    if (dynamic_cast<const Node_Signal*>(node) ||
+        dynamic_cast<const Node_Rewire*>(node) ||
+        dynamic_cast<const Node_Constant*>(node) ||
+        dynamic_cast<const Node_Attributes*>(node) ||
+        dynamic_cast<const Node_ExportOverride*>(node))
+        return 0;
+
+    if (auto *arith = dynamic_cast<const Node_Arithmetic*>(node)) {
+        size_t width = getOutputWidth({.node = const_cast<BaseNode*>(node), .port = 0ull});
+        switch (arith->getOp()) {
+            case Node_Arithmetic::ADD:
+            case Node_Arithmetic::SUB:
+                return carryChainLevels(width);
+            case Node_Arithmetic::MUL:
+                // Partial products summed in an adder tree
+                return 1 + 2 * utils::Log2C(std::max<size_t>(width, 1)) + carryChainLevels(width);
+            case Node_Arithmetic::DIV:
+            case Node_Arithmetic::REM:
+                // One subtraction per quotient bit
+                return width * carryChainLevels(width);
+        }
+    }
+
+    if (auto *compare = dynamic_cast<const Node_Compare*>(node)) {
+        size_t width = std::max(getInputWidth(node, 0), getInputWidth(node, 1));
+        if (compare->getOp() == Node_Compare::EQ || compare->getOp() == Node_Compare::NEQ)
+            return lutLevels(2 * width);
+        return carryChainLevels(width);
+    }
+
+    if (auto *logic = dynamic_cast<const Node_Logic*>(node)) {
+        // Inverters get absorbed into neighboring lookup tables.
+        if (logic->getOp() == Node_Logic::NOT)
+            return 0;
+        return lutLevels(node->getNumInputPorts());
+    }
+
+    if (dynamic_cast<const Node_Multiplexer*>(node)) {
+        size_t numDataInputs = std::max<size_t>(node->getNumInputPorts() - 1, 1);
+        return lutLevels(numDataInputs + utils::Log2C(numDataInputs));
+    }
+
+    if (dynamic_cast<const Node_Shift*>(node)) {
+        // Barrel shifter, each level of 4:1 multiplexers handles two bits of the shift amount.
+        size_t amountWidth = getInputWidth(node, 1);
+        return std::max<size_t>((amountWidth + 1) / 2, 1);
+    }
+
+    if (auto *prio = dynamic_cast<const Node_PriorityConditional*>(node)) {
+        // Chain of 2:1 multiplexers, two per logic level.
+        return std::max<size_t>((prio->getNumChoices() + 1) / 2, 1);
+    }
+
+    return 1;
+}
+
+
+TimingAnalysis::TimingAnalysis(const Circuit &circuit)
+{
+    for (const auto &node : circuit.getNodes()) {
+        if (!isEndPoint(node.get())) continue;
+
+        for (auto i : utils::Range(node->getNumInputPorts())) {
+            auto driver = node->getDriver(i);
+            if (driver.node == nullptr) continue;
+
+            const auto &arrival = computeArrival(driver);
+            const Clock *clock = getFirstClock(node.get());
+            if (clock == nullptr)
+                clock = arrival.clock;
+
+            m_endPoints.push_back({.input = {.node = node.get(), .port = i}, .clock = clock, .levels = arrival.levels});
+        }
+    }
+}
+
+const TimingAnalysis::Arrival &TimingAnalysis::computeArrival(const NodePort &output)
+{
+    // Depth first without recursion, since combinational paths can be long.
+    // Nodes that are still being processed break combinational loops.
+    std::set<BaseNode*> inProgress;
+    std::vector<std::pair<NodePort, bool>> stack = {{output, false}};
+    while (!stack.empty()) {
+        auto [np, inputsDone] = stack.back();
+        if (m_arrivals.contains(np)) {
+            stack.pop_back();
+            continue;
+        }
+
+        auto *node = np.node;
+        if (isStartPoint(node) || outputIsDependency(np)) {
+            m_arrivals[np] = {.clock = getFirstClock(node)};
+            stack.pop_back();
+            continue;
+        }
+
+        if (!inputsDone) {
+            stack.back().second = true;
+            inProgress.insert(node);
+            for (auto i : utils::Range(node->getNumInputPorts())) {
+                auto driver = node->getDriver(i);
+                if (driver.node != nullptr && !m_arrivals.contains(driver) && !inProgress.contains(driver.node))
+                    stack.push_back({driver, false});
+            }
+            continue;
+        }
+
+        stack.pop_back();
+        inProgress.erase(node);
+
+        Arrival arrival;
+        for (auto i : utils::Range(node->getNumInputPorts())) {
+            auto driver = node->getDriver(i);
+            auto it = m_arrivals.find(driver);
+            if (it == m_arrivals.end()) continue;
+            if (arrival.critical.node == nullptr || it->second.levels > arrival.levels) {
+                arrival.levels = it->second.levels;
+                arrival.critical = driver;
+                arrival.clock = it->second.clock;
+            }
+        }
+        arrival.levels += estimateLogicLevels(node);
+        m_arrivals[np] = arrival;
+    }
+    return m_arrivals.at(output);
+}
+
+size_t TimingAnalysis::getLogicLevels(const NodePort &output) const
+{
+    auto it = m_arrivals.find(output);
+    if (it == m_arrivals.end()) return 0;
+    return it->second.levels;
+}
+
+std::vector<const Clock*> TimingAnalysis::getClocks() const
+{
+    std::vector<const Clock*> clocks;
+    for (const auto &endPoint : m_endPoints)
+        if (std::find(clocks.begin(), clocks.end(), endPoint.clock) == clocks.end())
+            clocks.push_back(endPoint.clock);
+    return clocks;
+}
+
+std::vector<TimingPath> TimingAnalysis::getWorstPaths(const Clock *clock, size_t count) const
+{
+    std::vector<const EndPoint*> endPoints;
+    for (const auto &endPoint : m_endPoints)
+        if (endPoint.clock == clock)
+            endPoints.push_back(&endPoint);
+
+    count = std::min(count, endPoints.size());
+    std::partial_sort(endPoints.begin(), endPoints.begin() + count, endPoints.end(), [](const EndPoint *lhs, const EndPoint *rhs) {
+        if (lhs->levels != rhs->levels) return lhs->levels > rhs->levels;
+        return lhs->input.node->getId() < rhs->input.node->getId();
+    });
+
+    std::vector<TimingPath> paths(count);
+    for (auto i : utils::Range(count)) {
+        auto &path = paths[i];
+        path.clock = clock;
+        path.logicLevels = endPoints[i]->levels;
+        path.endPoint = endPoints[i]->input;
+
+        for (NodePort np = path.endPoint.node->getDriver(path.endPoint.port); np.node != nullptr; np = m_arrivals.at(np).critical)
+            path.outputs.push_back(np);
+        std::reverse(path.outputs.begin(), path.outputs.end());
+    }
+    return paths;
+}
+
+void TimingAnalysis::writeReport(std::ostream &stream, size_t numPathsPerClock, bool withStackTraces) const
+{
+    for (const auto *clock : getClocks()) {
+        auto paths = getWorstPaths(clock, numPathsPerClock);
+        if (paths.empty()) continue;
+
+        stream << "Clock " << (clock != nullptr ? clock->getName() : std::string("<unclocked>"))
+            << ": deepest path has " << paths.front().logicLevels << " logic levels" << std::endl;
+
+        for (auto i : utils::Range(paths.size())) {
+            const auto &path = paths[i];
+            stream << "    Path " << i+1 << " with " << path.logicLevels << " logic levels into " << path.endPoint.node->getInputName(path.endPoint.port) << " of ";
+            writeNode(stream, path.endPoint.node);
+            stream << std::endl;
+
+            for (auto j : utils::Range(path.outputs.size())) {
+                const auto &np = path.outputs[j];
+                if (dynamic_cast<const Node_Signal*>(np.node)) continue;
+                if (j == 0)
+                    stream << "        start ";
+                else
+                    stream << "        +" << estimateLogicLevels(np.node) << " (" << getLogicLevels(np) << ") ";
+                writeNode(stream, np.node);
+                stream << std::endl;
+                if (withStackTraces)
+                    stream << np.node->getStackTrace();
+            }
+            if (withStackTraces) {
+                stream << "        End point:" << std::endl;
+                stream << path.endPoint.node->getStackTrace();
+            }
+        }
+    }
+}
+
+}
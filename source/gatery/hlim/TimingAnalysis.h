@@ -0,0 +1,91 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#pragma once
+
+#include "NodePort.h"
+
+#include <vector>
+#include <map>
+#include <iosfwd>
+
+namespace gtry::hlim {
+
+class Circuit;
+class Clock;
+class BaseNode;
+
+/**
+ * @brief Rough number of logic levels (lookup tables or equivalent carry chain delay) a node adds to combinational paths through it.
+ * @details Wiring, constants, and signals are free. Arithmetic and comparisons scale with the operand width,
+ * multiplexers and shifters with the number of inputs they select from.
+ */
+size_t estimateLogicLevels(const BaseNode *node);
+
+/// A combinational path between two registers, pins, or memory ports.
+struct TimingPath {
+    /// Clock of the node the path ends in, or of the path's start point for paths into output pins. Nullptr if neither is clocked.
+    const Clock *clock = nullptr;
+    size_t logicLevels = 0;
+    /// Input port in which the path ends.
+    NodePort endPoint;
+    /// Outputs along the path, from the start point to the driver of the end point.
+    std::vector<NodePort> outputs;
+};
+
+/**
+ * @brief Estimates the logic depth of all register to register paths to find the ones that will limit Fmax.
+ * @details Paths start at the outputs of clocked nodes, pins, and memories and end at the inputs of clocked nodes and pins.
+ * The depth of each path is the sum of estimateLogicLevels() of its nodes. This is no substitute for vendor timing analysis,
+ * but cheap enough to iterate on before synthesis.
+ */
+class TimingAnalysis
+{
+    public:
+        TimingAnalysis(const Circuit &circuit);
+
+        /// Logic levels between the output and the latest start point driving it.
+        size_t getLogicLevels(const NodePort &output) const;
+
+        /// All clocks with at least one path, nullptr representing unclocked paths.
+        std::vector<const Clock*> getClocks() const;
+        /// The deepest paths ending in the given clock domain, deepest first.
+        std::vector<TimingPath> getWorstPaths(const Clock *clock, size_t count) const;
+
+        /// Lists the deepest paths of each clock domain with the node groups and optionally stack traces of their nodes.
+        void writeReport(std::ostream &stream, size_t numPathsPerClock = 5, bool withStackTraces = true) const;
+    protected:
+        struct Arrival {
+            size_t levels = 0;
+            /// Driver of the input on the deepest path into this output.
+            NodePort critical = {};
+            /// Clock of the start point of the deepest path into this output.
+            const Clock *clock = nullptr;
+        };
+        struct EndPoint {
+            NodePort input;
+            const Clock *clock;
+            size_t levels;
+        };
+
+        std::map<NodePort, Arrival> m_arrivals;
+        std::vector<EndPoint> m_endPoints;
+
+        const Arrival &computeArrival(const NodePort &output);
+};
+
+}
@@ -103,5 +103,12 @@ void Node_Pin::setDifferential(std::string_view posPrefix, std::string_view negP
     m_differentialNegName = m_name + std::string(negPrefix);
 }
 
+void Node_Pin::setDifferentialNames(std::string posName, std::string negName)
+{
+    m_differential = true;
+    m_differentialPosName = std::move(posName);
+    m_differentialNegName = std::move(negName);
+}
+
 
 }
@@ -53,8 +53,10 @@ namespace gtry::hlim {
             void setNormal() { m_differential = false; }
 
             inline bool isDifferential() const { return m_differential; }
-            inline const std::string &getDifferentialPosName() { return m_differentialPosName; }
-            inline const std::string &getDifferentialNegName() { return m_differentialNegName; }
+            inline const std::string &getDifferentialPosName() const { return m_differentialPosName; }
+            inline const std::string &getDifferentialNegName() const { return m_differentialNegName; }
+            /// Sets the names of both pins of a differential pair verbatim.
+            void setDifferentialNames(std::string posName, std::string negName);
         protected:
             bool m_differential = false;
             std::string m_differentialPosName;
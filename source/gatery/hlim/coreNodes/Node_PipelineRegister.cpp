@@ -17,3 +17,125 @@
 */
 #include "gatery/pch.h"
 #include "Node_PipelineRegister.h"
+
+namespace gtry::hlim {
+
+Node_PipelineRegister::Node_PipelineRegister(size_t numStages) : Node(NUM_INPUTS, 1), m_numStages(numStages)
+{
+    HCL_DESIGNCHECK_HINT(m_numStages > 0, "A pipeline register needs at least one stage!");
+    m_clocks.resize(1);
+    setOutputType(0, OUTPUT_LATCHED);
+}
+
+void Node_PipelineRegister::connectInput(Input input, const NodePort &port)
+{
+    NodeIO::connectInput(input, port);
+    if (port.node != nullptr && input == DATA)
+        setOutputConnectionType(0, port.node->getOutputConnectionType(port.port));
+}
+
+void Node_PipelineRegister::setClock(Clock *clk)
+{
+    attachClock(clk, 0);
+}
+
+void Node_PipelineRegister::simulateReset(sim::SimulatorCallbacks &simCallbacks, sim::DefaultBitVectorState &state, const size_t *internalOffsets, const size_t *outputOffsets) const
+{
+    size_t width = getOutputConnectionType(0).width;
+    state.clearRange(sim::DefaultConfig::DEFINED, internalOffsets[INT_STAGES], width * (m_numStages-1));
+    state.clearRange(sim::DefaultConfig::DEFINED, outputOffsets[0], width);
+}
+
+void Node_PipelineRegister::simulateEvaluate(sim::SimulatorCallbacks &simCallbacks, sim::DefaultBitVectorState &state, const size_t *internalOffsets, const size_t *inputOffsets, const size_t *outputOffsets) const
+{
+    if (inputOffsets[DATA] == ~0ull)
+        state.clearRange(sim::DefaultConfig::DEFINED, internalOffsets[INT_DATA], getOutputConnectionType(0).width);
+    else
+        state.copyRange(internalOffsets[INT_DATA], state, inputOffsets[DATA], getOutputConnectionType(0).width);
+
+    if (inputOffsets[ENABLE] == ~0ull) {
+        state.setRange(sim::DefaultConfig::DEFINED, internalOffsets[INT_ENABLE], 1);
+        state.setRange(sim::DefaultConfig::VALUE, internalOffsets[INT_ENABLE], 1);
+    } else
+        state.copyRange(internalOffsets[INT_ENABLE], state, inputOffsets[ENABLE], 1);
+}
+
+void Node_PipelineRegister::simulateAdvance(sim::SimulatorCallbacks &simCallbacks, sim::DefaultBitVectorState &state, const size_t *internalOffsets, const size_t *outputOffsets, size_t clockPort) const
+{
+    HCL_ASSERT(clockPort == 0);
+
+    size_t width = getOutputConnectionType(0).width;
+
+    bool enableDefined = state.get(sim::DefaultConfig::DEFINED, internalOffsets[INT_ENABLE]);
+    bool enable = state.get(sim::DefaultConfig::VALUE, internalOffsets[INT_ENABLE]);
+
+    if (!enableDefined) {
+        state.clearRange(sim::DefaultConfig::DEFINED, internalOffsets[INT_STAGES], width * (m_numStages-1));
+        state.clearRange(sim::DefaultConfig::DEFINED, outputOffsets[0], width);
+        return;
+    }
+    if (!enable) return;
+
+    // Stage i holds the input of i+1 ticks ago, the output is the last stage.
+    if (m_numStages == 1) {
+        state.copyRange(outputOffsets[0], state, internalOffsets[INT_DATA], width);
+        return;
+    }
+    state.copyRange(outputOffsets[0], state, internalOffsets[INT_STAGES] + (m_numStages-2) * width, width);
+    for (size_t i = m_numStages-2; i > 0; i--)
+        state.copyRange(internalOffsets[INT_STAGES] + i * width, state, internalOffsets[INT_STAGES] + (i-1) * width, width);
+    state.copyRange(internalOffsets[INT_STAGES], state, internalOffsets[INT_DATA], width);
+}
+
+
+std::string Node_PipelineRegister::getTypeName() const
+{
+    return "PipelineRegister";
+}
+
+void Node_PipelineRegister::assertValidity() const
+{
+
+}
+
+std::string Node_PipelineRegister::getInputName(size_t idx) const
+{
+    switch (idx) {
+        case DATA: return "data_in";
+        case ENABLE: return "enable";
+        default:
+            return "INVALID";
+    }
+}
+
+std::string Node_PipelineRegister::getOutputName(size_t idx) const
+{
+    return "data_out";
+}
+
+std::vector<size_t> Node_PipelineRegister::getInternalStateSizes() const
+{
+    std::vector<size_t> res(NUM_INTERNALS);
+    res[INT_DATA] = getOutputConnectionType(0).width;
+    res[INT_ENABLE] = 1;
+    res[INT_STAGES] = getOutputConnectionType(0).width * (m_numStages-1);
+    return res;
+}
+
+std::unique_ptr<BaseNode> Node_PipelineRegister::cloneUnconnected() const
+{
+    std::unique_ptr<BaseNode> res(new Node_PipelineRegister(m_numStages));
+    copyBaseToClone(res.get());
+    return res;
+}
+
+std::string Node_PipelineRegister::attemptInferOutputName(size_t outputPort) const
+{
+    auto driver0 = getDriver(0);
+    if (driver0.node == nullptr) return "";
+    if (driver0.node->getName().empty()) return "";
+
+    return driver0.node->getName() + "_pipelined";
+}
+
+}
@@ -15,14 +15,60 @@
     License along with this library; if not, write to the Free Software
     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 */
-#ifndef NODE_PIPELINEREGISTER_H
-#define NODE_PIPELINEREGISTER_H
+#pragma once
 
-/**
- * @todo write docs
- */
-class Node_PipelineRegister
-{
-};
+#include "../Node.h"
 
-#endif // NODE_PIPELINEREGISTER_H
+namespace gtry::hlim {
+
+    /**
+     * @brief Delays a signal by a fixed number of clock ticks like a chain of registers without reset.
+     * @details Marks the combinational logic driving it as a region into which the registers may be moved.
+     * The retimePipelineRegisters postprocessing pass distributes them through this logic by estimated logic depth
+     * and delays all parallel paths equally, so the node itself never reaches the export.
+     */
+    class Node_PipelineRegister : public Node<Node_PipelineRegister>
+    {
+    public:
+        enum Input {
+            DATA,
+            ENABLE,
+            NUM_INPUTS
+        };
+        enum Internal {
+            INT_DATA,
+            INT_ENABLE,
+            INT_STAGES,
+            NUM_INTERNALS
+        };
+
+        Node_PipelineRegister(size_t numStages);
+
+        void connectInput(Input input, const NodePort& port);
+        inline void disconnectInput(Input input) { NodeIO::disconnectInput(input); }
+
+        virtual void simulateReset(sim::SimulatorCallbacks& simCallbacks, sim::DefaultBitVectorState& state, const size_t* internalOffsets, const size_t* outputOffsets) const override;
+        virtual void simulateEvaluate(sim::SimulatorCallbacks& simCallbacks, sim::DefaultBitVectorState& state, const size_t* internalOffsets, const size_t* inputOffsets, const size_t* outputOffsets) const override;
+        virtual void simulateAdvance(sim::SimulatorCallbacks& simCallbacks, sim::DefaultBitVectorState& state, const size_t* internalOffsets, const size_t* outputOffsets, size_t clockPort) const override;
+
+        void setClock(Clock* clk);
+
+        bool hasSideEffects() const override { return hasRef(); }
+
+        inline size_t getNumStages() const { return m_numStages; }
+
+        virtual std::string getTypeName() const override;
+        virtual void assertValidity() const override;
+        virtual std::string getInputName(size_t idx) const override;
+        virtual std::string getOutputName(size_t idx) const override;
+
+        virtual std::vector<size_t> getInternalStateSizes() const override;
+
+        virtual std::unique_ptr<BaseNode> cloneUnconnected() const override;
+
+        virtual std::string attemptInferOutputName(size_t outputPort) const override;
+    protected:
+        size_t m_numStages;
+    };
+
+}
@@ -18,6 +18,10 @@
 #include "gatery/pch.h"
 #include "Node_Rewire.h"
 
+#include "../../utils/Range.h"
+
+#include <map>
+
 namespace gtry::hlim {
 
 bool Node_Rewire::RewireOperation::isBitExtract(size_t& bitIndex) const
@@ -149,6 +153,84 @@ void Node_Rewire::setPadTo(size_t width)
     setOp(std::move(op));
 }
 
+void Node_Rewire::fuseSubsequentOp(const RewireOperation &subsequentOp, const NodePort &additionalInput)
+{
+    const size_t additionalInputIdx = getNumInputPorts();
+
+    // Resolve all ranges of the subsequent op that refer to the output of this node into the ranges of this node.
+    std::vector<OutputRange> composed;
+    auto append = [&composed](OutputRange range) {
+        if (range.subwidth == 0) return;
+        if (!composed.empty()) {
+            auto &last = composed.back();
+            if (last.source == range.source) {
+                if (range.source != OutputRange::INPUT) {
+                    last.subwidth += range.subwidth;
+                    return;
+                }
+                if (last.inputIdx == range.inputIdx && last.inputOffset + last.subwidth == range.inputOffset) {
+                    last.subwidth += range.subwidth;
+                    return;
+                }
+            }
+        }
+        composed.push_back(range);
+    };
+
+    for (const auto &range : subsequentOp.ranges) {
+        if (range.source != OutputRange::INPUT) {
+            append(range);
+            continue;
+        }
+        if (range.inputIdx == 1) {
+            append({ .subwidth = range.subwidth, .source = OutputRange::INPUT, .inputIdx = additionalInputIdx, .inputOffset = range.inputOffset });
+            continue;
+        }
+        HCL_ASSERT(range.inputIdx == 0);
+
+        size_t begin = range.inputOffset;
+        size_t end = range.inputOffset + range.subwidth;
+        size_t offset = 0;
+        for (const auto &inner : m_rewireOperation.ranges) {
+            size_t innerEnd = offset + inner.subwidth;
+            if (innerEnd > begin && offset < end) {
+                size_t from = std::max(begin, offset);
+                size_t to = std::min(end, innerEnd);
+                OutputRange piece = inner;
+                piece.subwidth = to - from;
+                if (piece.source == OutputRange::INPUT)
+                    piece.inputOffset += from - offset;
+                append(piece);
+            }
+            offset = innerEnd;
+            if (offset >= end) break;
+        }
+        HCL_ASSERT(offset >= end);
+    }
+
+    // Compact the inputs, dropping unreferenced ones and merging duplicate drivers.
+    std::vector<NodePort> drivers;
+    std::map<NodePort, size_t> driver2idx;
+    for (auto &range : composed) {
+        if (range.source != OutputRange::INPUT) continue;
+        NodePort driver = range.inputIdx == additionalInputIdx ? additionalInput : getDriver(range.inputIdx);
+        auto [it, inserted] = driver2idx.try_emplace(driver, drivers.size());
+        if (inserted)
+            drivers.push_back(driver);
+        range.inputIdx = it->second;
+    }
+
+    for (auto i : utils::Range(getNumInputPorts()))
+        NodeIO::disconnectInput(i);
+    resizeInputs(drivers.size());
+    for (auto i : utils::Range(drivers.size()))
+        NodeIO::connectInput(i, drivers[i]);
+
+    RewireOperation op;
+    op.ranges = std::move(composed);
+    setOp(std::move(op));
+}
+
 void Node_Rewire::changeOutputType(ConnectionType outputType)
 {
     m_desiredConnectionType = outputType;
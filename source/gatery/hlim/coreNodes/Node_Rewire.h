@@ -71,6 +71,14 @@ class Node_Rewire : public Node<Node_Rewire>
         inline const RewireOperation &getOp() const { return m_rewireOperation; }
         bool isNoOp() const;
 
+        /**
+         * @brief Merges a subsequent two input rewire into this node.
+         * @details The subsequent operation reads the output of this node as input 0 and additionalInput as input 1.
+         * Afterwards, this node directly computes the result of the subsequent operation and inputs that are no longer
+         * referenced are dropped. Only valid if nothing else observes the previous output of this node.
+         */
+        void fuseSubsequentOp(const RewireOperation &subsequentOp, const NodePort &additionalInput);
+
         void changeOutputType(ConnectionType outputType);
 
         virtual std::unique_ptr<BaseNode> cloneUnconnected() const override;
@@ -26,6 +26,7 @@
 #include "../coreNodes/Node_Compare.h"
 #include "../coreNodes/Node_Logic.h"
 #include "../coreNodes/Node_Multiplexer.h"
+#include "../coreNodes/Node_Rewire.h"
 #include "../supportNodes/Node_Memory.h"
 #include "../supportNodes/Node_MemPort.h"
 #include "../GraphExploration.h"
@@ -43,6 +44,13 @@ MemoryGroup::MemoryGroup() : NodeGroup(GroupType::SFU)
     m_name = "memory";
 }
 
+void MemoryGroup::restore(Node_Memory *memory, std::vector<WritePort> writePorts, std::vector<ReadPort> readPorts)
+{
+    m_memory = memory;
+    m_writePorts = std::move(writePorts);
+    m_readPorts = std::move(readPorts);
+}
+
 void MemoryGroup::formAround(Node_Memory *memory, Circuit &circuit)
 {
     m_memory = memory;
@@ -168,6 +176,52 @@ void MemoryGroup::lazyCreateFixupNodeGroup()
 
 
 
+NodePort MemoryGroup::buildLaneMask(Circuit &circuit, NodePort lanes, size_t numLanes, size_t width)
+{
+    lazyCreateFixupNodeGroup();
+
+    bool replicateSingleBit = getOutputWidth(lanes) == 1;
+    HCL_ASSERT(replicateSingleBit || getOutputWidth(lanes) == numLanes);
+    HCL_ASSERT(width % numLanes == 0);
+
+    Node_Rewire::RewireOperation op;
+    for (auto lane : utils::Range(numLanes))
+        for ([[maybe_unused]] auto i : utils::Range(width / numLanes))
+            op.addInput(0, replicateSingleBit ? 0 : lane, 1);
+
+    auto *rewire = circuit.createNode<Node_Rewire>(1);
+    rewire->recordStackTrace();
+    rewire->moveToGroup(m_fixupNodeGroup);
+    rewire->connectInput(0, lanes);
+    rewire->changeOutputType({.interpretation = ConnectionType::BITVEC});
+    rewire->setOp(std::move(op));
+
+    NodePort mask = {.node = rewire, .port = 0ull};
+    circuit.appendSignal(mask)->setName("lane_mask");
+    return mask;
+}
+
+NodePort MemoryGroup::buildMaskedMerge(Circuit &circuit, NodePort oldData, NodePort newData, NodePort mask)
+{
+    lazyCreateFixupNodeGroup();
+
+    auto logic = [&](Node_Logic::Op op, std::initializer_list<NodePort> operands) {
+        auto *node = circuit.createNode<Node_Logic>(op);
+        node->recordStackTrace();
+        node->moveToGroup(m_fixupNodeGroup);
+        size_t i = 0;
+        for (auto np : operands)
+            node->connectInput(i++, np);
+        return NodePort{.node = node, .port = 0ull};
+    };
+
+    NodePort keptOld = logic(Node_Logic::AND, {oldData, logic(Node_Logic::NOT, {mask})});
+    NodePort takenNew = logic(Node_Logic::AND, {newData, mask});
+    NodePort merged = logic(Node_Logic::OR, {keptOld, takenNew});
+    circuit.appendSignal(merged)->setName("masked_merge");
+    return merged;
+}
+
 void MemoryGroup::convertPortDependencyToLogic(Circuit &circuit)
 {
     // If an async read happens after a write, it must
@@ -223,6 +277,13 @@ void MemoryGroup::convertPortDependencyToLogic(Circuit &circuit)
 
             NodePort wrData = wp.node->getDriver((unsigned)Node_MemPort::Inputs::wrData);
 
+            // With byte enables, only the written lanes get forwarded.
+            std::optional<NodePort> wrMask;
+            if (wp.node->hasByteEnable()) {
+                NodePort byteEnable = wp.node->getDriver((unsigned)Node_MemPort::Inputs::wrByteEnable);
+                wrMask = buildLaneMask(circuit, byteEnable, getOutputWidth(byteEnable), wp.node->getBitWidth());
+            }
+
             auto delayLike = [&](Node_Register *refReg, NodePort &np, const char *name, const char *comment) {
                 auto *reg = circuit.createNode<Node_Register>();
                 reg->recordStackTrace();
@@ -240,16 +301,23 @@ void MemoryGroup::convertPortDependencyToLogic(Circuit &circuit)
                 // read data gets delayed so we will have to delay the write data and conflict decision as well
                 delayLike(rp.syncReadDataReg, wrData, "delayedWrData", "The memory read gets delayed by a register so the write data bypass also needs to be delayed.");
                 delayLike(rp.syncReadDataReg, conflict, "delayedConflict", "The memory read gets delayed by a register so the collision detection decision also needs to be delayed.");
+                if (wrMask)
+                    delayLike(rp.syncReadDataReg, *wrMask, "delayedWrMask", "The memory read gets delayed by a register so the byte enable of the write data bypass also needs to be delayed.");
 
                 if (rp.outputReg != nullptr) {
                     // need to delay even more
                     delayLike(rp.syncReadDataReg, wrData, "delayed_2_WrData", "The memory read gets delayed by an additional register so the write data bypass also needs to be delayed.");
                     delayLike(rp.syncReadDataReg, conflict, "delayed_2_Conflict", "The memory read gets delayed by an additional register so the collision detection decision also needs to be delayed.");
+                    if (wrMask)
+                        delayLike(rp.syncReadDataReg, *wrMask, "delayed_2_WrMask", "The memory read gets delayed by an additional register so the byte enable of the write data bypass also needs to be delayed.");
                 }
             }
 
             std::vector<NodePort> consumers = rp.dataOutput.node->getDirectlyDriven(rp.dataOutput.port);
 
+            if (wrMask)
+                wrData = buildMaskedMerge(circuit, rp.dataOutput, wrData, *wrMask);
+
             // Finally the actual mux to arbitrate between the actual read and the forwarded write data.
             auto *muxNode = circuit.createNode<Node_Multiplexer>(2);
 
@@ -282,6 +350,60 @@ void MemoryGroup::convertPortDependencyToLogic(Circuit &circuit)
 
                 lazyCreateFixupNodeGroup();
 
+                if (wp2.node->hasByteEnable()) {
+                    // The latter write only overrides the lanes it enables, so instead of disabling the former write,
+                    // mask those lanes out of the byte enable of the former write.
+                    NodePort byteEnable2 = wp2.node->getDriver((unsigned)Node_MemPort::Inputs::wrByteEnable);
+                    size_t numLanes = getOutputWidth(byteEnable2);
+                    if (wp1.node->hasByteEnable())
+                        HCL_DESIGNCHECK_HINT(getOutputWidth(wp1.node->getDriver((unsigned)Node_MemPort::Inputs::wrByteEnable)) == numLanes, "Ordered write ports with byte enables must have the same number of lanes.");
+
+                    auto *addrCompNode = circuit.createNode<Node_Compare>(Node_Compare::EQ);
+                    addrCompNode->recordStackTrace();
+                    addrCompNode->moveToGroup(m_fixupNodeGroup);
+                    addrCompNode->setComment("The latter write overrides lanes of the former write if the write adresses match.");
+                    addrCompNode->connectInput(0, wp1.node->getDriver((unsigned)Node_MemPort::Inputs::address));
+                    addrCompNode->connectInput(1, wp2.node->getDriver((unsigned)Node_MemPort::Inputs::address));
+
+                    NodePort overrides = {.node = addrCompNode, .port = 0ull};
+                    circuit.appendSignal(overrides)->setName("addrMatch");
+
+                    HCL_ASSERT(wp2.node->getNonSignalDriver((unsigned)Node_MemPort::Inputs::enable) == wp2.node->getNonSignalDriver((unsigned)Node_MemPort::Inputs::wrEnable));
+                    if (wp2.node->getDriver((unsigned)Node_MemPort::Inputs::enable).node != nullptr) {
+                        auto *logicAnd = circuit.createNode<Node_Logic>(Node_Logic::AND);
+                        logicAnd->moveToGroup(m_fixupNodeGroup);
+                        logicAnd->recordStackTrace();
+                        logicAnd->connectInput(0, overrides);
+                        logicAnd->connectInput(1, wp2.node->getDriver((unsigned)Node_MemPort::Inputs::enable));
+                        overrides = {.node = logicAnd, .port = 0ull};
+                    }
+
+                    auto *overriddenLanes = circuit.createNode<Node_Logic>(Node_Logic::AND);
+                    overriddenLanes->moveToGroup(m_fixupNodeGroup);
+                    overriddenLanes->recordStackTrace();
+                    overriddenLanes->connectInput(0, buildLaneMask(circuit, overrides, numLanes, numLanes));
+                    overriddenLanes->connectInput(1, byteEnable2);
+
+                    auto *logicNot = circuit.createNode<Node_Logic>(Node_Logic::NOT);
+                    logicNot->moveToGroup(m_fixupNodeGroup);
+                    logicNot->recordStackTrace();
+                    logicNot->connectInput(0, {.node = overriddenLanes, .port = 0ull});
+                    NodePort newByteEnable1 = {.node = logicNot, .port = 0ull};
+
+                    if (wp1.node->hasByteEnable()) {
+                        auto *logicAnd = circuit.createNode<Node_Logic>(Node_Logic::AND);
+                        logicAnd->moveToGroup(m_fixupNodeGroup);
+                        logicAnd->recordStackTrace();
+                        logicAnd->connectInput(0, newByteEnable1);
+                        logicAnd->connectInput(1, wp1.node->getDriver((unsigned)Node_MemPort::Inputs::wrByteEnable));
+                        newByteEnable1 = {.node = logicAnd, .port = 0ull};
+                    }
+                    circuit.appendSignal(newByteEnable1)->setName("newWrByteEnable");
+
+                    wp1.node->rewireInput((unsigned)Node_MemPort::Inputs::wrByteEnable, newByteEnable1);
+                    continue;
+                }
+
 
                 auto *addrCompNode = circuit.createNode<Node_Compare>(Node_Compare::NEQ);
                 addrCompNode->recordStackTrace();
@@ -580,6 +702,8 @@ void MemoryGroup::attemptRegisterRetiming(Circuit &circuit)
             circuit.appendSignal(delayedWrDataNP)->setName("delayed_wr_data");
 
             insertDelayInput({.node=writePort, .port=(unsigned)Node_MemPort::Inputs::address}, false, m_fixupNodeGroup, "delayed_wr_addr", "");
+            if (writePort->hasByteEnable())
+                insertDelayInput({.node=writePort, .port=(unsigned)Node_MemPort::Inputs::wrByteEnable}, false, m_fixupNodeGroup, "delayed_wr_byte_enable", "");
 
             HCL_ASSERT(writePort->getNonSignalDriver((unsigned)Node_MemPort::Inputs::enable) == writePort->getNonSignalDriver((unsigned)Node_MemPort::Inputs::wrEnable));
             insertDelayInput({.node=writePort, .port=(unsigned)Node_MemPort::Inputs::enable}, true, m_fixupNodeGroup, "delayed_wr_enable", "");
@@ -619,6 +743,14 @@ void MemoryGroup::attemptRegisterRetiming(Circuit &circuit)
 
             appendRegister(conflict, true, m_fixupNodeGroup, "conflict_delayed", "");
 
+            NodePort forwardedData = delayedWrDataNP;
+            if (writePort->hasByteEnable()) {
+                NodePort byteEnable = writePort->getDriver((unsigned)Node_MemPort::Inputs::wrByteEnable);
+                NodePort mask = buildLaneMask(circuit, byteEnable, getOutputWidth(byteEnable), writePort->getBitWidth());
+                appendRegister(mask, false, m_fixupNodeGroup, "wr_mask_delayed", "");
+                forwardedData = buildMaskedMerge(circuit, rp.dataOutput, delayedWrDataNP, mask);
+            }
+
             // Finally the actual mux to arbitrate between the actual read and the forwarded write data.
             auto *muxNode = circuit.createNode<Node_Multiplexer>(2);
 
@@ -628,7 +760,7 @@ void MemoryGroup::attemptRegisterRetiming(Circuit &circuit)
             muxNode->setComment("If read and write addr match and read and write are enabled, forward write data to read output.");
             muxNode->connectSelector(conflict);
             muxNode->connectInput(0, rp.dataOutput);
-            muxNode->connectInput(1, delayedWrDataNP);
+            muxNode->connectInput(1, forwardedData);
 
             NodePort muxOut = {.node = muxNode, .port=0ull};
 
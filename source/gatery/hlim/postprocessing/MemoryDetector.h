@@ -51,9 +51,13 @@ class MemoryGroup : public NodeGroup
         void attemptRegisterRetiming(Circuit &circuit);
         void verify();
 
+        /// Restores the port bookkeeping of a memory group that was loaded from a serialized circuit.
+        void restore(Node_Memory *memory, std::vector<WritePort> writePorts, std::vector<ReadPort> readPorts);
+
         Node_Memory *getMemory() { return m_memory; }
-        const std::vector<WritePort> &getWritePorts() { return m_writePorts; }
-        const std::vector<ReadPort> &getReadPorts() { return m_readPorts; }
+        const Node_Memory *getMemory() const { return m_memory; }
+        const std::vector<WritePort> &getWritePorts() const { return m_writePorts; }
+        const std::vector<ReadPort> &getReadPorts() const { return m_readPorts; }
     protected:
         NodePtr<Node_Memory> m_memory;
         std::vector<WritePort> m_writePorts;
@@ -62,6 +66,11 @@ class MemoryGroup : public NodeGroup
         NodeGroup *m_fixupNodeGroup = nullptr;
 
         void lazyCreateFixupNodeGroup();
+
+        /// Replicates each bit of a byte enable (or a single bool) to form a bit mask of the given width.
+        NodePort buildLaneMask(Circuit &circuit, NodePort lanes, size_t numLanes, size_t width);
+        /// Selects the bits of newData where mask is set and the bits of oldData otherwise.
+        NodePort buildMaskedMerge(Circuit &circuit, NodePort oldData, NodePort newData, NodePort mask);
 };
 
 
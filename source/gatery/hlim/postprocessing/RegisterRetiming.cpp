@@ -0,0 +1,199 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#include "gatery/pch.h"
+#include "RegisterRetiming.h"
+
+#include "../Circuit.h"
+#include "../TimingAnalysis.h"
+#include "../coreNodes/Node_Arithmetic.h"
+#include "../coreNodes/Node_Compare.h"
+#include "../coreNodes/Node_Constant.h"
+#include "../coreNodes/Node_Logic.h"
+#include "../coreNodes/Node_Multiplexer.h"
+#include "../coreNodes/Node_PipelineRegister.h"
+#include "../coreNodes/Node_PriorityConditional.h"
+#include "../coreNodes/Node_Register.h"
+#include "../coreNodes/Node_Rewire.h"
+#include "../coreNodes/Node_Shift.h"
+#include "../coreNodes/Node_Signal.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace gtry::hlim {
+
+namespace {
+
+/// Nodes that registers may be moved through.
+bool isRetimable(BaseNode *node)
+{
+    return dynamic_cast<Node_Signal*>(node) ||
+        dynamic_cast<Node_Rewire*>(node) ||
+        dynamic_cast<Node_Constant*>(node) ||
+        dynamic_cast<Node_Logic*>(node) ||
+        dynamic_cast<Node_Arithmetic*>(node) ||
+        dynamic_cast<Node_Compare*>(node) ||
+        dynamic_cast<Node_Multiplexer*>(node) ||
+        dynamic_cast<Node_Shift*>(node) ||
+        dynamic_cast<Node_PriorityConditional*>(node);
+}
+
+struct DelayedEdge {
+    NodePort consumer;
+    NodePort driver;
+    size_t delay;
+};
+
+void retimePipelineRegister(Circuit &circuit, Node_PipelineRegister *pipelineRegister)
+{
+    const NodePort dataInput = {.node = pipelineRegister, .port = (size_t) Node_PipelineRegister::DATA};
+    const NodePort driver = pipelineRegister->getDriver(Node_PipelineRegister::DATA);
+    const NodePort enable = pipelineRegister->getDriver(Node_PipelineRegister::ENABLE);
+    Clock *clock = pipelineRegister->getClocks()[0];
+    const size_t numStages = pipelineRegister->getNumStages();
+
+    // Gather all nodes whose outputs exclusively feed into the pipeline register, directly or through other such nodes.
+    std::set<BaseNode*> region;
+    std::vector<BaseNode*> regionNodes;
+    {
+        auto onlyFeedsRegion = [&](BaseNode *node) {
+            for (auto i : utils::Range(node->getNumOutputPorts()))
+                for (auto consumer : node->getDirectlyDriven(i))
+                    if (consumer != dataInput && !region.contains(consumer.node))
+                        return false;
+            return true;
+        };
+
+        std::vector<BaseNode*> candidates;
+        if (driver.node != nullptr)
+            candidates.push_back(driver.node);
+        while (!candidates.empty()) {
+            auto *node = candidates.back();
+            candidates.pop_back();
+            if (region.contains(node) || !isRetimable(node) || !onlyFeedsRegion(node)) continue;
+
+            region.insert(node);
+            regionNodes.push_back(node);
+            for (auto i : utils::Range(node->getNumInputPorts()))
+                if (auto d = node->getDriver(i); d.node != nullptr)
+                    candidates.push_back(d.node);
+        }
+    }
+
+    // Accumulate the logic depth at the output of every region node in topological order.
+    std::map<BaseNode*, size_t> depth;
+    {
+        std::map<BaseNode*, size_t> numPendingInputs;
+        std::vector<BaseNode*> ready;
+        for (auto *node : regionNodes) {
+            size_t numPending = 0;
+            for (auto i : utils::Range(node->getNumInputPorts()))
+                if (region.contains(node->getDriver(i).node))
+                    numPending++;
+            numPendingInputs[node] = numPending;
+            if (numPending == 0)
+                ready.push_back(node);
+        }
+
+        while (!ready.empty()) {
+            auto *node = ready.back();
+            ready.pop_back();
+
+            size_t inputDepth = 0;
+            for (auto i : utils::Range(node->getNumInputPorts())) {
+                auto d = node->getDriver(i);
+                if (region.contains(d.node))
+                    inputDepth = std::max(inputDepth, depth[d.node]);
+            }
+            depth[node] = inputDepth + estimateLogicLevels(node);
+
+            for (auto i : utils::Range(node->getNumOutputPorts()))
+                for (auto consumer : node->getDirectlyDriven(i))
+                    if (region.contains(consumer.node) && --numPendingInputs[consumer.node] == 0)
+                        ready.push_back(consumer.node);
+        }
+        HCL_ASSERT_HINT(depth.size() == region.size(), "Combinational loop in the region of a pipeline register!");
+    }
+
+    // Nodes outside the region are in stage 0, the data input of the pipeline register marks the last stage.
+    // This includes the pipeline register itself if its output feeds back into the region, the loop then keeps all numStages registers.
+    const size_t totalDepth = region.contains(driver.node) ? depth[driver.node] : 0;
+    auto getStage = [&](BaseNode *node)->size_t {
+        if (!region.contains(node)) return 0;
+        return depth[node] * (numStages + 1) / (totalDepth + 1);
+    };
+
+    // Collect all edges that cross stages before rewiring anything, since rewiring changes the lists of driven nodes.
+    std::vector<DelayedEdge> delayedEdges;
+    auto collectEdge = [&](const NodePort &consumer) {
+        auto d = consumer.node->getDriver(consumer.port);
+        if (d.node == nullptr) return;
+        // Constants need no delay.
+        if (dynamic_cast<Node_Constant*>(consumer.node->getNonSignalDriver(consumer.port).node)) return;
+
+        size_t consumerStage = consumer == dataInput ? numStages : getStage(consumer.node);
+        size_t driverStage = getStage(d.node);
+        if (consumerStage > driverStage)
+            delayedEdges.push_back({.consumer = consumer, .driver = d, .delay = consumerStage - driverStage});
+    };
+    for (auto *node : regionNodes)
+        for (auto i : utils::Range(node->getNumInputPorts()))
+            collectEdge({.node = node, .port = i});
+    collectEdge(dataInput);
+
+    // Build one chain of registers per driver and let each consumer tap it at the required delay.
+    std::map<NodePort, std::vector<NodePort>> delayChains;
+    for (const auto &edge : delayedEdges) {
+        auto &chain = delayChains[edge.driver];
+        if (chain.empty())
+            chain.push_back(edge.driver);
+
+        while (chain.size() <= edge.delay) {
+            auto *reg = circuit.createNode<Node_Register>();
+            reg->recordStackTrace();
+            reg->moveToGroup(edge.consumer.node->getGroup());
+            reg->setComment("Register distributed into combinational logic by pipeline register retiming.");
+            reg->setClock(clock);
+            reg->connectInput(Node_Register::DATA, chain.back());
+            reg->connectInput(Node_Register::ENABLE, enable);
+
+            NodePort delayed = {.node = reg, .port = 0ull};
+            circuit.appendSignal(delayed);
+            chain.push_back(delayed);
+        }
+        edge.consumer.node->rewireInput(edge.consumer.port, chain[edge.delay]);
+    }
+
+    pipelineRegister->bypassOutputToInput(0, Node_PipelineRegister::DATA);
+}
+
+}
+
+void retimePipelineRegisters(Circuit &circuit)
+{
+    std::vector<Node_PipelineRegister*> pipelineRegisters;
+    for (auto &node : circuit.getNodes())
+        if (auto *pipelineRegister = dynamic_cast<Node_PipelineRegister*>(node.get()))
+            pipelineRegisters.push_back(pipelineRegister);
+
+    for (auto *pipelineRegister : pipelineRegisters)
+        retimePipelineRegister(circuit, pipelineRegister);
+}
+
+}
@@ -0,0 +1,33 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#pragma once
+
+namespace gtry::hlim {
+
+class Circuit;
+
+/**
+ * @brief Replaces all pipeline registers by regular registers that are distributed through the combinational logic driving them.
+ * @details The movable region of a pipeline register is the combinational logic that exclusively feeds into it.
+ * Each node of this region is assigned a stage by its estimated logic depth, such that the stages split the region
+ * into slices of roughly equal depth. Registers are then inserted on every edge that crosses from one stage into a later one,
+ * including the edges entering the region, so that every path through the region is delayed by the same number of ticks.
+ */
+void retimePipelineRegisters(Circuit &circuit);
+
+}
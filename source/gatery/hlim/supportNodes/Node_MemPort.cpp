@@ -74,6 +74,13 @@ void Node_MemPort::connectWrData(const NodePort &output)
     connectInput((unsigned)Inputs::wrData, output);
 }
 
+void Node_MemPort::connectWrByteEnable(const NodePort &output)
+{
+    HCL_ASSERT_HINT(!isReadPort(), "For now I don't want to mix read and write ports");
+    HCL_ASSERT_HINT(m_bitWidth % getOutputWidth(output) == 0, "The word width of a memory port must be a multiple of the number of byte enable bits.");
+    connectInput((unsigned)Inputs::wrByteEnable, output);
+}
+
 void Node_MemPort::orderAfter(Node_MemPort *writePort)
 {
     connectInput((unsigned)Inputs::orderAfter, {.node=writePort, .port=(unsigned)Node_MemPort::Outputs::orderBefore});
@@ -130,6 +137,8 @@ void Node_MemPort::simulateReset(sim::SimulatorCallbacks &simCallbacks, sim::Def
         state.clearRange(sim::DefaultConfig::DEFINED, internalOffsets[(unsigned)Internal::address], getDriverConnType((unsigned)Inputs::address).width);
         state.clearRange(sim::DefaultConfig::DEFINED,internalOffsets[(unsigned)Internal::wrData], getBitWidth());
         state.clear(sim::DefaultConfig::VALUE, internalOffsets[(unsigned)Internal::wrEnable]);
+        if (hasByteEnable())
+            state.clearRange(sim::DefaultConfig::DEFINED, internalOffsets[(unsigned)Internal::wrByteEnable], getDriverConnType((unsigned)Inputs::wrByteEnable).width);
     }
 }
 
@@ -186,6 +195,9 @@ void Node_MemPort::simulateEvaluate(sim::SimulatorCallbacks &simCallbacks, sim::
                         !state.get(sim::DefaultConfig::DEFINED, inputOffsets[(unsigned)Inputs::wrEnable]);
         }
         state.set(sim::DefaultConfig::VALUE, internalOffsets[(unsigned)Internal::wrEnable], doWrite);
+
+        if (hasByteEnable())
+            state.copyRange(internalOffsets[(unsigned)Internal::wrByteEnable], state, inputOffsets[(unsigned)Inputs::wrByteEnable], getDriverConnType((unsigned)Inputs::wrByteEnable).width);
     }
 }
 
@@ -207,7 +219,20 @@ void Node_MemPort::simulateAdvance(sim::SimulatorCallbacks &simCallbacks, sim::D
                 auto memSize = getMemory()->getSize();
                 HCL_ASSERT(memSize % getBitWidth() == 0);
                 auto index = (addressValue * getBitWidth()) % memSize;
-                state.copyRange(internalOffsets[(unsigned)RefInternal::memory] + index, state, internalOffsets[(unsigned)Internal::wrData], getBitWidth());
+                if (!hasByteEnable()) {
+                    state.copyRange(internalOffsets[(unsigned)RefInternal::memory] + index, state, internalOffsets[(unsigned)Internal::wrData], getBitWidth());
+                } else {
+                    // Only write the enabled lanes, lanes with undefined enables become undefined
+                    size_t numLanes = getDriverConnType((unsigned)Inputs::wrByteEnable).width;
+                    size_t laneWidth = getBitWidth() / numLanes;
+                    for (auto lane : utils::Range(numLanes)) {
+                        size_t laneOffset = internalOffsets[(unsigned)RefInternal::memory] + index + lane * laneWidth;
+                        if (!state.get(sim::DefaultConfig::DEFINED, internalOffsets[(unsigned)Internal::wrByteEnable] + lane))
+                            state.clearRange(sim::DefaultConfig::DEFINED, laneOffset, laneWidth);
+                        else if (state.get(sim::DefaultConfig::VALUE, internalOffsets[(unsigned)Internal::wrByteEnable] + lane))
+                            state.copyRange(laneOffset, state, internalOffsets[(unsigned)Internal::wrData] + lane * laneWidth, laneWidth);
+                    }
+                }
             }
         }
     }
@@ -240,6 +265,8 @@ std::string Node_MemPort::getInputName(size_t idx) const
             return "wrData";
         case (unsigned)Inputs::orderAfter:
             return "orderAfter";
+        case (unsigned)Inputs::wrByteEnable:
+            return "wrByteEnable";
         default:
             return "unknown";
     }
@@ -270,6 +297,9 @@ std::vector<size_t> Node_MemPort::getInternalStateSizes() const
 
         if (auto driver = getDriver((unsigned)Inputs::address); driver.node != nullptr)
             sizes[(unsigned)Internal::address] = driver.node->getOutputConnectionType(driver.port).width;
+
+        if (auto driver = getDriver((unsigned)Inputs::wrByteEnable); driver.node != nullptr)
+            sizes[(unsigned)Internal::wrByteEnable] = driver.node->getOutputConnectionType(driver.port).width;
     }
 
     return sizes;
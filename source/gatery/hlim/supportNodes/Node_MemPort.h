@@ -33,6 +33,7 @@ class Node_MemPort : public Node<Node_MemPort>
             address,
             wrData,
             orderAfter,
+            wrByteEnable,
             count
         };
 
@@ -46,6 +47,7 @@ class Node_MemPort : public Node<Node_MemPort>
             wrData,
             address,
             wrEnable,
+            wrByteEnable,
             count
         };
         enum class RefInternal {
@@ -63,6 +65,8 @@ class Node_MemPort : public Node<Node_MemPort>
         void connectWrEnable(const NodePort &output);
         void connectAddress(const NodePort &output);
         void connectWrData(const NodePort &output);
+        /// Restricts writes to the lanes whose bit is set, the word is split into as many equally sized lanes as the byte enable has bits.
+        void connectWrByteEnable(const NodePort &output);
         void orderAfter(Node_MemPort *port);
         bool isOrderedAfter(Node_MemPort *port) const;
         bool isOrderedBefore(Node_MemPort *port) const;
@@ -71,6 +75,7 @@ class Node_MemPort : public Node<Node_MemPort>
 
         bool isReadPort() const;
         bool isWritePort() const;
+        bool hasByteEnable() const { return getDriver((unsigned)Inputs::wrByteEnable).node != nullptr; }
 
         virtual bool hasSideEffects() const override;
 
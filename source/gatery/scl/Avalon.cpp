@@ -18,6 +18,8 @@
 #include "gatery/pch.h"
 #include "Avalon.h"
 
+#include <span>
+
 namespace gtry::scl
 {
 	AvalonNetworkSection::AvalonNetworkSection(std::string name) :
@@ -94,6 +96,14 @@ namespace gtry::scl
 			slave.writeData = mm.writeData;
 		}
 
+		if (slave.burstCount)
+		{
+			if (!mm.burstCount)
+				mm.burstCount = slave.burstCount->getWidth();
+			HCL_DESIGNCHECK_HINT(slave.burstCount->size() <= mm.burstCount->size(), "attach the slave with the widest burst count first");
+			slave.burstCount = (*mm.burstCount)(0, slave.burstCount->getWidth());
+		}
+
 		// read path
 		if (slave.readData)
 		{
@@ -102,10 +112,13 @@ namespace gtry::scl
 				mm.read = Bit{};
 				mm.readData = *slave.readData;
 				mm.readLatency = slave.readLatency;
+				if (slave.readDataValid)
+					mm.readDataValid = *slave.readDataValid;
+				mm.maximumPendingReadTransactions = slave.maximumPendingReadTransactions;
 			}
 			else
 			{
-				if (mm.readDataValid.has_value() != slave.readDataValid.has_value())
+				if (mm.readDataValid.has_value() || slave.readDataValid.has_value())
 				{
 					mm.createReadDataValid();
 					slave.createReadDataValid();
@@ -113,6 +126,8 @@ namespace gtry::scl
 					*mm.readDataValid |= *slave.readDataValid;
 					IF(*slave.readDataValid)
 						*mm.readData = *slave.readData;
+
+					mm.maximumPendingReadTransactions = std::max(mm.maximumPendingReadTransactions, slave.maximumPendingReadTransactions);
 				}
 				else
 				{
@@ -135,13 +150,86 @@ namespace gtry::scl
 		}
 	}
 
-	AvalonMM AvalonNetworkSection::demux()
+	/// Decouples a branch of the demux tree by registering its command and response signals.
+	static void registerBranch(AvalonMM& stage, AvalonMM& branch)
+	{
+		stage.address = branch.address.getWidth();
+		branch.address = reg(stage.address);
+
+		if (branch.write)
+		{
+			stage.write = Bit{};
+			*branch.write = reg(*stage.write, '0');
+		}
+
+		if (branch.writeData)
+		{
+			stage.writeData = branch.writeData->getWidth();
+			*branch.writeData = reg(*stage.writeData);
+		}
+
+		if (branch.read)
+		{
+			stage.read = Bit{};
+			*branch.read = reg(*stage.read, '0');
+		}
+
+		if (branch.readData)
+		{
+			stage.readData = reg(*branch.readData);
+			stage.readLatency = branch.readLatency + 2;
+			stage.maximumPendingReadTransactions = branch.maximumPendingReadTransactions + 2;
+		}
+
+		if (branch.readDataValid)
+			stage.readDataValid = reg(*branch.readDataValid, '0');
+	}
+
+	/// Attaches the slaves whose port index is selected by selectWidth address bits above subAddressWidth.
+	/// Above the fanout, the slaves are split into branches that decode the lower index bits.
+	static void attachTree(AvalonMM& mm, std::span<AvalonMM*> slaves, size_t subAddressWidth, size_t selectWidth, size_t fanoutWidth, bool registered, std::list<AvalonMM>& branches)
 	{
+		if (fanoutWidth == 0 || selectWidth <= fanoutWidth)
+		{
+			for (size_t p = 0; p < slaves.size(); ++p)
+			{
+				Bit slaveSelect = mm.address(subAddressWidth, selectWidth) == p;
+				attachSlave(mm, *slaves[p], slaveSelect);
+			}
+			return;
+		}
+
+		const size_t branchWidth = selectWidth - fanoutWidth;
+		const size_t branchSize = 1ull << branchWidth;
+		for (size_t b = 0; b * branchSize < slaves.size(); ++b)
+		{
+			AvalonMM& branch = branches.emplace_back();
+			branch.address = mm.address.getWidth();
+			attachTree(branch, slaves.subspan(b * branchSize, std::min(branchSize, slaves.size() - b * branchSize)),
+				subAddressWidth, branchWidth, fanoutWidth, registered, branches);
+
+			AvalonMM* attached = &branch;
+			if (registered)
+			{
+				attached = &branches.emplace_back();
+				registerBranch(*attached, branch);
+			}
+
+			Bit branchSelect = mm.address(subAddressWidth + branchWidth, selectWidth - branchWidth) == b;
+			HCL_NAMED(branchSelect);
+			attachSlave(mm, *attached, branchSelect);
+		}
+	}
+
+	AvalonMM AvalonNetworkSection::demux(size_t fanout, bool registered)
+	{
+		HCL_DESIGNCHECK_HINT(fanout == 0 || (fanout >= 2 && utils::nextPow2(fanout) == fanout), "demux fanout must be zero or a power of two");
+
 		GroupScope entity(GroupScope::GroupType::ENTITY);
 		entity.setName("AvalonMMDemux");
 
 		for (AvalonNetworkSection& sub : m_subSections)
-			m_port.emplace_back(std::make_pair(sub.m_name, sub.demux()));
+			m_port.emplace_back(std::make_pair(sub.m_name, sub.demux(fanout, registered)));
 
 		size_t subAddressWidth = 0;
 		for (const auto& port : m_port)
@@ -151,12 +239,12 @@ namespace gtry::scl
 		AvalonMM ret;
 		ret.address = BitWidth{ portAddrWidth + subAddressWidth };
 
-		for (size_t p = 0; p < m_port.size(); ++p)
-		{
-			AvalonMM& mm = m_port[p].second;
-			Bit slaveSelect = ret.address(subAddressWidth, portAddrWidth) == p;
-			attachSlave(ret, mm, slaveSelect);
-		}
+		std::vector<AvalonMM*> slaves;
+		for (auto& port : m_port)
+			slaves.push_back(&port.second);
+
+		std::list<AvalonMM> branches;
+		attachTree(ret, slaves, subAddressWidth, portAddrWidth, fanout > 0 ? utils::Log2C(fanout) : 0, registered, branches);
 		return ret;
 	}
 	
@@ -169,6 +257,7 @@ namespace gtry::scl
 		if (read) *read = gtry::pinIn().setName(pinName + "read");
 		if (write) *write = gtry::pinIn().setName(pinName + "write");
 		if (writeData) *writeData = gtry::pinIn(writeData->getWidth()).setName(pinName + "writedata");
+		if (burstCount) *burstCount = gtry::pinIn(burstCount->getWidth()).setName(pinName + "burstcount");
 
 		// output pins
 		if (ready) gtry::pinOut(*ready).setName(pinName + "waitrequest_n");
@@ -186,6 +275,7 @@ namespace gtry::scl
 		if (write) gtry::pinOut(*write).setName(pinName + "write");
 		if (writeData) gtry::pinOut(*writeData).setName(pinName + "writedata");
 		if (byteEnable) gtry::pinOut(*byteEnable).setName(pinName + "byteenable");
+		if (burstCount) gtry::pinOut(*burstCount).setName(pinName + "burstcount");
 
 		// input pins
 		if (ready) *ready = gtry::pinIn().setName(pinName + "waitrequest_n");
@@ -202,6 +292,7 @@ namespace gtry::scl
 		if (write) (*write).setName(name + "write");
 		if (writeData) (*writeData).setName(name + "writedata");
 		if (byteEnable) (*byteEnable).setName(name + "byteenable");
+		if (burstCount) (*burstCount).setName(name + "burstcount");
 
 		// input pins
 		if (ready) (*ready).setName(name + "waitrequest_n");
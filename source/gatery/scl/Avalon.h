@@ -45,6 +45,8 @@ namespace gtry::scl
         std::optional<BVec> response;
         std::optional<Bit> writeResponseValid;
         std::optional<BVec> byteEnable;
+        /// Number of words of a burst, sampled with the first beat. The maximum burst count is 2^(width-1).
+        std::optional<BVec> burstCount;
 
         size_t readLatency = 0;
         size_t readyLatency = 0;
@@ -88,7 +90,15 @@ namespace gtry::scl
         AvalonMM& find(std::string_view path);
 
         void assignPins();
-        AvalonMM demux();
+        /**
+         * @brief Builds the interconnect of all ports and subsections with the address map port index | port address.
+         * @details With a fanout of zero, all ports of a section are decoded and merged in a single level.
+         * Otherwise the ports are decoded by a tree of nodes that each select between up to fanout branches, fanout must be a power of two.
+         * Fixed read latencies are balanced per branch, so the padding registers are shared by all ports of a branch.
+         * If registered is set, every branch below the root gets a register stage on its command and response paths, adding two cycles of read latency.
+         * The address map is the same for all settings.
+         */
+        AvalonMM demux(size_t fanout = 0, bool registered = false);
 
     protected:
         std::string m_name;
@@ -193,4 +203,4 @@ namespace gtry::scl
     }
 }
 
-BOOST_HANA_ADAPT_STRUCT(gtry::scl::AvalonMM, address, ready, read, write, writeData, readData, readDataValid, readLatency, readyLatency, addressSel, dataSel);
+BOOST_HANA_ADAPT_STRUCT(gtry::scl::AvalonMM, address, ready, read, write, writeData, readData, readDataValid, burstCount, readLatency, readyLatency, addressSel, dataSel);
@@ -20,13 +20,23 @@
 
 namespace gtry::scl
 {
+	/// Latency from pushing an element until it is visible at the pop side.
+	enum class FifoLatency
+	{
+		/// Pop data and flags are registered, a pushed element is visible one cycle later.
+		registered,
+		/// Like registered, but an element pushed into an empty fifo is forwarded to the pop side in the same cycle.
+		/// Empty and the pop data then combinationally depend on the push valid and data.
+		bypass
+	};
+
 	template<typename TData>
 	class Fifo
 	{
 	public:
 		Fifo() : m_area("fifo") { }
-		Fifo(size_t depth, TData ref) : Fifo() { setup(depth, std::move(ref)); }
-		void setup(size_t depth, TData ref);
+		Fifo(size_t depth, TData ref, FifoLatency latency = FifoLatency::registered) : Fifo() { setup(depth, std::move(ref), latency); }
+		void setup(size_t depth, TData ref, FifoLatency latency = FifoLatency::registered);
 
 		// NOTE: always push before pop for correct conflict resulution
 		// TODO: fix above note by adding explicit write before read conflict resulution to bram
@@ -49,6 +59,10 @@ namespace gtry::scl
 
 		Bit m_full;
 		Bit m_empty;
+		Bit m_emptyReg;
+
+		FifoLatency m_latency = FifoLatency::registered;
+		std::optional<TData> m_pushData;
 
 		bool m_hasMem = false;
 		bool m_hasPush = false;
@@ -56,11 +70,12 @@ namespace gtry::scl
 	};
 
 	template<typename TData>
-	inline void Fifo<TData>::setup(size_t depth, TData ref)
+	inline void Fifo<TData>::setup(size_t depth, TData ref, FifoLatency latency)
 	{
 		auto scope = m_area.enter();
 		HCL_DESIGNCHECK_HINT(!m_hasMem, "fifo already initialized");
 		m_hasMem = true;
+		m_latency = latency;
 		m_mem.setup(depth, std::move(ref));
 
 		const BitWidth ctrWidth = m_mem.addressWidth() + 1;
@@ -73,12 +88,16 @@ namespace gtry::scl
 		HCL_NAMED(eq);
 
 		m_full = eq & (m_put.msb() != m_get.msb());
-		m_empty = eq & (m_put.msb() == m_get.msb());
+		m_emptyReg = eq & (m_put.msb() == m_get.msb());
 
 		m_full = reg(m_full, '0');
-		m_empty = reg(m_empty, '1');
+		m_emptyReg = reg(m_emptyReg, '1');
 		HCL_NAMED(m_full);
-		HCL_NAMED(m_empty);
+		HCL_NAMED(m_emptyReg);
+
+		// In bypass mode, m_empty is driven once the push port exists
+		if (m_latency == FifoLatency::registered)
+			m_empty = m_emptyReg;
 	}
 
 	template<typename TData>
@@ -103,6 +122,13 @@ namespace gtry::scl
 
 		m_put = put;
 		HCL_NAMED(m_put);
+
+		if (m_latency == FifoLatency::bypass)
+		{
+			m_pushData = data;
+			m_empty = m_emptyReg & !valid;
+			HCL_NAMED(m_empty);
+		}
 	}
 
 	template<typename TData>
@@ -111,6 +137,7 @@ namespace gtry::scl
 		auto scope = m_area.enter();
 		HCL_DESIGNCHECK_HINT(m_hasMem, "fifo not initialized");
 		HCL_DESIGNCHECK_HINT(!m_hasPop, "fifo pop port already constructed");
+		HCL_DESIGNCHECK_HINT(m_latency != FifoLatency::bypass || m_hasPush, "a bypass fifo needs the push port constructed before the pop port");
 		m_hasPop = true;
 
 		sim_assert(!ready | !m_empty) << "pop from empty fifo";
@@ -124,6 +151,11 @@ namespace gtry::scl
 
 		data = reg(m_mem[get(0, -1)]);
 
+		// An element pushed into the empty fifo is written and popped in the same cycle, so both pointers still advance together.
+		if (m_latency == FifoLatency::bypass)
+			IF(m_emptyReg)
+				data = *m_pushData;
+
 		m_get = get;
 		HCL_NAMED(m_get);
 	}
@@ -143,4 +175,207 @@ namespace gtry::scl
 		HCL_DESIGNCHECK_HINT(m_hasMem, "fifo not initialized");
 		return reg(m_size >= level, '0'); 
 	}
+
+	/**
+	 * @brief Fifo with separate push and pop clocks for crossing clock domains at full bandwidth.
+	 * @details The put and get pointers are exchanged between the domains as gray codes through two stage synchronizers,
+	 * so at most one bit changes per clock and a sampled pointer is always either the old or the new value.
+	 * Both flags are conservative: full and almostFull are computed in the push domain, empty and almostEmpty in the pop domain,
+	 * each against a pointer of the other domain that lags a few clock cycles behind.
+	 * The depth must be a power of two for the gray code to wrap around correctly.
+	 */
+	template<typename TData>
+	class DualClockFifo
+	{
+	public:
+		DualClockFifo() : m_area("dual_clock_fifo") { }
+		DualClockFifo(size_t depth, TData ref, Clock& pushClock, Clock& popClock) : DualClockFifo() { setup(depth, std::move(ref), pushClock, popClock); }
+		void setup(size_t depth, TData ref, Clock& pushClock, Clock& popClock);
+
+		void push(const TData& data, const Bit& valid);
+		void pop(TData& data, const Bit& ready);
+
+		/// Registered in the pop clock domain.
+		const Bit& empty() const { return m_empty; }
+		/// Registered in the push clock domain.
+		const Bit& full() const { return m_full; }
+
+		/// Registered in the pop clock domain.
+		Bit almostEmpty(const BVec& level) const;
+		/// Registered in the push clock domain.
+		Bit almostFull(const BVec& level) const;
+
+	private:
+		static BVec grayEncode(const BVec& binary);
+		static BVec grayDecode(const BVec& gray);
+		static BVec synchronize(const BVec& signal);
+
+		Area m_area;
+
+		Clock* m_pushClock = nullptr;
+		Clock* m_popClock = nullptr;
+
+		Memory<TData>	m_mem;
+		BVec m_put;
+		BVec m_get;
+		BVec m_putGray;
+		BVec m_getGray;
+		BVec m_pushSize;
+		BVec m_popSize;
+
+		Bit m_full;
+		Bit m_empty;
+
+		bool m_hasMem = false;
+		bool m_hasPush = false;
+		bool m_hasPop = false;
+	};
+
+	template<typename TData>
+	inline void DualClockFifo<TData>::setup(size_t depth, TData ref, Clock& pushClock, Clock& popClock)
+	{
+		auto scope = m_area.enter();
+		HCL_DESIGNCHECK_HINT(!m_hasMem, "fifo already initialized");
+		HCL_DESIGNCHECK_HINT(depth >= 2 && utils::nextPow2(depth) == depth, "dual clock fifo depth must be a power of two");
+		m_hasMem = true;
+		m_pushClock = &pushClock;
+		m_popClock = &popClock;
+
+		m_mem.setup(depth, std::move(ref));
+		// Reads only ever target words that were written several pop clock cycles ago
+		m_mem.noConflicts();
+
+		const BitWidth ctrWidth = m_mem.addressWidth() + 1;
+		m_put = ctrWidth;
+		m_get = ctrWidth;
+		m_getGray = ctrWidth;
+
+		{
+			ClockScope clkScp(*m_pushClock);
+
+			m_putGray = reg(grayEncode(m_put), 0);
+			HCL_NAMED(m_putGray);
+
+			BVec getSync = grayDecode(synchronize(m_getGray));
+			HCL_NAMED(getSync);
+
+			m_pushSize = m_put - getSync;
+			HCL_NAMED(m_pushSize);
+
+			Bit eq = m_put(0, -1) == getSync(0, -1);
+			m_full = reg(eq & (m_put.msb() != getSync.msb()), '0');
+			HCL_NAMED(m_full);
+		}
+		{
+			ClockScope clkScp(*m_popClock);
+
+			m_getGray = reg(grayEncode(m_get), 0);
+			HCL_NAMED(m_getGray);
+
+			BVec putSync = grayDecode(synchronize(m_putGray));
+			HCL_NAMED(putSync);
+
+			m_popSize = putSync - m_get;
+			HCL_NAMED(m_popSize);
+
+			m_empty = reg(m_get == putSync, '1');
+			HCL_NAMED(m_empty);
+		}
+	}
+
+	template<typename TData>
+	inline void DualClockFifo<TData>::push(const TData& data, const Bit& valid)
+	{
+		auto scope = m_area.enter();
+		HCL_DESIGNCHECK_HINT(m_hasMem, "fifo not initialized");
+		HCL_DESIGNCHECK_HINT(!m_hasPush, "fifo push port already constructed");
+		m_hasPush = true;
+
+		ClockScope clkScp(*m_pushClock);
+
+		sim_assert(!valid | !m_full) << "push into full fifo";
+
+		BVec put = m_put.getWidth();
+		put = reg(put, 0);
+		HCL_NAMED(put);
+
+		IF(valid)
+		{
+			m_mem[put(0, -1)] = data;
+			put += 1;
+		}
+
+		m_put = put;
+		HCL_NAMED(m_put);
+	}
+
+	template<typename TData>
+	inline void DualClockFifo<TData>::pop(TData& data, const Bit& ready)
+	{
+		auto scope = m_area.enter();
+		HCL_DESIGNCHECK_HINT(m_hasMem, "fifo not initialized");
+		HCL_DESIGNCHECK_HINT(!m_hasPop, "fifo pop port already constructed");
+		m_hasPop = true;
+
+		ClockScope clkScp(*m_popClock);
+
+		sim_assert(!ready | !m_empty) << "pop from empty fifo";
+
+		BVec get = m_get.getWidth();
+		get = reg(get, 0);
+		HCL_NAMED(get);
+
+		IF(ready)
+			get += 1;
+
+		data = reg(m_mem[get(0, -1)]);
+
+		m_get = get;
+		HCL_NAMED(m_get);
+	}
+
+	template<typename TData>
+	inline Bit DualClockFifo<TData>::almostEmpty(const BVec& level) const
+	{
+		auto scope = m_area.enter();
+		HCL_DESIGNCHECK_HINT(m_hasMem, "fifo not initialized");
+		ClockScope clkScp(*m_popClock);
+		return reg(m_popSize < level, '1');
+	}
+
+	template<typename TData>
+	inline Bit DualClockFifo<TData>::almostFull(const BVec& level) const
+	{
+		auto scope = m_area.enter();
+		HCL_DESIGNCHECK_HINT(m_hasMem, "fifo not initialized");
+		ClockScope clkScp(*m_pushClock);
+		return reg(m_pushSize >= level, '0');
+	}
+
+	template<typename TData>
+	inline BVec DualClockFifo<TData>::grayEncode(const BVec& binary)
+	{
+		return binary ^ (binary >> 1);
+	}
+
+	template<typename TData>
+	inline BVec DualClockFifo<TData>::grayDecode(const BVec& gray)
+	{
+		BVec binary = gray;
+		for (size_t i = gray.size() - 1; i > 0; --i)
+			binary[i - 1] = binary[i] ^ gray[i - 1];
+		return binary;
+	}
+
+	template<typename TData>
+	inline BVec DualClockFifo<TData>::synchronize(const BVec& signal)
+	{
+		SignalAttributes attributes;
+		attributes.crossingClockDomain = true;
+
+		BVec meta = reg(signal, 0);
+		setAttrib(meta, attributes);
+		HCL_NAMED(meta);
+		return reg(meta, 0);
+	}
 }
@@ -20,6 +20,11 @@
 
 #include "Stream.h"
 #include "Fifo.h"
+#include "StreamPipeline.h"
+#include "utils/OneHot.h"
+
+#include <span>
+#include <vector>
 
 namespace gtry::scl
 {
@@ -70,4 +75,172 @@ namespace gtry::scl
 		}
 		selectionState = reg(selectionState, '0');
 	}
+
+	namespace internal
+	{
+		template<typename StreamT>
+		StreamT arbitrateWeightedRoundRobin(std::span<StreamT> in, std::span<const size_t> weights, bool lockPackets)
+		{
+			HCL_DESIGNCHECK_HINT(!in.empty(), "nothing to arbitrate");
+			HCL_DESIGNCHECK_HINT(weights.size() == in.size(), "every input needs a weight");
+			HCL_DESIGNCHECK_HINT(!lockPackets || in.front().eop, "locking across packets requires an eop signal");
+
+			if (in.size() == 1)
+			{
+				StreamT out = in.front();
+				out.ready = Bit{};
+				in.front().ready = *out.ready;
+				return out;
+			}
+
+			auto entity = Area{ "arbitrateWeightedRoundRobin" }.enter();
+
+			const BitWidth idxWidth = BitWidth::count(in.size());
+			const size_t maxWeight = *std::max_element(weights.begin(), weights.end());
+			HCL_DESIGNCHECK_HINT(*std::min_element(weights.begin(), weights.end()) > 0, "weights must be at least one");
+
+			// input that received the last grant and the number of beats (packets with lockPackets) it was granted in a row
+			BVec current = idxWidth;
+			BVec used = BitWidth::count(maxWeight + 1);
+			Bit locked;
+
+			BVec currentWeight = ConstBVec(BitWidth::count(maxWeight + 1));
+			for (size_t i = 0; i < in.size(); ++i)
+				IF(current == i)
+					currentWeight = weights[i];
+			HCL_NAMED(currentWeight);
+
+			// search for the next request starting at current as long as it has beats left, otherwise after it
+			BVec start = current;
+			IF(used == currentWeight)
+			{
+				IF(current == in.size() - 1)
+					start = 0;
+				ELSE
+					start = current + 1;
+			}
+			HCL_NAMED(start);
+
+			BVec requests = ConstBVec(BitWidth{ in.size() });
+			BVec startMask = ConstBVec(BitWidth{ in.size() });
+			for (size_t i = 0; i < in.size(); ++i)
+			{
+				requests[i] = *in[i].valid;
+				startMask[i] = start <= i;
+			}
+			HCL_NAMED(requests);
+
+			EncoderResult afterStart = priorityEncoder(requests & startMask);
+			EncoderResult wrapped = priorityEncoder(requests);
+
+			BVec grant = wrapped.index;
+			IF(afterStart.valid)
+				grant = afterStart.index;
+			if (lockPackets)
+				IF(locked)
+					grant = current;
+			HCL_NAMED(grant);
+
+			StreamT out = in.front();
+			out.ready = Bit{};
+			for (size_t i = 0; i < in.size(); ++i)
+			{
+				Bit granted = grant == i;
+				in[i].ready = *out.ready & granted;
+				IF(granted)
+				{
+					out.value() = in[i].value();
+					out.valid = *in[i].valid;
+					for (auto member : { &StreamT::sop, &StreamT::eop, &StreamT::error })
+						if (in[i].*member)
+							out.*member = *(in[i].*member);
+				}
+			}
+
+			IF(out.transfer())
+			{
+				IF(grant != current | used == currentWeight)
+					used = 0;
+				if (lockPackets)
+				{
+					IF(*out.eop)
+						used += 1;
+					locked = !*out.eop;
+				}
+				else
+				{
+					used += 1;
+				}
+				current = grant;
+			}
+			current = reg(current, 0);
+			used = reg(used, 0);
+			locked = reg(locked, '0');
+			HCL_NAMED(current);
+			HCL_NAMED(used);
+			HCL_NAMED(locked);
+			return out;
+		}
+
+		template<typename StreamT>
+		StreamT arbitrateRoundRobinTree(std::span<StreamT> in, bool lockPackets, size_t registerInterval, size_t depth)
+		{
+			if (in.size() == 1)
+			{
+				const size_t weight = 1;
+				return arbitrateWeightedRoundRobin(in, std::span<const size_t>{ &weight, 1 }, lockPackets);
+			}
+
+			std::array<StreamT, 2> halves = {
+				arbitrateRoundRobinTree(in.first(in.size() / 2), lockPackets, registerInterval, depth + 1),
+				arbitrateRoundRobinTree(in.subspan(in.size() / 2), lockPackets, registerInterval, depth + 1),
+			};
+
+			const size_t weights[] = { 1, 1 };
+			StreamT out = arbitrateWeightedRoundRobin(std::span<StreamT>{ halves }, std::span<const size_t>{ weights }, lockPackets);
+			if (registerInterval > 0 && depth % registerInterval == 0)
+				return skidBuffer(out);
+			return out;
+		}
+	}
+
+	/**
+	 * @brief Grants the valid inputs in turn, one beat each.
+	 * @details The grant is selected combinationally from the valids, the returned stream's ready must be driven by the caller.
+	 * If lockPackets is set, the grant is kept from the first beat of a packet until its eop beat was transferred.
+	 */
+	template<typename Container>
+	typename Container::value_type arbitrateRoundRobin(Container& in, bool lockPackets = false)
+	{
+		using StreamT = typename Container::value_type;
+		std::vector<size_t> weights(std::size(in), 1);
+		return internal::arbitrateWeightedRoundRobin(std::span<StreamT>{ in }, std::span<const size_t>{ weights }, lockPackets);
+	}
+
+	/**
+	 * @brief Grants the valid inputs in turn, each up to its weight in beats before moving on.
+	 * @details Inputs that are not valid are skipped, so an idle input does not waste its share.
+	 * With lockPackets, a packet is never interrupted and the weights count packets instead of beats.
+	 */
+	template<typename Container>
+	typename Container::value_type arbitrateWeightedRoundRobin(Container& in, const std::vector<size_t>& weights, bool lockPackets = false)
+	{
+		using StreamT = typename Container::value_type;
+		return internal::arbitrateWeightedRoundRobin(std::span<StreamT>{ in }, std::span<const size_t>{ weights }, lockPackets);
+	}
+
+	/**
+	 * @brief Round robin arbiter built as a tree of two input arbiters for a log depth grant path.
+	 * @details Like treeReduce, a skid buffer is inserted after the tree levels whose depth is a multiple of registerInterval,
+	 * starting at the root. Each buffer cuts the valid, payload, and ready paths without costing throughput.
+	 * Every node alternates between its subtrees, so for input counts that are not a power of two the shares are not exactly equal.
+	 */
+	template<typename Container>
+	typename Container::value_type arbitrateRoundRobinTree(Container& in, bool lockPackets = false, size_t registerInterval = 0)
+	{
+		using StreamT = typename Container::value_type;
+		auto entity = Area{ "arbitrateRoundRobinTree" }.enter();
+		HCL_DESIGNCHECK_HINT(std::size(in) > 0, "nothing to arbitrate");
+		return internal::arbitrateRoundRobinTree(std::span<StreamT>{ in }, lockPackets, registerInterval, 0);
+	}
 }
@@ -0,0 +1,145 @@
+/*  This file is part of Gatery, a library for circuit design.
+	Copyright (C) 2021 Michael Offel, Andreas Ley
+
+	Gatery is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 3 of the License, or (at your option) any later version.
+
+	Gatery is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#pragma once
+#include <gatery/frontend.h>
+
+#include "Stream.h"
+
+#include <list>
+
+namespace gtry::scl
+{
+	namespace internal
+	{
+		/// Registers the payload and the sop/eop/error side band of a stream, loading new values only while load is high.
+		template<typename T>
+		void regPayload(Stream<T>& dst, const Stream<T>& src, const Bit& load)
+		{
+			T data = constructFrom(src.value());
+			IF(load)
+				data = src.value();
+			data = reg(data);
+			dst.value() = data;
+
+			for (auto member : { &Stream<T>::sop, &Stream<T>::eop, &Stream<T>::error })
+			{
+				if (!(src.*member))
+					continue;
+
+				Bit flag;
+				IF(load)
+					flag = *(src.*member);
+				flag = reg(flag);
+				dst.*member = flag;
+			}
+		}
+	}
+
+	/**
+	 * @brief Forward register slice, registers valid and payload while ready stays combinational.
+	 * @details The slice accepts a new beat whenever it is empty or its current beat is taken in the same cycle,
+	 * so it sustains one transfer per cycle. The ready of the returned stream must be driven by the caller.
+	 */
+	template<typename T>
+	Stream<T> regForward(Stream<T>& in)
+	{
+		auto entity = Area{ "regForward" }.enter();
+		HCL_DESIGNCHECK_HINT(in.valid, "register slices require a valid signal");
+
+		Stream<T> out = in;
+		out.ready = Bit{};
+
+		Bit valid;
+		in.ready = !valid | *out.ready;
+
+		internal::regPayload(out, in, *in.ready);
+
+		IF(*in.ready)
+			valid = *in.valid;
+		valid = reg(valid, '0');
+		HCL_NAMED(valid);
+		out.valid = valid;
+		return out;
+	}
+
+	/**
+	 * @brief Backward register slice, registers ready while valid and payload stay combinational.
+	 * @details A beat that is accepted while the downstream ready drops is held in a single skid register,
+	 * which is drained before the upstream ready rises again. Without backpressure the skid register is never used.
+	 * The ready of the returned stream must be driven by the caller.
+	 */
+	template<typename T>
+	Stream<T> regReady(Stream<T>& in)
+	{
+		auto entity = Area{ "regReady" }.enter();
+		HCL_DESIGNCHECK_HINT(in.valid, "register slices require a valid signal");
+
+		Stream<T> out = in;
+		out.ready = Bit{};
+
+		Bit skidValid;
+		in.ready = !skidValid;
+
+		Stream<T> skid = in;
+		internal::regPayload(skid, in, !skidValid);
+
+		IF(*out.ready)
+			skidValid = '0';
+		ELSE IF(*in.valid)
+			skidValid = '1';
+		skidValid = reg(skidValid, '0');
+		HCL_NAMED(skidValid);
+
+		out.valid = *in.valid | skidValid;
+		IF(skidValid)
+			out.value() = skid.value();
+		for (auto member : { &Stream<T>::sop, &Stream<T>::eop, &Stream<T>::error })
+			if (skid.*member)
+				IF(skidValid)
+					*(out.*member) = *(skid.*member);
+		return out;
+	}
+
+	/**
+	 * @brief Full register slice, registers valid, payload, and ready.
+	 * @details Combines a regReady and a regForward slice, so it holds up to two beats and sustains one transfer per cycle under backpressure.
+	 */
+	template<typename T>
+	Stream<T> skidBuffer(Stream<T>& in)
+	{
+		auto entity = Area{ "skidBuffer" }.enter();
+		Stream<T> decoupled = regReady(in);
+		Stream<T> out = regForward(decoupled);
+		return out;
+	}
+
+	/// Chains the given number of skid buffers, no combinational path crosses more than one stage.
+	template<typename T>
+	Stream<T> regPipeline(Stream<T>& in, size_t stages)
+	{
+		auto entity = Area{ "regPipeline" }.enter();
+		HCL_DESIGNCHECK_HINT(stages > 0, "a stream pipeline needs at least one stage");
+
+		std::list<Stream<T>> pipeline;
+		Stream<T>* stage = &in;
+		for (size_t i = 0; i < stages; ++i)
+			stage = &pipeline.emplace_back(skidBuffer(*stage));
+
+		return std::move(pipeline.back());
+	}
+}
@@ -32,9 +32,18 @@ namespace gtry::scl
 		void latency(size_t cycles);
 		void throughput(size_t cyclesPerHash);
 
+		/// Unrolls all rounds with elaboration time round indices and registers every NUM_ROUNDS / latency rounds.
+		/// @details Round constants and round functions are specialized per round, the pipeline accepts a new block every cycle.
 		void buildPipeline(THash& hash) const;
 		void buildRoundProcessor(size_t startRound, THash& hash) const
 		{
+			if (m_throughput == 1)
+			{
+				// no rounds share hardware, so there is nothing to select at runtime
+				buildPipeline(hash);
+				return;
+			}
+
 			const size_t numSections = std::max<size_t>(1, m_latency);
 			for (size_t s = 0; s < numSections; ++s)
 			{
@@ -85,13 +94,14 @@ namespace gtry::scl
 	template<typename THash>
 	inline void HashEngine<THash>::buildPipeline(THash& hash) const
 	{
-		const size_t regInterval = m_latency ? THash::NUM_ROUNDS / m_latency : THash::NUM_ROUNDS + 1;
+		HCL_DESIGNCHECK_HINT(m_latency <= THash::NUM_ROUNDS, "A hash pipeline can not have more register stages than rounds.");
 
 		for (size_t i = 0; i < THash::NUM_ROUNDS; ++i)
 		{
 			hash.round(i);
 
-			if (i % regInterval == regInterval - 1)
+			// spread the registers evenly, the last one is always behind the final round
+			if ((i + 1) * m_latency / THash::NUM_ROUNDS != i * m_latency / THash::NUM_ROUNDS)
 				hash = reg(hash);
 		}
 	}
@@ -61,23 +61,26 @@ namespace gtry::scl
 
 		HCL_DESIGNCHECK_HINT(block.size() % 64 == 0, "SipHash blocks need to be a multiple of 64 bit");
 
-		BVec blockReg = block;
-		HCL_NAMED(blockReg);
+		// message words are dropped from the pipeline once they are consumed
+		std::vector<BVec> words;
+		for (size_t i = 0; i < block.size() / 64; ++i)
+			words.push_back(block(i * 64, 64));
+		HCL_NAMED(words);
 
-		for (size_t i = 0; i < blockReg.size() / 64; ++i)
+		for (size_t i = 0; i < words.size(); ++i)
 		{
-			state[3] ^= blockReg(i * 64, 64);
+			state[3] ^= words[i];
 			for (size_t j = 0; j < m_messageWordRounds; ++j)
 			{
 				round(state);
 
 				if (m_placeRegister)
 				{
-					blockReg = reg(blockReg);
-					blockReg = reg(blockReg);
+					for (size_t k = i; k < words.size(); ++k)
+						words[k] = reg(reg(words[k]));
 				}
 			}
-			state[0] ^= blockReg(i * 64, 64);
+			state[0] ^= words[i];
 		}
 	}
 
@@ -134,10 +137,10 @@ namespace gtry::scl
 		GroupScope entity(GroupScope::GroupType::ENTITY);
 		entity.setName("SipHashPad");
 
-		BVec paddedLength = ConstBVec(msgByteSize, 8_b);
+		BVec paddedLength = ConstBVec(msgByteSize & 0xFF, 8_b);
 		HCL_NAMED(paddedLength);
 
-		size_t zeroPad = (64 - (msgByteSize * 8 + 8)) % 64;
+		size_t zeroPad = (64 - (msgByteSize * 8 + 8) % 64) % 64;
 		BVec paddedBlock = pack(paddedLength, zext(block(0, msgByteSize*8), zeroPad));
 		HCL_NAMED(paddedBlock);
 		return paddedBlock;
@@ -148,7 +151,7 @@ namespace gtry::scl
 		GroupScope entity(GroupScope::GroupType::ENTITY);
 		entity.setName("SipHash");
 
-		HCL_DESIGNCHECK_HINT(block.size() <= 56 && block.size() % 8 == 0, "no impl");
+		HCL_DESIGNCHECK_HINT(block.size() % 8 == 0, "SipHash messages need to be a multiple of 8 bit");
 
 		SipHash hash;
 		hash.enableRegister(placeregister);
@@ -159,6 +162,6 @@ namespace gtry::scl
 		SipHashState state;
 		hash.initialize(state, key);
 		hash.block(state, paddedBlock);
-		return { hash.finalize(state), hash.latency(1, 64) };
+		return { hash.finalize(state), hash.latency(1, paddedBlock.size()) };
 	}
 }
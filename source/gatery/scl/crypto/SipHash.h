@@ -28,7 +28,8 @@ namespace gtry::scl
 		SipHash(size_t messageWordRounds = 2, size_t finalizeRounds = 4, size_t hashWidth = 64);
 
 		virtual void enableRegister(bool state) { m_placeRegister = state; }
-		virtual size_t latency(size_t numBlocks, size_t blockSize) const { return m_placeRegister ? 2 * (m_messageWordRounds * (blockSize / 64) + m_finalizeRounds) : 0; }
+		/// Latency of numBlocks calls to block() with blockSize bits each followed by finalize().
+		virtual size_t latency(size_t numBlocks, size_t blockSize) const { return m_placeRegister ? 2 * (m_messageWordRounds * numBlocks * (blockSize / 64) + m_finalizeRounds) : 0; }
 
 		virtual void initialize(SipHashState& state, const BVec& key);
 		virtual void block(SipHashState& state, const BVec& block);
@@ -45,6 +46,7 @@ namespace gtry::scl
 		bool m_placeRegister = false;
 	};
 
+	/// Hashes a message of block.size() / 8 bytes, wide messages are unrolled into one pipeline that accepts a message every cycle.
 	std::tuple<BVec, size_t> sipHash(const BVec& block, const BVec& key, bool placeregister = true);
 
 }
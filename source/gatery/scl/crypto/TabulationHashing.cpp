@@ -17,6 +17,7 @@
 */
 #include "gatery/pch.h"
 #include "TabulationHashing.h"
+#include "../algorithm/TreeReduce.h"
 
 namespace gtry::scl
 {
@@ -42,28 +43,76 @@ namespace gtry::scl
 		return *this;
 	}
 
+	TabulationHashing& TabulationHashing::readPortsPerTable(size_t ports)
+	{
+		HCL_ASSERT_HINT(m_tables.empty(), "invalid state");
+		HCL_DESIGNCHECK_HINT(ports > 0, "Every table needs at least one read port.");
+
+		m_readPortsPerTable = ports;
+		return *this;
+	}
+
+	TabulationHashing& TabulationHashing::xorTreeRegisters(size_t registers)
+	{
+		HCL_ASSERT_HINT(m_tables.empty(), "invalid state");
+
+		m_xorTreeRegisters = registers;
+		return *this;
+	}
+
 	BVec gtry::scl::TabulationHashing::operator()(const BVec& data)
+	{
+		return (*this)(std::vector<BVec>{ data }).front();
+	}
+
+	std::vector<BVec> TabulationHashing::operator()(const std::vector<BVec>& data)
 	{
 		HCL_ASSERT_HINT(m_tables.empty(), "invalid state");
+		HCL_DESIGNCHECK_HINT(!data.empty(), "At least one lane is required.");
 
 		GroupScope entity(GroupScope::GroupType::ENTITY);
 		entity.setName("TabulationHashing");
 
-		const size_t numTables = (data.getWidth().value + m_symbolWidth.value - 1) / m_symbolWidth.value;
+		const size_t dataWidth = data.front().size();
+		const size_t numTables = (dataWidth + m_symbolWidth.value - 1) / m_symbolWidth.value;
+		const size_t numReplicas = (data.size() + m_readPortsPerTable - 1) / m_readPortsPerTable;
 		m_tables.resize(numTables);
+		m_replicas.resize(numTables);
 
-		BVec hash = zext(0, m_hashWidth.value);
 		for (size_t t = 0; t < numTables; ++t)
 		{
-			const size_t addrWidth = std::min(m_symbolWidth.value, data.size() - t * m_symbolWidth.value);
-			Memory<BVec>& table = m_tables[t];
-			table.setup(1ull << addrWidth, m_hashWidth);
+			const size_t addrWidth = std::min(m_symbolWidth.value, dataWidth - t * m_symbolWidth.value);
+			m_tables[t].setup(1ull << addrWidth, m_hashWidth);
+
+			m_replicas[t].resize(numReplicas - 1);
+			for (Memory<BVec>& replica : m_replicas[t])
+				replica.setup(1ull << addrWidth, m_hashWidth);
+		}
+
+		std::vector<BVec> hashes;
+		for (size_t lane = 0; lane < data.size(); ++lane)
+		{
+			HCL_DESIGNCHECK_HINT(data[lane].size() == dataWidth, "All lanes must have the same key width.");
+			const size_t replica = lane / m_readPortsPerTable;
+
+			std::vector<BVec> symbolHashes;
+			for (size_t t = 0; t < numTables; ++t)
+			{
+				const size_t addrWidth = std::min(m_symbolWidth.value, dataWidth - t * m_symbolWidth.value);
+				const BVec& addr = data[lane](t * m_symbolWidth.value, addrWidth);
+
+				Memory<BVec>& table = replica == 0 ? m_tables[t] : m_replicas[t][replica - 1];
+				BVec symbolHash = table[addr];
+				if (m_xorTreeRegisters)
+					symbolHash = reg(symbolHash);
+				symbolHashes.push_back(symbolHash);
+			}
 
-			const BVec& addr = data(t * m_symbolWidth.value, addrWidth);
-			hash ^= table[addr];
+			BVec hash = treeReduce(symbolHashes, m_xorTreeRegisters, [](const BVec& a, const BVec& b) { return a ^ b; });
+			HCL_NAMED(hash);
+			hashes.push_back(hash);
 		}
-		HCL_NAMED(hash);
-		return hash;
+		return hashes;
 	}
 
 	AvalonMM TabulationHashing::singleUpdatePort(bool readable)
@@ -93,7 +142,11 @@ namespace gtry::scl
 				auto port = m_tables[t][avmm.address(symbolAddrRange)];
 
 				IF(*avmm.write)
+				{
 					port = *avmm.writeData;
+					for (Memory<BVec>& replica : m_replicas[t])
+						replica[avmm.address(symbolAddrRange)] = *avmm.writeData;
+				}
 
 				if (avmm.readData)
 					*avmm.readData = port;
@@ -107,6 +160,7 @@ namespace gtry::scl
 	{
 		HCL_ASSERT_HINT(!m_tables.empty(), "invalid state. call generator function first");
 		HCL_ASSERT(tableIdx < m_tables.size());
+		HCL_DESIGNCHECK_HINT(m_replicas[tableIdx].empty(), "Replicated tables are only supported by the single update port and the cpu interface.");
 		GroupScope entity(GroupScope::GroupType::ENTITY);
 		entity.setName("TabulationHashing_UpdatePort");
 
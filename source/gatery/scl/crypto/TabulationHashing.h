@@ -31,24 +31,35 @@ namespace gtry::scl
 
 		TabulationHashing& hashWidth(BitWidth width);
 		TabulationHashing& symbolWidth(BitWidth width);
+		/// Number of lanes served by one copy of the tables, the tables are replicated for the remaining lanes.
+		TabulationHashing& readPortsPerTable(size_t ports);
+		/// Registers the table reads and places the given number of registers in the xor tree that combines them.
+		TabulationHashing& xorTreeRegisters(size_t registers);
 
 		virtual BVec operator () (const BVec& data);
-		size_t latency() const { return 1; }
+		/// Hashes one key per lane and cycle, all lanes share the table content.
+		virtual std::vector<BVec> operator () (const std::vector<BVec>& data);
+		/// Without xor tree registers the caller has to register the result to turn the table reads into block rams.
+		size_t latency() const { return m_xorTreeRegisters ? 1 + m_xorTreeRegisters : 1; }
 
 		AvalonMM singleUpdatePort(bool readable = false);
 		AvalonMM tableUpdatePort(size_t tableIdx, bool readable = false);
 
 		void updatePorts(AvalonNetworkSection& net);
 
-		void addCpuInterface(MemoryMap& mmap) { mmap.stage(m_tables); }
+		void addCpuInterface(MemoryMap& mmap) { mmap.stage(m_tables, m_replicas); }
 
 		size_t numTables() const { return m_tables.size(); }
+		size_t numReplicas() const { return m_replicas.empty() ? 1 : 1 + m_replicas.front().size(); }
 		BitWidth hashWidth() const { return m_hashWidth; }
 		BitWidth symbolWidth() const { return m_symbolWidth; }
 
 	private:
 		BitWidth m_hashWidth;
 		BitWidth m_symbolWidth = 8_b;
+		size_t m_readPortsPerTable = 1;
+		size_t m_xorTreeRegisters = 0;
 		std::vector<Memory<BVec>> m_tables;
+		std::vector<std::vector<Memory<BVec>>> m_replicas;
 	};
 }
@@ -31,42 +31,42 @@ namespace gtry::scl
 			BLOCK_WIDTH = 512
 		};
 
+		static constexpr std::array<uint32_t, NUM_ROUNDS> K = {
+			0xD76AA478, 0xE8C7B756, 0x242070DB, 0xC1BDCEEE,
+			0xF57C0FAF, 0x4787C62A, 0xA8304613, 0xFD469501,
+			0x698098D8, 0x8B44F7AF, 0xFFFF5BB1, 0x895CD7BE,
+			0x6B901122, 0xFD987193, 0xA679438E, 0x49B40821,
+			0xF61E2562, 0xC040B340, 0x265E5A51, 0xE9B6C7AA,
+			0xD62F105D, 0x02441453, 0xD8A1E681, 0xE7D3FBC8,
+			0x21E1CDE6, 0xC33707D6, 0xF4D50D87, 0x455A14ED,
+			0xA9E3E905, 0xFCEFA3F8, 0x676F02D9, 0x8D2A4C8A,
+			0xFFFA3942, 0x8771F681, 0x6D9D6122, 0xFDE5380C,
+			0xA4BEEA44, 0x4BDECFA9, 0xF6BB4B60, 0xBEBFBC70,
+			0x289B7EC6, 0xEAA127FA, 0xD4EF3085, 0x04881D05,
+			0xD9D4D039, 0xE6DB99E5, 0x1FA27CF8, 0xC4AC5665,
+			0xF4292244, 0x432AFF97, 0xAB9423A7, 0xFC93A039,
+			0x655B59C3, 0x8F0CCC92, 0xFFEFF47D, 0x85845DD1,
+			0x6FA87E4F, 0xFE2CE6E0, 0xA3014314, 0x4E0811A1,
+			0xF7537E82, 0xBD3AF235, 0x2AD7D2BB, 0xEB86D391
+		};
+
+		static constexpr std::array<uint8_t, 16> S = {
+			7, 12, 17, 22,
+			5,  9, 14, 20,
+			4, 11, 16, 23,
+			6, 10, 15, 21
+		};
+
 		BOOST_HANA_DEFINE_STRUCT(Md5Generator,
 			(TVec, hash),
 			(TVec, a),
 			(TVec, b),
 			(TVec, c),
 			(TVec, d),
-			(std::array<TVec, 16>, w),
-			(std::array<TVec, NUM_ROUNDS>, constants),
-			(std::array<BVec, NUM_ROUNDS>, s)
+			(std::array<TVec, 16>, w)
 		);
 
-		Md5Generator() :
-			constants({ {
-				"xD76AA478", "xE8C7B756", "x242070DB", "xC1BDCEEE",
-				"xF57C0FAF", "x4787C62A", "xA8304613", "xFD469501",
-				"x698098D8", "x8B44F7AF", "xFFFF5BB1", "x895CD7BE",
-				"x6B901122", "xFD987193", "xA679438E", "x49B40821",
-				"xF61E2562", "xC040B340", "x265E5A51", "xE9B6C7AA",
-				"xD62F105D", "x02441453", "xD8A1E681", "xE7D3FBC8",
-				"x21E1CDE6", "xC33707D6", "xF4D50D87", "x455A14ED",
-				"xA9E3E905", "xFCEFA3F8", "x676F02D9", "x8D2A4C8A",
-				"xFFFA3942", "x8771F681", "x6D9D6122", "xFDE5380C",
-				"xA4BEEA44", "x4BDECFA9", "xF6BB4B60", "xBEBFBC70",
-				"x289B7EC6", "xEAA127FA", "xD4EF3085", "x04881D05",
-				"xD9D4D039", "xE6DB99E5", "x1FA27CF8", "xC4AC5665",
-				"xF4292244", "x432AFF97", "xAB9423A7", "xFC93A039",
-				"x655B59C3", "x8F0CCC92", "xFFEFF47D", "x85845DD1",
-				"x6FA87E4F", "xFE2CE6E0", "xA3014314", "x4E0811A1",
-				"xF7537E82", "xBD3AF235", "x2AD7D2BB", "xEB86D391"
-			} }),
-			s({ {
-				"5d7", "5d12", "5d17", "5d22",  "5d7", "5d12", "5d17", "5d22",  "5d7", "5d12", "5d17", "5d22",  "5d7", "5d12", "5d17", "5d22",
-				"5d5",  "5d9", "5d14", "5d20",  "5d5",  "5d9", "5d14", "5d20",  "5d5",  "5d9", "5d14", "5d20",  "5d5",  "5d9", "5d14", "5d20",
-				"5d4", "5d11", "5d16", "5d23",  "5d4", "5d11", "5d16", "5d23",  "5d4", "5d11", "5d16", "5d23",  "5d4", "5d11", "5d16", "5d23",
-				"5d6", "5d10", "5d15", "5d21",  "5d6", "5d10", "5d15", "5d21",  "5d6", "5d10", "5d15", "5d21",  "5d6", "5d10", "5d15", "5d21"
-			}})
+		Md5Generator()
 		{
 			a = "x67452301";
 			b = "xEFCDAB89";
@@ -85,6 +85,12 @@ namespace gtry::scl
 
 		void round(const BVec& round)
 		{
+			std::vector<BVec> constants, s;
+			for (uint32_t k : K)
+				constants.push_back(ConstBVec(k, 32_b));
+			for (size_t i = 0; i < NUM_ROUNDS; ++i)
+				s.push_back(ConstBVec(S[i / 16 * 4 + i % 4], 5_b));
+
 			TVec k = mux(round, constants);
 			
 			// select round function
@@ -119,6 +125,37 @@ namespace gtry::scl
 			b = tmp;
 		}
 
+		/// Round with an elaboration time index, constant, message word, rotation and round function are selected without multiplexers.
+		void round(size_t round)
+		{
+			TVec f;
+			size_t g;
+			switch (round / 16)
+			{
+			case 0:
+				f = (b & c) | (~b & d);
+				g = round;
+				break;
+			case 1:
+				f = (b & d) | (c & ~d);
+				g = round * 5 + 1;
+				break;
+			case 2:
+				f = b ^ c ^ d;
+				g = round * 3 + 5;
+				break;
+			default:
+				f = c ^ (b | ~d);
+				g = round * 7;
+			}
+
+			TVec tmp = b + rotl(TAdder{} + a + ConstBVec(K[round], 32_b) + f + w[g % 16], S[round / 16 * 4 + round % 4]);
+			a = d;
+			d = c;
+			c = b;
+			b = tmp;
+		}
+
 		void endBlock()
 		{
 			a += hash(Selection::Symbol(0, 32_b));
@@ -81,6 +81,43 @@ namespace gtry::scl
 
 			HCL_NAMED(f);
 
+			roundWithConstant(k, f, rotateW);
+		}
+
+		/// Round with an elaboration time index, constant and round function are selected without multiplexers.
+		void round(size_t round, bool rotateW = true)
+		{
+			TVec k = 32_b;
+			TVec f;
+			if (round < 20)
+			{
+				k = 0x5A827999;
+				f = (b & c) | (~b & d);
+			}
+			else if (round < 40)
+			{
+				k = 0x6ED9EBA1;
+				f = b ^ c ^ d;
+			}
+			else if (round < 60)
+			{
+				k = 0x8F1BBCDC;
+				f = (b & c) | (b & d) | (c & d);
+			}
+			else
+			{
+				k = 0xCA62C1D6;
+				f = b ^ c ^ d;
+			}
+
+			HCL_NAMED(k);
+			HCL_NAMED(f);
+
+			roundWithConstant(k, f, rotateW);
+		}
+
+		void roundWithConstant(const TVec& k, const TVec& f, bool rotateW)
+		{
 			// update state
 			TVec tmp = TAdder{} + rotl(a, 5) + e + w[0] + k + f;
 			e = d;
@@ -130,6 +167,11 @@ namespace gtry::scl
 		{
 			Sha1Generator<TVec, TAdder>::round(round, false);
 		}
+
+		void round(size_t round)
+		{
+			Sha1Generator<TVec, TAdder>::round(round, false);
+		}
 	};
 
 	extern template struct Sha1Generator<>;
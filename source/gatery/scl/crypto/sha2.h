@@ -31,6 +31,17 @@ namespace gtry::scl
 			BLOCK_WIDTH = 512
 		};
 
+		static constexpr std::array<uint32_t, NUM_ROUNDS> K = {
+			0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+			0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+			0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+			0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+			0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+			0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+			0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+			0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+		};
+
 		BOOST_HANA_DEFINE_STRUCT(Sha2_256,
 			(BVec, hash),
 			(BVec, a),
@@ -41,21 +52,10 @@ namespace gtry::scl
 			(BVec, f),
 			(BVec, g),
 			(BVec, h),
-			(std::array<BVec, 16>, w),
-			(std::vector<BVec>, kTable)
+			(std::array<BVec, 16>, w)
 		);
 
-		Sha2_256() :
-			kTable{ {
-				"x428a2f98", "x71374491", "xb5c0fbcf", "xe9b5dba5", "x3956c25b", "x59f111f1", "x923f82a4", "xab1c5ed5",
-				"xd807aa98", "x12835b01", "x243185be", "x550c7dc3", "x72be5d74", "x80deb1fe", "x9bdc06a7", "xc19bf174",
-				"xe49b69c1", "xefbe4786", "x0fc19dc6", "x240ca1cc", "x2de92c6f", "x4a7484aa", "x5cb0a9dc", "x76f988da",
-				"x983e5152", "xa831c66d", "xb00327c8", "xbf597fc7", "xc6e00bf3", "xd5a79147", "x06ca6351", "x14292967",
-				"x27b70a85", "x2e1b2138", "x4d2c6dfc", "x53380d13", "x650a7354", "x766a0abb", "x81c2c92e", "x92722c85",
-				"xa2bfe8a1", "xa81a664b", "xc24b8b70", "xc76c51a3", "xd192e819", "xd6990624", "xf40e3585", "x106aa070",
-				"x19a4c116", "x1e376c08", "x2748774c", "x34b0bcb5", "x391c0cb3", "x4ed8aa4a", "x5b9cca4f", "x682e6ff3",
-				"x748f82ee", "x78a5636f", "x84c87814", "x8cc70208", "x90befffa", "xa4506ceb", "xbef9a3f7", "xc67178f2"
-			} }
+		Sha2_256()
 		{
 			a = "x6a09e667";
 			b = "xbb67ae85";
@@ -76,13 +76,27 @@ namespace gtry::scl
 		}
 
 		void round(const BVec& round)
+		{
+			std::vector<BVec> kTable;
+			for (uint32_t k : K)
+				kTable.push_back(ConstBVec(k, 32_b));
+
+			roundWithConstant(mux(round, kTable));
+		}
+
+		/// Round with an elaboration time index, the round constant is a literal instead of a table lookup.
+		void round(size_t round)
+		{
+			roundWithConstant(ConstBVec(K[round], 32_b));
+		}
+
+		void roundWithConstant(const BVec& k)
 		{
 			// update state
 			const BVec s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
 			const BVec s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
 			const BVec ch = (e & f) ^ (~e & g);
 			const BVec maj = (a & b) ^ (a & c) ^ (b & c);
-			const BVec k = mux(round, kTable);
 
 			TAdder tmp = TAdder{} + h + w[0] + k + s1 + ch;
 			h = g;
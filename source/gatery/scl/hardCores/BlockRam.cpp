@@ -23,6 +23,93 @@
 using namespace gtry::scl;
 using namespace gtry;
 
+namespace gtry::scl::internal {
+
+Memory::Memory(size_t numWords, size_t wordWidth) :
+    m_numWords(numWords),
+    m_wordWidth(wordWidth)
+{
+    m_node = DesignScope::createNode<hlim::Node_Memory>();
+    m_node->setNoConflicts();
+
+    sim::DefaultBitVectorState state;
+    state.resize(numWords * wordWidth);
+    state.clearRange(sim::DefaultConfig::DEFINED, 0, state.size());
+    m_node->setPowerOnState(std::move(state));
+}
+
+bool Memory::readsOrderedAfterWrites() const
+{
+    return samePortRead == PortConflict::inOrder &&
+        differentPortRead == PortConflict::inOrder &&
+        differentPortWrite == PortConflict::inOrder;
+}
+
+BVec Memory::read(const BVec& address)
+{
+    auto* readPort = DesignScope::createNode<hlim::Node_MemPort>(m_wordWidth);
+    readPort->connectMemory(m_node);
+    if (readsOrderedAfterWrites() && m_lastWritePort != nullptr)
+        readPort->orderAfter(m_lastWritePort);
+    if (auto* scope = ConditionalScope::get())
+        readPort->connectEnable(scope->getFullCondition());
+    readPort->connectAddress(address.getReadPort());
+
+    return BVec(SignalReadPort({ .node = readPort, .port = (unsigned)hlim::Node_MemPort::Outputs::rdData }));
+}
+
+void Memory::write(const BVec& address, const BVec& data, const std::optional<BVec>& byteEnable)
+{
+    HCL_DESIGNCHECK_HINT(data.size() == m_wordWidth, "The width of data written to a memory must match its word width.");
+
+    auto* writePort = DesignScope::createNode<hlim::Node_MemPort>(m_wordWidth);
+    writePort->connectMemory(m_node);
+    if (differentPortWrite == PortConflict::inOrder && m_lastWritePort != nullptr)
+        writePort->orderAfter(m_lastWritePort);
+    if (auto* scope = ConditionalScope::get()) {
+        writePort->connectEnable(scope->getFullCondition());
+        writePort->connectWrEnable(scope->getFullCondition());
+    }
+    writePort->connectAddress(address.getReadPort());
+    writePort->connectWrData(data.getReadPort());
+    if (byteEnable) {
+        HCL_DESIGNCHECK_HINT(byteEnable->size() > 0 && m_wordWidth % byteEnable->size() == 0, "The word width of a memory must be a multiple of the number of byte enable bits.");
+        writePort->connectWrByteEnable(byteEnable->getReadPort());
+    }
+    writePort->setClock(ClockScope::getClk().getClk());
+
+    m_lastWritePort = writePort;
+}
+
+bool isConstant(hlim::NodePort output)
+{
+    std::vector<hlim::BaseNode*> openList = { output.node };
+    std::set<hlim::BaseNode*> visited;
+    while (!openList.empty()) {
+        hlim::BaseNode* node = openList.back();
+        openList.pop_back();
+
+        if (!visited.insert(node).second) continue;
+        if (dynamic_cast<hlim::Node_Constant*>(node)) continue;
+
+        // Undriven signals are the undefined default of a plain bit width. Everything else must be combinatorial logic on constants.
+        if (!dynamic_cast<hlim::Node_Signal*>(node)) {
+            if (node->getNumInputPorts() == 0 || !node->isCombinatorial() || node->hasSideEffects() ||
+                dynamic_cast<hlim::Node_Pin*>(node) || dynamic_cast<hlim::Node_MemPort*>(node))
+                return false;
+        }
+
+        for (auto i : utils::Range(node->getNumInputPorts())) {
+            auto driver = node->getDriver(i);
+            if (driver.node != nullptr)
+                openList.push_back(driver.node);
+        }
+    }
+    return true;
+}
+
+}
+
 /*
 Stream<BVec> gtry::scl::simpleDualPortRam(Stream<WritePort>& write, Stream<BVec> readAddress, std::string_view name)
 {
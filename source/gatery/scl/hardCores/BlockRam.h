@@ -41,18 +41,45 @@ namespace gtry::scl {
 
             std::optional<Bit> write;
             std::optional<BVec> writeData;
+            std::optional<BVec> byteEnable;
         };
 
-        struct Memory
+        /**
+         * @brief Backs Rom and Ram with a Node_Memory so that they are simulated as memories and can be mapped to BRAM or LUTRAM.
+         * @details The memory is always marked as free of conflicts and the port order is built explicitly from the PortConflict policies.
+         * Writes are ordered among each other unless differentPortWrite is dontCare, in which case colliding writes are undefined.
+         * If both read policies are inOrder and writes are ordered, reads are ordered after the last write and the memory detector
+         * builds the forwarding logic. Otherwise the forwarding for the inOrder policies is built here.
+         */
+        class Memory
         {
-            std::vector<BVec> data;
-            std::vector<BVec> readData;
+        public:
+            Memory(size_t numWords, size_t wordWidth);
+
+            BVec read(const BVec& address);
+            void write(const BVec& address, const BVec& data, const std::optional<BVec>& byteEnable);
+
+            bool readsOrderedAfterWrites() const;
+
+            hlim::Node_Memory* getNode() { return m_node; }
+            size_t numWords() const { return m_numWords; }
+            size_t wordWidth() const { return m_wordWidth; }
+
             std::map<gtry::SignalReadPort, MemoryPort> ports;
 
             PortConflict samePortRead = PortConflict::inOrder;
             PortConflict differentPortRead = PortConflict::inOrder;
             PortConflict differentPortWrite = PortConflict::inOrder;
+
+        protected:
+            hlim::NodePtr<hlim::Node_Memory> m_node;
+            hlim::NodePtr<hlim::Node_MemPort> m_lastWritePort;
+            size_t m_numWords;
+            size_t m_wordWidth;
         };
+
+        /// Returns true if the output only depends on constants and undriven signals, i.e. if it can be evaluated at construction time.
+        bool isConstant(hlim::NodePort output);
     }
 
     template<typename Data>
@@ -66,26 +93,27 @@ namespace gtry::scl {
             m_defaultValue(defaultValue)
         {}
 
-        MemoryReadPort& byteEnable(const BVec&);
-
         Data read() const
         {
-            BVec readData = mux(m_port.address, m_memory->readData);
+            BVec readData = m_memory->read(m_port.address);
 
-            for (auto& it : m_memory->ports)
+            if (!m_memory->readsOrderedAfterWrites())
             {
-                if (it.second.write)
+                for (auto& it : m_memory->ports)
                 {
-                    if (&it.second == &m_port && m_memory->samePortRead != PortConflict::dontCare)
+                    if (it.second.write)
                     {
-                        IF(*it.second.write)
-                            readData = *it.second.writeData;
-                    }
-
-                    if (&it.second != &m_port && m_memory->differentPortRead != PortConflict::dontCare)
-                    {
-                        IF(*it.second.write & it.second.address == m_port.address)
-                            readData = *it.second.writeData;
+                        if (&it.second == &m_port && m_memory->samePortRead != PortConflict::dontCare)
+                        {
+                            IF(*it.second.write)
+                                readData = forwardWrite(readData, it.second);
+                        }
+
+                        if (&it.second != &m_port && m_memory->differentPortRead != PortConflict::dontCare)
+                        {
+                            IF(*it.second.write & it.second.address == m_port.address)
+                                readData = forwardWrite(readData, it.second);
+                        }
                     }
                 }
             }
@@ -102,6 +130,18 @@ namespace gtry::scl {
         internal::MemoryPort& m_port;
         Data m_defaultValue;
 
+        static BVec forwardWrite(const BVec& readData, const internal::MemoryPort& writer)
+        {
+            if (!writer.byteEnable)
+                return *writer.writeData;
+
+            BVec ret = readData;
+            const size_t laneWidth = ret.size() / writer.byteEnable->size();
+            for (size_t i = 0; i < writer.byteEnable->size(); ++i)
+                IF((*writer.byteEnable)[i])
+                    ret(i * laneWidth, laneWidth) = (*writer.writeData)(i * laneWidth, laneWidth);
+            return ret;
+        }
     };
 
     template<typename Data>
@@ -111,7 +151,12 @@ namespace gtry::scl {
         MemoryPort(const MemoryPort&) = default;
         using MemoryReadPort<Data>::MemoryReadPort;
 
-        MemoryPort& byteEnable(const BVec&);
+        /// Restricts all subsequent writes through this port to the lanes whose bit is set.
+        MemoryPort& byteEnable(const BVec& enable)
+        {
+            this->m_port.byteEnable = enable;
+            return *this;
+        }
 
         MemoryPort& write(const Data& value)
         {
@@ -122,13 +167,7 @@ namespace gtry::scl {
                 this->m_port.write = gtry::SignalReadPort{ scope->getFullCondition() };
 
             this->m_port.writeData = pack(value);
-            sim_debug() << "write " << *this->m_port.write << ", data " << *this->m_port.writeData << ", address " << this->m_port.address;
-
-            for (size_t i = 0; i < this->m_memory->data.size(); ++i)
-            {
-                IF(this->m_port.address == i)
-                    this->m_memory->data[i] = *this->m_port.writeData;
-            }
+            this->m_memory->write(this->m_port.address, *this->m_port.writeData, this->m_port.byteEnable);
             return *this;
         }
 
@@ -137,6 +176,12 @@ namespace gtry::scl {
     };
 
 
+    template<typename Data>
+    Data reg(const MemoryReadPort<Data>& port) { return gtry::reg(port.read()); }
+
+    template<typename Data>
+    Data reg(const MemoryPort<Data>& port) { return gtry::reg(port.read()); }
+
     template<typename Data = BVec>
     class Rom
     {
@@ -145,19 +190,32 @@ namespace gtry::scl {
         Rom(size_t size, DataInit def = Data{}) :
             m_defaultValue(def)
         {
-            m_memory = std::make_shared<internal::Memory>();
-            m_memory->data.resize(size);
-            m_memory->readData.resize(size);
-
-            for (size_t i = 0; i < m_memory->data.size(); ++i)
-            {
-                m_memory->data[i] = def;
-                m_memory->data[i] = reg(m_memory->data[i]);
-                m_memory->readData[i] = m_memory->data[i];
-            }
+            BVec packedDefault = pack(m_defaultValue);
+            HCL_DESIGNCHECK_HINT(internal::isConstant(packedDefault.getReadPort()), "The default value of a memory must be constant, since it is evaluated once to fill the power on state.");
+            m_memory = std::make_shared<internal::Memory>(size, packedDefault.size());
+
+            // All words start out with the default value as far as it can be evaluated at construction time.
+            sim::DefaultBitVectorState defaultWord = sim::SigHandle(packedDefault.getReadPort()).eval();
+            auto& state = m_memory->getNode()->getPowerOnState();
+            for (size_t i = 0; i < size; ++i)
+                state.copyRange(i * defaultWord.size(), defaultWord, 0, defaultWord.size());
         }
 
-        size_t size() const { return m_memory->data.size(); }
+        size_t size() const { return m_memory->numWords(); }
+
+        void setName(std::string name) { m_memory->getNode()->setName(std::move(name)); }
+        void setType(hlim::Node_Memory::MemType type) { m_memory->getNode()->setType(type); }
+        /// Overwrites the head of the memory content, the rest is undefined.
+        void fillPowerOnState(sim::DefaultBitVectorState powerOnState) { m_memory->getNode()->fillPowerOnState(std::move(powerOnState)); }
+
+        /// Sets how reads and writes of the same cycle interact, must be called before the first port is created.
+        void portConflicts(PortConflict samePortRead, PortConflict differentPortRead, PortConflict differentPortWrite)
+        {
+            HCL_DESIGNCHECK_HINT(m_memory->ports.empty(), "The port conflict policies must be set before the first port is created.");
+            m_memory->samePortRead = samePortRead;
+            m_memory->differentPortRead = differentPortRead;
+            m_memory->differentPortWrite = differentPortWrite;
+        }
 
         MemoryReadPort<Data> operator [] (const BVec& address)
         {
@@ -177,7 +235,6 @@ namespace gtry::scl {
     public:
         using Rom<Data>::Rom;
         
-        // - merge same bitvector node ports
         // - allow different address width for Data = BVec
         MemoryPort<Data> operator [] (const BVec& address)
         {
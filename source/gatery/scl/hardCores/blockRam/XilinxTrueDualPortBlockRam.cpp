@@ -0,0 +1,370 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#include "gatery/pch.h"
+#include "XilinxTrueDualPortBlockRam.h"
+
+#include <boost/format.hpp>
+
+namespace gtry::scl::blockram {
+
+using namespace hlim;
+
+XilinxTrueDualPortBlockRam::XilinxTrueDualPortBlockRam(size_t numWords, size_t wordWidth, size_t byteWidth, WriteMode writeMode) :
+    m_numWords(numWords),
+    m_wordWidth(wordWidth),
+    m_byteWidth(byteWidth == 0 ? wordWidth : byteWidth),
+    m_writeMode(writeMode)
+{
+    HCL_DESIGNCHECK_HINT(m_wordWidth % m_byteWidth == 0, "The word width of a block ram must be a multiple of its byte width.");
+
+    m_libraryName = "XPM";
+    m_name = "xpm_memory_tdpram";
+    m_clockNames = {"clka", "clkb"};
+    m_resetNames = {"rsta", "rstb"};
+    m_clocks.resize(CLK_COUNT);
+
+    m_initialData.resize(m_numWords * m_wordWidth);
+    m_initialData.clearRange(sim::DefaultConfig::DEFINED, 0, m_initialData.size());
+
+    resizeInputs(IN_COUNT);
+    resizeOutputs(OUT_COUNT);
+    for (auto i : utils::Range(OUT_COUNT)) {
+        setOutputConnectionType(i, {.interpretation = ConnectionType::BITVEC, .width = m_wordWidth});
+        setOutputType(i, OUTPUT_LATCHED);
+    }
+
+    updateGenericParameters();
+}
+
+void XilinxTrueDualPortBlockRam::updateGenericParameters()
+{
+    const char *writeMode = "\"write_first\"";
+    if (m_writeMode == WriteMode::READ_FIRST)
+        writeMode = "\"read_first\"";
+    else if (m_writeMode == WriteMode::NO_CHANGE)
+        writeMode = "\"no_change\"";
+
+    m_genericParameters["MEMORY_SIZE"] = std::to_string(m_numWords * m_wordWidth);
+    m_genericParameters["MEMORY_PRIMITIVE"] = "\"block\"";
+    m_genericParameters["CLOCKING_MODE"] = m_clocks[CLK_A] == m_clocks[CLK_B] ? "\"common_clock\"" : "\"independent_clock\"";
+    m_genericParameters["ECC_MODE"] = "\"no_ecc\"";
+    m_genericParameters["MEMORY_INIT_FILE"] = "\"none\"";
+    m_genericParameters["USE_MEM_INIT"] = "1";
+    m_genericParameters["WAKEUP_TIME"] = "\"disable_sleep\"";
+    m_genericParameters["MESSAGE_CONTROL"] = "0";
+    m_genericParameters["AUTO_SLEEP_TIME"] = "0";
+    m_genericParameters["USE_EMBEDDED_CONSTRAINT"] = "0";
+    m_genericParameters["MEMORY_OPTIMIZATION"] = "\"true\"";
+
+    // Initial content as comma separated hex words, undefined bits are zero
+    std::string initParam;
+    bool anyDefined = false;
+    for (auto word : utils::Range(m_numWords)) {
+        std::string hex;
+        for (size_t nibble = 0; nibble < (m_wordWidth + 3) / 4; nibble++) {
+            unsigned value = 0;
+            for (auto bit : utils::Range(std::min<size_t>(4, m_wordWidth - nibble * 4))) {
+                size_t offset = word * m_wordWidth + nibble * 4 + bit;
+                if (m_initialData.get(sim::DefaultConfig::DEFINED, offset)) {
+                    anyDefined = true;
+                    if (m_initialData.get(sim::DefaultConfig::VALUE, offset))
+                        value |= 1 << bit;
+                }
+            }
+            hex.insert(hex.begin(), "0123456789abcdef"[value]);
+        }
+        if (word > 0) initParam += ',';
+        initParam += hex;
+    }
+    m_genericParameters["MEMORY_INIT_PARAM"] = anyDefined ? '"' + initParam + '"' : "\"0\"";
+
+    for (auto port : {'A', 'B'}) {
+        auto name = [port](const char *generic) { return (boost::format("%s_%c") % generic % port).str(); };
+        m_genericParameters[name("WRITE_DATA_WIDTH")] = std::to_string(m_wordWidth);
+        m_genericParameters[name("READ_DATA_WIDTH")] = std::to_string(m_wordWidth);
+        m_genericParameters[name("BYTE_WRITE_WIDTH")] = std::to_string(m_byteWidth);
+        m_genericParameters[name("ADDR_WIDTH")] = std::to_string(getAddressWidth());
+        m_genericParameters[name("READ_RESET_VALUE")] = "\"0\"";
+        m_genericParameters[name("READ_LATENCY")] = "1";
+        m_genericParameters[name("WRITE_MODE")] = writeMode;
+    }
+}
+
+void XilinxTrueDualPortBlockRam::setInitialData(sim::DefaultBitVectorState initialData)
+{
+    HCL_DESIGNCHECK_HINT(initialData.size() == m_numWords * m_wordWidth, "The initial data must match the size of the block ram.");
+    m_initialData = std::move(initialData);
+    updateGenericParameters();
+}
+
+void XilinxTrueDualPortBlockRam::setClocks(hlim::Clock *clockA, hlim::Clock *clockB)
+{
+    attachClock(clockA, CLK_A);
+    attachClock(clockB, CLK_B);
+    updateGenericParameters();
+}
+
+void XilinxTrueDualPortBlockRam::connectPort(Port port, const Bit &enable, const BVec &writeEnable, const BVec &address, const BVec &writeData)
+{
+    HCL_DESIGNCHECK_HINT(writeEnable.size() == getNumLanes(), "The write enable of a block ram port must have one bit per lane.");
+    HCL_DESIGNCHECK_HINT(address.size() == getAddressWidth(), "The address width of a block ram port must match the number of words.");
+    HCL_DESIGNCHECK_HINT(writeData.size() == m_wordWidth, "The write data width of a block ram port must match the word width.");
+
+    size_t offset = port * IN_PORT_STRIDE;
+    rewireInput(IN_ENA + offset, enable.getReadPort());
+    rewireInput(IN_WEA + offset, writeEnable.getReadPort());
+    rewireInput(IN_ADDRA + offset, address.getReadPort());
+    rewireInput(IN_DINA + offset, writeData.getReadPort());
+
+    // Macro inputs that are not used
+    Bit one = '1';
+    Bit zero = '0';
+    rewireInput(IN_REGCEA + offset, one.getReadPort());
+    rewireInput(IN_INJECTSBITERRA + offset, zero.getReadPort());
+    rewireInput(IN_INJECTDBITERRA + offset, zero.getReadPort());
+    rewireInput(IN_SLEEP, zero.getReadPort());
+}
+
+BVec XilinxTrueDualPortBlockRam::getReadData(Port port)
+{
+    return BVec(SignalReadPort(NodePort{.node = this, .port = size_t(port == PORT_A ? OUT_DOUTA : OUT_DOUTB)}));
+}
+
+namespace {
+
+bool mayBeSet(const sim::DefaultBitVectorState &state, size_t offset)
+{
+    return !state.get(sim::DefaultConfig::DEFINED, offset) || state.get(sim::DefaultConfig::VALUE, offset);
+}
+
+}
+
+void XilinxTrueDualPortBlockRam::simulateReset(sim::SimulatorCallbacks &simCallbacks, sim::DefaultBitVectorState &state, const size_t *internalOffsets, const size_t *outputOffsets) const
+{
+    state.copyRange(internalOffsets[INT_MEMORY], m_initialData, 0, m_initialData.size());
+    for (auto port : utils::Range<size_t>(PORT_COUNT)) {
+        size_t it = port * INT_PORT_STRIDE;
+        state.setRange(sim::DefaultConfig::DEFINED, internalOffsets[INT_ENA + it], 1);
+        state.clearRange(sim::DefaultConfig::VALUE, internalOffsets[INT_ENA + it], 1);
+        state.clearRange(sim::DefaultConfig::DEFINED, outputOffsets[OUT_DOUTA + port], m_wordWidth);
+    }
+}
+
+void XilinxTrueDualPortBlockRam::simulateEvaluate(sim::SimulatorCallbacks &simCallbacks, sim::DefaultBitVectorState &state, const size_t *internalOffsets, const size_t *inputOffsets, const size_t *outputOffsets) const
+{
+    const size_t numLanes = getNumLanes();
+    const size_t addrWidth = getAddressWidth();
+
+    // Latch the inputs of both ports for the clock edge, unconnected ports are disabled.
+    for (auto port : utils::Range<size_t>(PORT_COUNT)) {
+        size_t in = port * IN_PORT_STRIDE;
+        size_t it = port * INT_PORT_STRIDE;
+
+        if (inputOffsets[IN_ENA + in] == ~0ull) {
+            state.setRange(sim::DefaultConfig::DEFINED, internalOffsets[INT_ENA + it], 1);
+            state.clearRange(sim::DefaultConfig::VALUE, internalOffsets[INT_ENA + it], 1);
+        } else
+            state.copyRange(internalOffsets[INT_ENA + it], state, inputOffsets[IN_ENA + in], 1);
+
+        if (inputOffsets[IN_WEA + in] == ~0ull) {
+            state.setRange(sim::DefaultConfig::DEFINED, internalOffsets[INT_WEA + it], numLanes);
+            state.clearRange(sim::DefaultConfig::VALUE, internalOffsets[INT_WEA + it], numLanes);
+        } else
+            state.copyRange(internalOffsets[INT_WEA + it], state, inputOffsets[IN_WEA + in], numLanes);
+
+        if (inputOffsets[IN_ADDRA + in] == ~0ull)
+            state.clearRange(sim::DefaultConfig::DEFINED, internalOffsets[INT_ADDRA + it], addrWidth);
+        else
+            state.copyRange(internalOffsets[INT_ADDRA + it], state, inputOffsets[IN_ADDRA + in], addrWidth);
+
+        if (inputOffsets[IN_DINA + in] == ~0ull)
+            state.clearRange(sim::DefaultConfig::DEFINED, internalOffsets[INT_DINA + it], m_wordWidth);
+        else
+            state.copyRange(internalOffsets[INT_DINA + it], state, inputOffsets[IN_DINA + in], m_wordWidth);
+    }
+
+    auto writes = [&](size_t it) {
+        if (!mayBeSet(state, internalOffsets[INT_ENA + it])) return false;
+        for (auto lane : utils::Range(numLanes))
+            if (mayBeSet(state, internalOffsets[INT_WEA + it] + lane)) return true;
+        return false;
+    };
+
+    // Determine what each port reads on the next clock edge.
+    for (auto port : utils::Range<size_t>(PORT_COUNT)) {
+        size_t it = port * INT_PORT_STRIDE;
+        size_t otherIt = (1 - port) * INT_PORT_STRIDE;
+        size_t readOffset = internalOffsets[INT_READA + it];
+
+        if (!mayBeSet(state, internalOffsets[INT_ENA + it])) continue;
+
+        if (m_writeMode == WriteMode::NO_CHANGE && writes(it)) {
+            state.copyRange(readOffset, state, outputOffsets[OUT_DOUTA + port], m_wordWidth);
+            continue;
+        }
+
+        if (!sim::allDefinedNonStraddling(state, internalOffsets[INT_ADDRA + it], addrWidth)) {
+            state.clearRange(sim::DefaultConfig::DEFINED, readOffset, m_wordWidth);
+            continue;
+        }
+        size_t address = state.extractNonStraddling(sim::DefaultConfig::VALUE, internalOffsets[INT_ADDRA + it], addrWidth);
+        if (address >= m_numWords) {
+            state.clearRange(sim::DefaultConfig::DEFINED, readOffset, m_wordWidth);
+            continue;
+        }
+        state.copyRange(readOffset, state, internalOffsets[INT_MEMORY] + address * m_wordWidth, m_wordWidth);
+
+        if (m_writeMode == WriteMode::WRITE_FIRST && writes(it))
+            for (auto lane : utils::Range(numLanes)) {
+                size_t weOffset = internalOffsets[INT_WEA + it] + lane;
+                if (!state.get(sim::DefaultConfig::DEFINED, weOffset))
+                    state.clearRange(sim::DefaultConfig::DEFINED, readOffset + lane * m_byteWidth, m_byteWidth);
+                else if (state.get(sim::DefaultConfig::VALUE, weOffset))
+                    state.copyRange(readOffset + lane * m_byteWidth, state, internalOffsets[INT_DINA + it] + lane * m_byteWidth, m_byteWidth);
+            }
+
+        // Reading what the other port writes in the same cycle is undefined.
+        if (writes(otherIt)) {
+            bool otherAddrDefined = sim::allDefinedNonStraddling(state, internalOffsets[INT_ADDRA + otherIt], addrWidth);
+            if (!otherAddrDefined || state.extractNonStraddling(sim::DefaultConfig::VALUE, internalOffsets[INT_ADDRA + otherIt], addrWidth) == address)
+                state.clearRange(sim::DefaultConfig::DEFINED, readOffset, m_wordWidth);
+        }
+    }
+}
+
+void XilinxTrueDualPortBlockRam::simulateAdvance(sim::SimulatorCallbacks &simCallbacks, sim::DefaultBitVectorState &state, const size_t *internalOffsets, const size_t *outputOffsets, size_t clockPort) const
+{
+    const size_t numLanes = getNumLanes();
+    const size_t addrWidth = getAddressWidth();
+    const size_t port = clockPort;
+    const size_t it = port * INT_PORT_STRIDE;
+    const size_t otherIt = (1 - port) * INT_PORT_STRIDE;
+
+    size_t enOffset = internalOffsets[INT_ENA + it];
+    if (!mayBeSet(state, enOffset)) return;
+
+    if (!state.get(sim::DefaultConfig::DEFINED, enOffset))
+        state.clearRange(sim::DefaultConfig::DEFINED, outputOffsets[OUT_DOUTA + port], m_wordWidth);
+    else
+        state.copyRange(outputOffsets[OUT_DOUTA + port], state, internalOffsets[INT_READA + it], m_wordWidth);
+
+    bool anyLaneWritten = false;
+    for (auto lane : utils::Range(numLanes))
+        anyLaneWritten |= mayBeSet(state, internalOffsets[INT_WEA + it] + lane);
+    if (!anyLaneWritten) return;
+
+    if (!sim::allDefinedNonStraddling(state, internalOffsets[INT_ADDRA + it], addrWidth)) {
+        state.clearRange(sim::DefaultConfig::DEFINED, internalOffsets[INT_MEMORY], m_numWords * m_wordWidth);
+        return;
+    }
+    size_t address = state.extractNonStraddling(sim::DefaultConfig::VALUE, internalOffsets[INT_ADDRA + it], addrWidth);
+    if (address >= m_numWords) return;
+
+    // Lanes that the other port writes to the same address in the same cycle become undefined.
+    bool otherCollides = false;
+    if (mayBeSet(state, internalOffsets[INT_ENA + otherIt]) && m_clocks[CLK_A] == m_clocks[CLK_B]) {
+        bool otherAddrDefined = sim::allDefinedNonStraddling(state, internalOffsets[INT_ADDRA + otherIt], addrWidth);
+        otherCollides = !otherAddrDefined || state.extractNonStraddling(sim::DefaultConfig::VALUE, internalOffsets[INT_ADDRA + otherIt], addrWidth) == address;
+    }
+
+    size_t wordOffset = internalOffsets[INT_MEMORY] + address * m_wordWidth;
+    for (auto lane : utils::Range(numLanes)) {
+        size_t weOffset = internalOffsets[INT_WEA + it] + lane;
+        if (!mayBeSet(state, weOffset)) continue;
+
+        bool undefinedWrite = !state.get(sim::DefaultConfig::DEFINED, enOffset) || !state.get(sim::DefaultConfig::DEFINED, weOffset);
+        if (otherCollides && mayBeSet(state, internalOffsets[INT_WEA + otherIt] + lane))
+            undefinedWrite = true;
+
+        if (undefinedWrite)
+            state.clearRange(sim::DefaultConfig::DEFINED, wordOffset + lane * m_byteWidth, m_byteWidth);
+        else
+            state.copyRange(wordOffset + lane * m_byteWidth, state, internalOffsets[INT_DINA + it] + lane * m_byteWidth, m_byteWidth);
+    }
+}
+
+std::string XilinxTrueDualPortBlockRam::getTypeName() const
+{
+    return "XilinxTrueDualPortBlockRam";
+}
+
+void XilinxTrueDualPortBlockRam::assertValidity() const
+{
+}
+
+std::string XilinxTrueDualPortBlockRam::getInputName(size_t idx) const
+{
+    switch (idx) {
+        case IN_ENA: return "ena";
+        case IN_WEA: return "wea";
+        case IN_ADDRA: return "addra";
+        case IN_DINA: return "dina";
+        case IN_REGCEA: return "regcea";
+        case IN_INJECTSBITERRA: return "injectsbiterra";
+        case IN_INJECTDBITERRA: return "injectdbiterra";
+        case IN_ENB: return "enb";
+        case IN_WEB: return "web";
+        case IN_ADDRB: return "addrb";
+        case IN_DINB: return "dinb";
+        case IN_REGCEB: return "regceb";
+        case IN_INJECTSBITERRB: return "injectsbiterrb";
+        case IN_INJECTDBITERRB: return "injectdbiterrb";
+        case IN_SLEEP: return "sleep";
+        default: return "";
+    }
+}
+
+std::string XilinxTrueDualPortBlockRam::getOutputName(size_t idx) const
+{
+    switch (idx) {
+        case OUT_DOUTA: return "douta";
+        case OUT_DOUTB: return "doutb";
+        default: return "invalid";
+    }
+}
+
+std::vector<size_t> XilinxTrueDualPortBlockRam::getInternalStateSizes() const
+{
+    std::vector<size_t> sizes(INT_COUNT);
+    sizes[INT_MEMORY] = m_numWords * m_wordWidth;
+    for (auto port : utils::Range<size_t>(PORT_COUNT)) {
+        size_t it = port * INT_PORT_STRIDE;
+        sizes[INT_ENA + it] = 1;
+        sizes[INT_WEA + it] = getNumLanes();
+        sizes[INT_ADDRA + it] = getAddressWidth();
+        sizes[INT_DINA + it] = m_wordWidth;
+        sizes[INT_READA + it] = m_wordWidth;
+    }
+    return sizes;
+}
+
+std::unique_ptr<hlim::BaseNode> XilinxTrueDualPortBlockRam::cloneUnconnected() const
+{
+    XilinxTrueDualPortBlockRam *ptr;
+    std::unique_ptr<BaseNode> res(ptr = new XilinxTrueDualPortBlockRam(m_numWords, m_wordWidth, m_byteWidth, m_writeMode));
+    copyBaseToClone(res.get());
+
+    ptr->m_libraryName = m_libraryName;
+    ptr->m_name = m_name;
+    ptr->m_genericParameters = m_genericParameters;
+    ptr->m_initialData = m_initialData;
+
+    return res;
+}
+
+}
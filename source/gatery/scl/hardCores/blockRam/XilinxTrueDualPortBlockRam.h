@@ -0,0 +1,133 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#pragma once
+
+#include <gatery/hlim/supportNodes/Node_External.h>
+#include <gatery/simulation/BitVectorState.h>
+
+#include <gatery/frontend.h>
+
+namespace gtry::scl::blockram {
+
+/**
+ * @brief True dual port block ram with optional byte wide write enables, exported as an instance of the xpm_memory_tdpram macro.
+ * @details Both ports can read and write with a read latency of one cycle. Accesses of both ports to the same address in the same cycle,
+ * where at least one of them writes, yield undefined data in the simulation.
+ */
+class XilinxTrueDualPortBlockRam : public hlim::Node_External
+{
+    public:
+        enum class WriteMode {
+            READ_FIRST,
+            WRITE_FIRST,
+            NO_CHANGE
+        };
+
+        enum Port {
+            PORT_A,
+            PORT_B,
+            PORT_COUNT
+        };
+
+        enum Clocks {
+            CLK_A,
+            CLK_B,
+            CLK_COUNT
+        };
+
+        enum Inputs {
+            IN_ENA,
+            IN_WEA,
+            IN_ADDRA,
+            IN_DINA,
+            IN_REGCEA,
+            IN_INJECTSBITERRA,
+            IN_INJECTDBITERRA,
+            IN_ENB,
+            IN_WEB,
+            IN_ADDRB,
+            IN_DINB,
+            IN_REGCEB,
+            IN_INJECTSBITERRB,
+            IN_INJECTDBITERRB,
+            IN_SLEEP,
+            IN_COUNT
+        };
+        enum Outputs {
+            OUT_DOUTA,
+            OUT_DOUTB,
+            OUT_COUNT
+        };
+
+        /// @param byteWidth Width of the lanes that can be written individually, zero for full word writes.
+        XilinxTrueDualPortBlockRam(size_t numWords, size_t wordWidth, size_t byteWidth = 0, WriteMode writeMode = WriteMode::WRITE_FIRST);
+
+        void setInitialData(sim::DefaultBitVectorState initialData);
+        void setClocks(hlim::Clock *clockA, hlim::Clock *clockB);
+
+        /// Connects all inputs of one port, writeEnable has one bit per lane.
+        void connectPort(Port port, const Bit &enable, const BVec &writeEnable, const BVec &address, const BVec &writeData);
+        BVec getReadData(Port port);
+
+        inline size_t getNumWords() const { return m_numWords; }
+        inline size_t getWordWidth() const { return m_wordWidth; }
+        inline size_t getByteWidth() const { return m_byteWidth; }
+        inline size_t getNumLanes() const { return m_wordWidth / m_byteWidth; }
+        inline size_t getAddressWidth() const { return utils::Log2C(m_numWords); }
+        inline const sim::DefaultBitVectorState &getInitialData() const { return m_initialData; }
+
+        virtual void simulateReset(sim::SimulatorCallbacks &simCallbacks, sim::DefaultBitVectorState &state, const size_t *internalOffsets, const size_t *outputOffsets) const override;
+        virtual void simulateEvaluate(sim::SimulatorCallbacks &simCallbacks, sim::DefaultBitVectorState &state, const size_t *internalOffsets, const size_t *inputOffsets, const size_t *outputOffsets) const override;
+        virtual void simulateAdvance(sim::SimulatorCallbacks &simCallbacks, sim::DefaultBitVectorState &state, const size_t *internalOffsets, const size_t *outputOffsets, size_t clockPort) const override;
+
+        virtual std::string getTypeName() const override;
+        virtual void assertValidity() const override;
+        virtual std::string getInputName(size_t idx) const override;
+        virtual std::string getOutputName(size_t idx) const override;
+        virtual std::vector<size_t> getInternalStateSizes() const override;
+
+        virtual std::unique_ptr<BaseNode> cloneUnconnected() const override;
+    protected:
+        enum Internal {
+            INT_MEMORY,
+            INT_ENA,
+            INT_WEA,
+            INT_ADDRA,
+            INT_DINA,
+            INT_READA,
+            INT_ENB,
+            INT_WEB,
+            INT_ADDRB,
+            INT_DINB,
+            INT_READB,
+            INT_COUNT
+        };
+        /// Offset between the internal states of port A and port B.
+        static constexpr size_t INT_PORT_STRIDE = INT_ENB - INT_ENA;
+        static constexpr size_t IN_PORT_STRIDE = IN_ENB - IN_ENA;
+
+        size_t m_numWords;
+        size_t m_wordWidth;
+        size_t m_byteWidth;
+        WriteMode m_writeMode;
+        sim::DefaultBitVectorState m_initialData;
+
+        void updateGenericParameters();
+};
+
+}
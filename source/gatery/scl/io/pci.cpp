@@ -45,20 +45,22 @@ gtry::Bit gtry::scl::pci::isDataTlp(const BVec& tlpHeader)
 	return data_tlp;
 }
 
-gtry::scl::pci::AvmmBridge::AvmmBridge(Stream<Tlp>& rx, AvalonMM& avmm, const PciId& cplId) :
+gtry::scl::pci::AvmmBridge::AvmmBridge(Stream<Tlp>& rx, AvalonMM& avmm, const PciId& cplId, size_t readCompletionBoundary, size_t maxPayloadSize) :
 	AvmmBridge()
 {
-	setup(rx, avmm, cplId);
+	setup(rx, avmm, cplId, readCompletionBoundary, maxPayloadSize);
 }
 
-void gtry::scl::pci::AvmmBridge::setup(Stream<Tlp>& rx, AvalonMM& avmm, const PciId& cplId)
+void gtry::scl::pci::AvmmBridge::setup(Stream<Tlp>& rx, AvalonMM& avmm, const PciId& cplId, size_t readCompletionBoundary, size_t maxPayloadSize)
 {
 	HCL_DESIGNCHECK_HINT(rx.header.getWidth() == 96_b, "reduce tlp header address using discardHighAddressBits");
+	HCL_DESIGNCHECK_HINT(readCompletionBoundary == 64 || readCompletionBoundary == 128, "the read completion boundary is either 64 or 128 byte");
+	HCL_DESIGNCHECK_HINT(utils::nextPow2(maxPayloadSize) == maxPayloadSize && maxPayloadSize >= 128 && maxPayloadSize <= 4096, "the max payload size is a power of two from 128 to 4096 byte");
 	m_cplId = cplId;
-	generateFifoBridge(rx, avmm);
+	generateFifoBridge(rx, avmm, readCompletionBoundary, maxPayloadSize);
 }
 
-void gtry::scl::pci::AvmmBridge::generateFifoBridge(Stream<Tlp>& rx, AvalonMM& avmm)
+void gtry::scl::pci::AvmmBridge::generateFifoBridge(Stream<Tlp>& rx, AvalonMM& avmm, size_t readCompletionBoundary, size_t maxPayloadSize)
 {
 	HCL_DESIGNCHECK(avmm.readData->getWidth() == 32_b);
 
@@ -66,22 +68,120 @@ void gtry::scl::pci::AvmmBridge::generateFifoBridge(Stream<Tlp>& rx, AvalonMM& a
 
 	sim_assert(!*rx.valid | rx.header(TlpOffset::type) == 0) << "not a memory tlp";
 
+	// a completion covers at most one burst, so bursts are limited to the max payload size
+	const size_t maxAvmmBurst = avmm.burstCount ? 1ull << (avmm.burstCount->size() - 1) : 1;
+	HCL_DESIGNCHECK_HINT(maxAvmmBurst <= 1024, "bursts are limited to the maximum tlp length");
+	const size_t maxBurst = std::min(maxAvmmBurst, maxPayloadSize / 4);
+	const size_t cplWords = std::max(maxBurst, readCompletionBoundary / 4);
+
+	Bit isWrite = isDataTlp(rx.header);
+	HCL_NAMED(isWrite);
+
+	// tlp length in words, 0 encodes 1024
+	BVec length = zext(rx.header(0, 10_b), 2);
+	IF(length == 0)
+		length = 1024;
+	HCL_NAMED(length);
+
+	// words of the current tlp already issued
+	BVec offset = 11_b;
+	BVec start = zext(rx.header(66, 11_b), 1);
+	BVec current = start + zext(offset, 1);
+	HCL_NAMED(current);
+
+	// tlp relative offset of the block of the given size around the current word, clipped to the tlp
+	auto blockBoundary = [&](size_t words, bool end) {
+		BVec boundary = current;
+		if (words > 1)
+			boundary(0, BitWidth::count(words)) = 0;
+		if (end)
+			boundary += words;
+		boundary -= start;
+		IF(boundary.msb())
+			boundary = 0;
+		IF(boundary > length)
+			boundary = length;
+		return boundary;
+	};
+
+	BVec burstStart = blockBoundary(maxBurst, false);
+	BVec burstEnd = blockBoundary(maxBurst, true);
+	BVec cplStart = blockBoundary(cplWords, false);
+	BVec cplEnd = blockBoundary(cplWords, true);
+	HCL_NAMED(burstStart);
+	HCL_NAMED(burstEnd);
+	HCL_NAMED(cplStart);
+	HCL_NAMED(cplEnd);
+
+	BVec remaining = length - burstStart;
+	BVec burst = burstEnd - burstStart;
+	HCL_NAMED(burst);
+
+	Bit lastBeat = burstEnd == length;
+	IF(isWrite)
+		lastBeat = zext(offset, 1) + 1 == length;
+	HCL_NAMED(lastBeat);
+
 	// decode command
 	avmm.address = rx.header(64, 32_b);
 	avmm.address(0, 2_b) = 0;
-
-	avmm.write = rx.transfer() & isDataTlp(rx.header);
-	avmm.read = rx.transfer() & !*avmm.write;
-	avmm.writeData = rx.data;
+	avmm.address += zext(pack(burstStart, "b00"), 32 - 14);
+	if (avmm.burstCount)
+		*avmm.burstCount = burst(0, avmm.burstCount->getWidth());
 
 	// store cpl data for command
 	size_t pipelineDepth = std::max<size_t>(avmm.maximumPendingReadTransactions, 1);
 	Fifo<MemTlpCplData> resQueue{ pipelineDepth , MemTlpCplData{} };
-	
+
+	// writes are held with the reads so that rx only advances on issued words
+	Bit issueReady = !resQueue.full();
+
+	// a completion can span several bursts, which are limited separately
+	Bit burstDone;
+	BVec pendingBursts = BitWidth::last(pipelineDepth);
+	if (cplWords > maxBurst)
+		issueReady &= pendingBursts != pipelineDepth;
+	HCL_NAMED(issueReady);
+
+	avmm.write = *rx.valid & isWrite & issueReady;
+	avmm.read = *rx.valid & !isWrite & issueReady;
+	avmm.writeData = rx.data;
+
+	Bit accepted = *avmm.read | *avmm.write;
+	if (avmm.ready)
+		accepted &= *avmm.ready;
+	HCL_NAMED(accepted);
+
+	if (cplWords > maxBurst)
+	{
+		IF(accepted & *avmm.read)
+			pendingBursts += 1;
+		IF(burstDone)
+			pendingBursts -= 1;
+		pendingBursts = reg(pendingBursts, 0);
+		HCL_NAMED(pendingBursts);
+	}
+
+	IF(accepted)
+	{
+		IF(isWrite)
+			offset += 1;
+		ELSE
+			offset = burstEnd(0, 11_b);
+		IF(lastBeat)
+			offset = 0;
+	}
+	offset = reg(offset, 0);
+	HCL_NAMED(offset);
+
 	MemTlpCplData req;
 	req.decode(rx.header);
+	req.lowerAddress = avmm.address(0, 7_b);
+	req.length = (cplEnd - burstStart)(0, 10_b);
+	BVec remainingBytes = pack(remaining, "b00");
+	req.byteCount = remainingBytes(0, 12_b);
 	HCL_NAMED(req);
-	resQueue.push(req, *avmm.read);
+	resQueue.push(req, accepted & *avmm.read & burstStart == cplStart);
 
 	// create tx tlp
 	avmm.createReadDataValid();
@@ -90,15 +190,47 @@ void gtry::scl::pci::AvmmBridge::generateFifoBridge(Stream<Tlp>& rx, AvalonMM& a
 	m_tx.header(48, 16_b) = pack(m_cplId);
 	m_tx.data = *avmm.readData;
 
-	// join response and cpl data
+	// join response and cpl data, one completion per read completion boundary
 	MemTlpCplData res;
-	resQueue.pop(res, *m_tx.valid);
+	BVec cplBeat = 10_b;
+	m_tx.sop = cplBeat == 0;
+	m_tx.eop = cplBeat + 1 == res.length;
+	resQueue.pop(res, *m_tx.valid & *m_tx.eop);
 	res.encode(m_tx.header);
 
-	*rx.ready = !resQueue.full();
+	// bursts end at the end of a completion or at the burst alignment
+	burstDone = *m_tx.valid & *m_tx.eop;
+	if (cplWords > maxBurst)
+	{
+		BVec word = res.lowerAddress(2, 5_b) + cplBeat(0, 5_b);
+		HCL_NAMED(word);
+		if (maxBurst == 1)
+		{
+			burstDone = *m_tx.valid;
+		}
+		else
+		{
+			IF(*m_tx.valid & word(0, BitWidth::count(maxBurst)) == maxBurst - 1)
+				burstDone = '1';
+		}
+	}
+	HCL_NAMED(burstDone);
+
+	IF(*m_tx.valid)
+	{
+		cplBeat += 1;
+		IF(*m_tx.eop)
+			cplBeat = 0;
+	}
+	cplBeat = reg(cplBeat, 0);
+	HCL_NAMED(cplBeat);
+
+	*rx.ready = issueReady;
 	if (avmm.ready)
 		*rx.ready &= *avmm.ready;
-
+	// a read tlp is held until its last burst was issued, write tlps advance with every word
+	IF(*rx.valid & !isWrite & !lastBeat)
+		*rx.ready = '0';
 }
 
 gtry::scl::pci::Tlp gtry::scl::pci::Tlp::discardHighAddressBits() const
@@ -124,6 +256,8 @@ void gtry::scl::pci::MemTlpCplData::decode(const BVec& tlpHdr)
 	attr.relaxedOrdering = tlpHdr[13];
 	attr.noSnoop = tlpHdr[12];
 	lowerAddress = pack(tlpHdr(66, 5_b), "b00");
+	length = tlpHdr(0, 10_b);
+	byteCount = pack(tlpHdr(0, 10_b), "b00");
 
 	tag = tlpHdr(40, 8_b);
 	requester.func = tlpHdr(48, 3_b);
@@ -139,6 +273,8 @@ void gtry::scl::pci::MemTlpCplData::encode(BVec& tlpHdr) const
 	tlpHdr[12] = attr.noSnoop;
 
 	tlpHdr(64, 32_b) = pack(requester.bus, requester.dev, requester.func, tag, '0', lowerAddress);
+	tlpHdr(0, 10_b) = length;
+	tlpHdr(32, 12_b) = byteCount;
 }
 
 void gtry::scl::pci::IntelPTileCompleter::generate()
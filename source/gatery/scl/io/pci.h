@@ -47,6 +47,10 @@ namespace gtry::scl
 			BVec tag = 8_b;
 			TlpHeaderAttr attr;
 			BVec lowerAddress = 7_b;
+			/// Payload words of the completion, 0 encodes 1024.
+			BVec length = 10_b;
+			/// Bytes remaining to complete the request including this completion, 0 encodes 4096.
+			BVec byteCount = 12_b;
 
 			void decode(const BVec& tlpHdr);
 			void encode(BVec& tlpHdr) const;
@@ -77,18 +81,27 @@ namespace gtry::scl
 		Bit isMemTlp(const BVec& tlpHeader);
 		Bit isDataTlp(const BVec& tlpHeader);
 
+		/**
+		 * @brief Executes memory request TLPs on an AvalonMM master and returns read completions.
+		 * @details Requests arrive one word per beat, a write TLP spans one beat per payload word and the header must be held for all of them.
+		 * If the AvalonMM interface has a burst count, writes and reads are issued as bursts, otherwise as single words.
+		 * Bursts are split at multiples of the maximum burst of the absolute address, and are limited to the max payload size so that no completion exceeds it.
+		 * A read is answered by one completion per read completion boundary (64 or 128 byte) or per burst, whichever is larger,
+		 * so every completion but the last ends on a naturally aligned boundary.
+		 * Up to maximumPendingReadTransactions bursts with their tags are in flight. Completions are emitted one word per beat with sop and eop.
+		 */
 		class AvmmBridge
 		{
 		public:
 			AvmmBridge() = default;
-			AvmmBridge(Stream<Tlp>& rx, AvalonMM& avmm, const PciId& cplId);
+			AvmmBridge(Stream<Tlp>& rx, AvalonMM& avmm, const PciId& cplId, size_t readCompletionBoundary = 64, size_t maxPayloadSize = 128);
 
-			void setup(Stream<Tlp>& rx, AvalonMM& avmm, const PciId& cplId);
+			void setup(Stream<Tlp>& rx, AvalonMM& avmm, const PciId& cplId, size_t readCompletionBoundary = 64, size_t maxPayloadSize = 128);
 
 			Stream<Tlp>& tx() { return m_tx; }
 
 		protected:
-			void generateFifoBridge(Stream<Tlp>& rx, AvalonMM& avmm);
+			void generateFifoBridge(Stream<Tlp>& rx, AvalonMM& avmm, size_t readCompletionBoundary, size_t maxPayloadSize);
 
 		private:
 			Stream<Tlp> m_tx;
@@ -109,5 +122,5 @@ namespace gtry::scl
 
 BOOST_HANA_ADAPT_STRUCT(gtry::scl::pci::PciId, bus, dev, func);
 BOOST_HANA_ADAPT_STRUCT(gtry::scl::pci::TlpHeaderAttr, trafficClass, relaxedOrdering, idBasedOrdering, noSnoop);
-BOOST_HANA_ADAPT_STRUCT(gtry::scl::pci::MemTlpCplData, requester, tag, attr, lowerAddress);
+BOOST_HANA_ADAPT_STRUCT(gtry::scl::pci::MemTlpCplData, requester, tag, attr, lowerAddress, length, byteCount);
 BOOST_HANA_ADAPT_STRUCT(gtry::scl::pci::Tlp, prefix, header, data);
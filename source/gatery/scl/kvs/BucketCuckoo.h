@@ -0,0 +1,139 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#pragma once
+#include <gatery/frontend.h>
+#include "../memoryMap/MemoryMap.h"
+
+namespace gtry::scl
+{
+	/**
+	 * @brief Cuckoo hash table with several slots per bucket.
+	 * @details Every table row holds a bucket of slotsPerBucket items which is read in one wide memory access and
+	 * compared in parallel. With 4 slots and two tables, occupancies above 90% are reachable with short displacement chains.
+	 * The tables are written through the cpu interface, one bucket at a time, see BucketCuckooDriver.h.
+	 */
+	template<typename Tkey, typename Tval>
+	class BucketCuckoo
+	{
+	public:
+		struct Out
+		{
+			BOOST_HANA_DEFINE_STRUCT(Out,
+				(Bit, found),
+				(Tval, value)
+			);
+		};
+
+		struct Item
+		{
+			BOOST_HANA_DEFINE_STRUCT(Item,
+				(Bit, valid),
+				(Tkey, key),
+				(Tval, value)
+			);
+		};
+
+		using Bucket = std::vector<Item>;
+
+	public:
+		BucketCuckoo(size_t capacity, const Tkey& key, const Tval& val, size_t numTables = 2, size_t slotsPerBucket = 4);
+
+		BitWidth hashWidth() const;
+		size_t numTables() const { return m_tables.size(); }
+		size_t slotsPerBucket() const { return m_slotsPerBucket; }
+		Out operator () (const Tkey& key, const BVec& hash);
+
+		void addCpuInterface(MemoryMap& mmap);
+
+	protected:
+		size_t m_slotsPerBucket;
+		std::vector<Memory<Bucket>> m_tables;
+	};
+
+	extern template class BucketCuckoo<BVec, BVec>;
+
+	template<typename Tkey, typename Tval>
+	inline BucketCuckoo<Tkey, Tval>::BucketCuckoo(size_t capacity, const Tkey& key, const Tval& val, size_t numTables, size_t slotsPerBucket) :
+		m_slotsPerBucket(slotsPerBucket)
+	{
+		HCL_DESIGNCHECK(numTables);
+		HCL_DESIGNCHECK(slotsPerBucket);
+		HCL_DESIGNCHECK_HINT(capacity % (numTables * slotsPerBucket) == 0, "The capacity must be a multiple of the bucket size times the number of tables.");
+
+		Item it{
+			.valid = '0',
+			.key = key,
+			.value = val
+		};
+
+		m_tables.resize(numTables);
+		for (Memory<Bucket>& mem : m_tables)
+		{
+			mem.setup(capacity / numTables / slotsPerBucket, Bucket(slotsPerBucket, it));
+			mem.setType(MemType::BRAM);
+			mem.setPowerOnStateZero();
+		}
+	}
+
+	template<typename Tkey, typename Tval>
+	inline BitWidth BucketCuckoo<Tkey, Tval>::hashWidth() const
+	{
+		return m_tables[0].addressWidth() * m_tables.size();
+	}
+
+	template<typename Tkey, typename Tval>
+	inline typename BucketCuckoo<Tkey, Tval>::Out BucketCuckoo<Tkey, Tval>::operator()(const Tkey& key, const BVec& hash)
+	{
+		GroupScope entity(GroupScope::GroupType::ENTITY);
+		entity.setName("BucketCuckoo_lookup");
+
+		SymbolSelect hashSel{ hash.size() / m_tables.size() };
+
+		Out ret;
+		ret.found = '0';
+		ret.value = constructFrom(m_tables[0].defaultValue().front().value);
+		ret.value = 0;
+
+		for (size_t t = 0; t < m_tables.size(); ++t)
+		{
+			GroupScope entity(GroupScope::GroupType::ENTITY);
+			entity.setName("table");
+
+			Bucket bucket = m_tables[t][hash(hashSel[t])];
+			HCL_NAMED(bucket);
+
+			for (const Item& item : bucket)
+			{
+				IF(item.valid & item.key == key)
+				{
+					ret.value = item.value;
+					ret.found = '1';
+				}
+			}
+			HCL_NAMED(ret);
+		}
+		return ret;
+	}
+
+	template<typename Tkey, typename Tval>
+	inline void BucketCuckoo<Tkey, Tval>::addCpuInterface(MemoryMap& mmap)
+	{
+		mmap.stage(m_tables);
+	}
+
+}
@@ -0,0 +1,393 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#include "BucketCuckooDriver.h"
+
+#include <string.h>
+
+#define HASH_WORDS_LIMIT 16
+#define SEARCH_NO_PARENT 0xFFFFFFFFu
+
+static uint32_t Log2(uint32_t v)
+{
+	uint32_t ret = 0;
+	while (v >>= 1)
+		++ret;
+	return ret;
+}
+
+static uint32_t Log2C(uint32_t v)
+{
+	if (v == 1)
+		return 0;
+	return Log2(v - 1) + 1;
+}
+
+static uint32_t extract_bit_range(uint32_t* field, uint32_t index, uint32_t elementWidth)
+{
+	uint32_t offset = index * elementWidth;
+
+	uint32_t low = field[offset / 32];
+	uint32_t high = field[offset / 32 + 1];
+
+	uint32_t ret = 0;
+	ret |= low >> (offset % 32);
+	if(offset % 32 != 0)
+		ret |= high << (32 - offset % 32);
+	ret &= (1ull << elementWidth) - 1;
+	return ret;
+}
+
+static void bucket_cuckoo_mmwrite_dummy(void* ctx, uint32_t offset, uint32_t value) {}
+
+static size_t bucket_cuckoo_table_words(uint32_t capacity, size_t itemWords)
+{
+	return itemWords * capacity;
+}
+
+BucketCuckooContext* bucket_cuckoo_init(
+	uint32_t capacity, uint32_t numTables, uint32_t slotsPerBucket,
+	uint32_t keyWidth, size_t valueWidth,
+	void* (*allocator_proc)(size_t size), void (*free_proc)(void*, size_t)
+)
+{
+	size_t keyWords = (keyWidth + 31) / 32;
+	size_t valueWords = (valueWidth + 31) / 32;
+	size_t itemWords = 1 + keyWords + valueWords;
+	size_t tableWords = bucket_cuckoo_table_words(capacity, itemWords);
+	uint32_t bucketsPerTable;
+	BucketCuckooContext* ctx;
+
+	if (!numTables || !slotsPerBucket || capacity % (numTables * slotsPerBucket))
+		return NULL;
+
+	// the hardware addresses buckets with the plain hash bits
+	bucketsPerTable = capacity / numTables / slotsPerBucket;
+	if (bucketsPerTable & (bucketsPerTable - 1))
+		return NULL;
+
+	ctx = allocator_proc(sizeof(BucketCuckooContext) + tableWords * 4);
+	if (!ctx)
+		return NULL;
+
+	memset(ctx, 0, sizeof(BucketCuckooContext) + tableWords * 4);
+	ctx->alloc = allocator_proc;
+	ctx->free = free_proc;
+	ctx->hash = NULL;
+	ctx->hashCtx = 0;
+
+	ctx->capacity = capacity;
+	ctx->bucketsPerTable = bucketsPerTable;
+	ctx->numTables = (uint16_t)numTables;
+	ctx->slotsPerBucket = (uint16_t)slotsPerBucket;
+	ctx->keyWords = (uint16_t)keyWords;
+	ctx->valueWords = (uint16_t)valueWords;
+	ctx->itemWords = (uint16_t)itemWords;
+
+	ctx->mmCtx = NULL;
+	ctx->mmwrite = &bucket_cuckoo_mmwrite_dummy;
+
+	ctx->hashBitPerTable = (uint16_t)Log2C(bucketsPerTable);
+	ctx->hashWords = (ctx->hashBitPerTable * ctx->numTables + 31) / 32;
+
+	if (ctx->hashWords > HASH_WORDS_LIMIT)
+	{
+		free_proc(ctx, sizeof(BucketCuckooContext) + tableWords * 4);
+		return NULL;
+	}
+
+	bucket_cuckoo_set_limits(ctx, 1024, 8);
+	if (!ctx->search)
+	{
+		free_proc(ctx, sizeof(BucketCuckooContext) + tableWords * 4);
+		return NULL;
+	}
+
+	return ctx;
+}
+
+void bucket_cuckoo_destroy(BucketCuckooContext* ctx)
+{
+	if (ctx->search)
+		ctx->free(ctx->search, ctx->limitSearchBuckets * sizeof(BucketCuckooSearchNode));
+	ctx->free(ctx, sizeof(BucketCuckooContext) + bucket_cuckoo_table_words(ctx->capacity, ctx->itemWords) * 4);
+}
+
+void bucket_cuckoo_set_hash(BucketCuckooContext* ctx, void (*hash_proc)(void*, uint32_t*, uint32_t*), void* userData)
+{
+	ctx->hash = hash_proc;
+	ctx->hashCtx = userData;
+}
+
+void bucket_cuckoo_set_limits(BucketCuckooContext* ctx, uint32_t maxSearchBuckets, uint32_t maxChainDepth)
+{
+	if (maxSearchBuckets < ctx->numTables)
+		maxSearchBuckets = ctx->numTables;
+
+	if (ctx->search)
+		ctx->free(ctx->search, ctx->limitSearchBuckets * sizeof(BucketCuckooSearchNode));
+
+	ctx->search = ctx->alloc(maxSearchBuckets * sizeof(BucketCuckooSearchNode));
+	ctx->limitSearchBuckets = ctx->search ? maxSearchBuckets : 0;
+	ctx->limitChainDepth = maxChainDepth;
+}
+
+void bucket_cuckoo_set_mm(BucketCuckooContext* ctx, void(*mmwrite)(void* ctx, uint32_t offset, uint32_t value), void* userData)
+{
+	if (mmwrite)
+	{
+		ctx->mmCtx = userData;
+		ctx->mmwrite = mmwrite;
+	}
+	else
+	{
+		ctx->mmCtx = NULL;
+		ctx->mmwrite = &bucket_cuckoo_mmwrite_dummy;
+	}
+}
+
+uint32_t bucket_cuckoo_get_hashwidth(BucketCuckooContext* ctx)
+{
+	return ctx->numTables * ctx->hashBitPerTable;
+}
+
+static uint32_t bucket_cuckoo_bucket(BucketCuckooContext* ctx, uint32_t table, uint32_t* hash)
+{
+	return table * ctx->bucketsPerTable + extract_bit_range(hash, table, ctx->hashBitPerTable);
+}
+
+static BucketCuckooItem* bucket_cuckoo_item(BucketCuckooContext* ctx, uint32_t bucket, uint32_t slot)
+{
+	return (BucketCuckooItem*)(ctx->items + ((size_t)bucket * ctx->slotsPerBucket + slot) * ctx->itemWords);
+}
+
+static void bucket_cuckoo_bucket_write(BucketCuckooContext* ctx, uint32_t bucket)
+{
+	uint32_t slot, i;
+	uint32_t* item;
+
+	// the staging registers hold all slots of a bucket, key and value of invalid slots are don't care
+	for (slot = 0; slot < ctx->slotsPerBucket; ++slot)
+	{
+		item = (uint32_t*)bucket_cuckoo_item(ctx, bucket, slot);
+		ctx->mmwrite(ctx->mmCtx, 1 + slot * ctx->itemWords, item[0]);
+		if (item[0])
+			for (i = 1; i < ctx->itemWords; ++i)
+				ctx->mmwrite(ctx->mmCtx, 1 + slot * ctx->itemWords + i, item[i]);
+	}
+	ctx->mmwrite(ctx->mmCtx, 0, bucket); // push to block ram cmd
+}
+
+static BucketCuckooItem* bucket_cuckoo_find(BucketCuckooContext* ctx, uint32_t* key, uint32_t* hash, uint32_t* bucket)
+{
+	uint32_t t, slot, b;
+	BucketCuckooItem* item;
+
+	for (t = 0; t < ctx->numTables; ++t)
+	{
+		b = bucket_cuckoo_bucket(ctx, t, hash);
+		for (slot = 0; slot < ctx->slotsPerBucket; ++slot)
+		{
+			item = bucket_cuckoo_item(ctx, b, slot);
+			if (item->valid && !memcmp(item->key, key, ctx->keyWords * 4ull))
+			{
+				if (bucket)
+					*bucket = b;
+				return item;
+			}
+		}
+	}
+	return NULL;
+}
+
+static int bucket_cuckoo_free_slot(BucketCuckooContext* ctx, uint32_t bucket)
+{
+	uint32_t slot;
+	for (slot = 0; slot < ctx->slotsPerBucket; ++slot)
+		if (!bucket_cuckoo_item(ctx, bucket, slot)->valid)
+			return (int)slot;
+	return -1;
+}
+
+static int bucket_cuckoo_on_path(BucketCuckooContext* ctx, uint32_t node, uint32_t bucket)
+{
+	for (; node != SEARCH_NO_PARENT; node = ctx->search[node].parent)
+		if (ctx->search[node].bucket == bucket)
+			return 1;
+	return 0;
+}
+
+static void bucket_cuckoo_store(BucketCuckooContext* ctx, BucketCuckooItem* item, uint32_t* key, uint32_t* value)
+{
+	item->valid = 1;
+	memcpy(item->key, key, ctx->keyWords * 4ull);
+	memcpy(item->key + ctx->keyWords, value, ctx->valueWords * 4ull);
+}
+
+static int bucket_cuckoo_insert(BucketCuckooContext* ctx, uint32_t* key, uint32_t* value, uint32_t* hash)
+{
+	uint32_t itemHash[HASH_WORDS_LIMIT + 1];
+	BucketCuckooSearchNode* search = ctx->search;
+	BucketCuckooSearchNode* node;
+	uint32_t head, tail = 0;
+	uint32_t t, slot, b;
+	int freeSlot;
+
+	for (t = 0; t < ctx->numTables; ++t)
+	{
+		search[tail].bucket = bucket_cuckoo_bucket(ctx, t, hash);
+		search[tail].parent = SEARCH_NO_PARENT;
+		search[tail].slot = 0;
+		search[tail].depth = 0;
+		tail++;
+	}
+
+	// breadth first search for the shortest chain of moves that ends in a free slot
+	for (head = 0; head < tail; ++head)
+	{
+		node = &search[head];
+		freeSlot = bucket_cuckoo_free_slot(ctx, node->bucket);
+		if (freeSlot >= 0)
+		{
+			ctx->lastChainLength = 0;
+			ctx->lastSearchBuckets = tail;
+
+			// move items backwards along the chain, every item stays visible in at least one bucket
+			while (node->parent != SEARCH_NO_PARENT)
+			{
+				BucketCuckooSearchNode* parent = &search[node->parent];
+				memcpy(bucket_cuckoo_item(ctx, node->bucket, (uint32_t)freeSlot), bucket_cuckoo_item(ctx, parent->bucket, node->slot), ctx->itemWords * 4ull);
+				bucket_cuckoo_bucket_write(ctx, node->bucket);
+
+				freeSlot = node->slot;
+				node = parent;
+				ctx->lastChainLength++;
+			}
+
+			bucket_cuckoo_store(ctx, bucket_cuckoo_item(ctx, node->bucket, (uint32_t)freeSlot), key, value);
+			bucket_cuckoo_bucket_write(ctx, node->bucket);
+			return ctx->lastChainLength ? 3 : 2;
+		}
+
+		if (node->depth >= ctx->limitChainDepth)
+			continue;
+
+		for (slot = 0; slot < ctx->slotsPerBucket; ++slot)
+		{
+			ctx->hash(ctx->hashCtx, bucket_cuckoo_item(ctx, node->bucket, slot)->key, itemHash);
+
+			for (t = 0; t < ctx->numTables; ++t)
+			{
+				b = bucket_cuckoo_bucket(ctx, t, itemHash);
+				if (tail == ctx->limitSearchBuckets || bucket_cuckoo_on_path(ctx, head, b))
+					continue;
+
+				search[tail].bucket = b;
+				search[tail].parent = head;
+				search[tail].slot = (uint16_t)slot;
+				search[tail].depth = node->depth + 1;
+				tail++;
+			}
+		}
+	}
+
+	ctx->lastChainLength = 0;
+	ctx->lastSearchBuckets = tail;
+	return 0;
+}
+
+int bucket_cuckoo_update(BucketCuckooContext* ctx, uint32_t* key, uint32_t* value)
+{
+	uint32_t hash[HASH_WORDS_LIMIT + 1];
+	BucketCuckooItem* item;
+	uint32_t bucket;
+
+	if (!ctx->hash)
+		return 0;
+
+	ctx->hash(ctx->hashCtx, key, hash);
+
+	item = bucket_cuckoo_find(ctx, key, hash, &bucket);
+	if (item)
+	{
+		memcpy(item->key + ctx->keyWords, value, ctx->valueWords * 4ull);
+		bucket_cuckoo_bucket_write(ctx, bucket);
+		ctx->lastChainLength = 0;
+		ctx->lastSearchBuckets = 0;
+		return 1;
+	}
+
+	return bucket_cuckoo_insert(ctx, key, value, hash);
+}
+
+uint32_t* bucket_cuckoo_lookup(BucketCuckooContext* ctx, uint32_t* key)
+{
+	uint32_t hash[HASH_WORDS_LIMIT + 1];
+	BucketCuckooItem* item;
+
+	if (!ctx->hash)
+		return NULL;
+
+	ctx->hash(ctx->hashCtx, key, hash);
+	item = bucket_cuckoo_find(ctx, key, hash, NULL);
+	if (!item)
+		return NULL;
+	return &item->key[ctx->keyWords];
+}
+
+int bucket_cuckoo_remove(BucketCuckooContext* ctx, uint32_t* key)
+{
+	uint32_t hash[HASH_WORDS_LIMIT + 1];
+	BucketCuckooItem* item;
+	uint32_t bucket;
+
+	if (!ctx->hash)
+		return 0;
+
+	ctx->hash(ctx->hashCtx, key, hash);
+	item = bucket_cuckoo_find(ctx, key, hash, &bucket);
+	if (item)
+	{
+		item->valid = 0;
+		bucket_cuckoo_bucket_write(ctx, bucket);
+		return 1;
+	}
+	return 0;
+}
+
+void* bucket_cuckoo_iterate(BucketCuckooContext* ctx, void* iterator, uint32_t* key, uint32_t* value)
+{
+	uint32_t* end = ctx->items + bucket_cuckoo_table_words(ctx->capacity, ctx->itemWords);
+	uint32_t* it = iterator;
+
+	if (it)
+		it += ctx->itemWords;
+	else
+		it = ctx->items;
+
+	while (it != end && !*it)
+		it += ctx->itemWords;
+
+	if(it == end)
+		return NULL;
+
+	if (key)
+		memcpy(key, it + 1, ctx->keyWords * 4);
+	if (value)
+		memcpy(value, it + 1 + ctx->keyWords, ctx->valueWords * 4);
+	return it;
+}
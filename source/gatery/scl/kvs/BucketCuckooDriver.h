@@ -0,0 +1,83 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct {
+	uint32_t valid;
+	uint32_t key[1];
+} BucketCuckooItem;
+
+typedef struct {
+	uint32_t bucket;
+	uint32_t parent;
+	uint16_t slot;
+	uint16_t depth;
+} BucketCuckooSearchNode;
+
+typedef struct {
+	uint32_t capacity;
+	uint32_t bucketsPerTable;
+	uint16_t numTables;
+	uint16_t slotsPerBucket;
+	uint16_t keyWords;
+	uint16_t valueWords;
+	uint16_t itemWords;
+	uint16_t hashBitPerTable;
+	uint16_t hashWords;
+
+	uint32_t limitSearchBuckets;
+	uint32_t limitChainDepth;
+
+	// statistics of the last insert: number of items moved and number of buckets visited by the breadth first search
+	uint32_t lastChainLength;
+	uint32_t lastSearchBuckets;
+
+	void* hashCtx;
+	void (*hash)(void* ctx, uint32_t* key, uint32_t* hash_out);
+
+	void* (*alloc)(size_t);
+	void (*free)(void*, size_t);
+
+	void* mmCtx;
+	void (*mmwrite)(void* ctx, uint32_t offset, uint32_t value);
+
+	BucketCuckooSearchNode* search;
+
+	uint32_t items[1];
+} BucketCuckooContext;
+
+BucketCuckooContext* bucket_cuckoo_init(
+	uint32_t capacity, uint32_t numTables, uint32_t slotsPerBucket,
+	uint32_t keyWidth, size_t valueWidth,
+	void* (*allocator_proc)(size_t), void (*free_proc)(void*, size_t)
+);
+void bucket_cuckoo_destroy(BucketCuckooContext* ctx);
+
+void bucket_cuckoo_set_hash(BucketCuckooContext* ctx, void (*hash_proc)(void*, uint32_t*, uint32_t*), void* userData);
+void bucket_cuckoo_set_limits(BucketCuckooContext* ctx, uint32_t maxSearchBuckets, uint32_t maxChainDepth);
+void bucket_cuckoo_set_mm(BucketCuckooContext* ctx, void (*mmwrite)(void* ctx, uint32_t offset, uint32_t value), void* userData);
+uint32_t bucket_cuckoo_get_hashwidth(BucketCuckooContext* ctx);
+
+// returns 1 if the key was updated, 2 if it was inserted into a free slot, 3 if items had to be moved and 0 if the table is full
+int bucket_cuckoo_update(BucketCuckooContext* ctx, uint32_t* key, uint32_t* value);
+uint32_t* bucket_cuckoo_lookup(BucketCuckooContext* ctx, uint32_t* key);
+int bucket_cuckoo_remove(BucketCuckooContext* ctx, uint32_t* key);
+
+void* bucket_cuckoo_iterate(BucketCuckooContext* ctx, void* iterator, uint32_t* key, uint32_t* value);
@@ -18,6 +18,7 @@
 #include "gatery/pch.h"
 #include "TinyCuckoo.h"
 #include "../crypto/SipHash.h"
+#include "../Fifo.h"
 
 #include <gatery/simulation/BitVectorState.h>
 
@@ -72,4 +73,271 @@ namespace gtry::scl
 		return out;
 	}
 
+
+	static void forwardUpdate(TinyCuckooItem& item, const BVec& itemIdx, size_t tableIdx, const TinyCuckooUpdate& update)
+	{
+		IF(update.valid & update.tableIdx == tableIdx & update.itemIdx == itemIdx)
+			item = update.item;
+	}
+
+	TinyCuckooMultiOut tinyCuckooMultiLane(const TinyCuckooMultiIn& in)
+	{
+		GroupScope entity(GroupScope::GroupType::ENTITY);
+		entity.setName("TinyCuckooMultiLane");
+
+		HCL_DESIGNCHECK_HINT(in.numTables > 0, "A cuckoo hash table needs at least one table.");
+		HCL_DESIGNCHECK_HINT(in.readPortsPerMemory > 0, "Every memory needs at least one read port.");
+		HCL_DESIGNCHECK_HINT(!in.insert || in.hash, "Hardware inserts need the hash function to relocate displaced items.");
+
+		const size_t tableWidth = in.tableWidth().value;
+		const size_t numReplicas = std::max<size_t>(1, (in.lookups.size() + in.readPortsPerMemory - 1) / in.readPortsPerMemory);
+		SymbolSelect hashPart{ tableWidth };
+
+		std::vector<std::vector<Memory<TinyCuckooItem>>> tables(in.numTables);
+		for (auto& replicas : tables)
+		{
+			replicas.resize(numReplicas);
+			for (Memory<TinyCuckooItem>& mem : replicas)
+			{
+				mem.setup(1ull << tableWidth, in.update.item);
+				mem.setPowerOnStateZero();
+			}
+		}
+
+		// the update path is driven by the cpu and the insert engine below, reads happen before the write
+		TinyCuckooUpdate update = constructFrom(in.update);
+
+		TinyCuckooMultiOut out;
+
+		// insert engine state, the carried item is visible to lookups
+		Bit engineBusy;
+		TinyCuckooItem carried = constructFrom(in.update.item);
+		const TinyCuckooItem carriedReg = carried;
+
+		for (size_t lane = 0; lane < in.lookups.size(); ++lane)
+		{
+			GroupScope entity(GroupScope::GroupType::ENTITY);
+			entity.setName("TinyCuckooLane");
+
+			const TinyCuckooLookup& lookup = in.lookups[lane];
+			HCL_DESIGNCHECK_HINT(lookup.hash.size() == tableWidth * in.numTables, "The lookup hash needs one table index per table.");
+
+			TinyCuckooOut result;
+			result.found = '0';
+			result.key = lookup.key;
+			result.hash = lookup.hash;
+			result.userData = lookup.userData;
+			result.value = in.valueWidth();
+			result.value = 0;
+
+			std::vector<TinyCuckooItem> items;
+			std::vector<BVec> addresses;
+			for (size_t t = 0; t < in.numTables; ++t)
+			{
+				addresses.push_back(lookup.hash(hashPart[t]));
+				items.push_back(tables[t][lane / in.readPortsPerMemory][addresses.back()]);
+			}
+
+			for (size_t l = 0; l < in.latency; ++l)
+			{
+				for (size_t t = 0; t < in.numTables; ++t)
+				{
+					forwardUpdate(items[t], addresses[t], t, update);
+					items[t] = reg(items[t]);
+					addresses[t] = reg(addresses[t]);
+				}
+				result = reg(result);
+			}
+			HCL_NAMED(items);
+
+			for (size_t t = 0; t < in.numTables; ++t)
+			{
+				IF(items[t].valid & items[t].key == result.key)
+				{
+					result.found = '1';
+					result.value = items[t].value;
+				}
+			}
+
+			if (in.insert)
+			{
+				IF(engineBusy & carriedReg.key == result.key)
+				{
+					result.found = '1';
+					result.value = carriedReg.value;
+				}
+			}
+
+			HCL_NAMED(result);
+			out.lookups.push_back(result);
+		}
+
+		Bit engineWrite = '0';
+		BVec engineTable = in.update.tableIdx.getWidth();
+		BVec engineItem = in.update.itemIdx.getWidth();
+		engineTable = 0;
+		engineItem = 0;
+		TinyCuckooItem engineData = in.update.item;
+
+		out.insertReady = '0';
+		out.insertBusy = '0';
+		out.insertFailed = '0';
+		out.insertDropped = constructFrom(in.update.item);
+		out.insertDropped.valid = '0';
+		out.insertDropped.key = 0;
+		out.insertDropped.value = 0;
+
+		if (in.insert)
+		{
+			GroupScope entity(GroupScope::GroupType::ENTITY);
+			entity.setName("TinyCuckooInsert");
+
+			TinyCuckooItem queueItem = {
+				.valid = '1',
+				.key = in.insert->key,
+				.value = in.insert->value,
+			};
+			Fifo<TinyCuckooItem> queue{ in.insertQueueDepth, queueItem };
+			queue.push(queueItem, in.insert->valid & !queue.full());
+			out.insertReady = !queue.full();
+
+			// a placement step reads all candidate slots, and decides and writes in the next cycle
+			Bit decide;
+			BVec displacements = BitWidth{ utils::Log2C(in.maxDisplacements + 1) };
+			BVec victim = in.update.tableIdx.getWidth();
+
+			BVec carriedHash = in.hash(carriedReg.key);
+			HCL_DESIGNCHECK_HINT(carriedHash.size() == tableWidth * in.numTables, "The hash function needs to return one table index per table.");
+
+			std::vector<TinyCuckooItem> slots;
+			std::vector<BVec> addresses;
+			for (size_t t = 0; t < in.numTables; ++t)
+			{
+				addresses.push_back(carriedHash(hashPart[t]));
+				TinyCuckooItem slot = tables[t][0][addresses.back()];
+				forwardUpdate(slot, addresses.back(), t, update);
+				slots.push_back(reg(slot));
+			}
+			HCL_NAMED(slots);
+
+			// prefer the slot already holding the key, then any empty slot
+			Bit hasSlot = '0';
+			BVec freeTable = engineTable.getWidth();
+			freeTable = 0;
+			for (size_t t = in.numTables; t > 0; --t)
+				IF(!slots[t - 1].valid)
+				{
+					hasSlot = '1';
+					freeTable = t - 1;
+				}
+			for (size_t t = in.numTables; t > 0; --t)
+				IF(slots[t - 1].valid & slots[t - 1].key == carriedReg.key)
+				{
+					hasSlot = '1';
+					freeTable = t - 1;
+				}
+			HCL_NAMED(hasSlot);
+
+			TinyCuckooItem next = constructFrom(queueItem);
+			Bit start = !engineBusy & !queue.empty();
+			queue.pop(next, start);
+
+			IF(start)
+			{
+				engineBusy = '1';
+				carried = next;
+				decide = '0';
+				displacements = 0;
+			}
+			ELSE IF(engineBusy)
+			{
+				IF(!decide)
+				{
+					decide = '1';
+				}
+				ELSE IF(in.update.valid)
+				{
+					// the direct update may have changed the slots, read them again
+					decide = '0';
+				}
+				ELSE
+				{
+					engineWrite = '1';
+					decide = '0';
+					IF(hasSlot)
+					{
+						engineTable = freeTable;
+						engineBusy = '0';
+					}
+					ELSE IF(displacements == in.maxDisplacements)
+					{
+						out.insertFailed = '1';
+						out.insertDropped = carriedReg;
+						engineWrite = '0';
+						engineBusy = '0';
+					}
+					ELSE
+					{
+						engineTable = victim;
+						displacements += 1;
+						IF(victim == in.numTables - 1)
+							victim = 0;
+						ELSE
+							victim += 1;
+						for (size_t t = 0; t < in.numTables; ++t)
+							IF(engineTable == t)
+								carried = slots[t];
+					}
+
+					for (size_t t = 0; t < in.numTables; ++t)
+						IF(engineTable == t)
+							engineItem = addresses[t];
+				}
+			}
+
+			// the write uses the carried item before it is replaced by the displaced one
+			engineData = carriedReg;
+
+			engineBusy = reg(engineBusy, '0');
+			carried = reg(carried);
+			decide = reg(decide, '0');
+			displacements = reg(displacements, 0);
+			victim = reg(victim, 0);
+			HCL_NAMED(engineBusy);
+			HCL_NAMED(carried);
+			HCL_NAMED(decide);
+			HCL_NAMED(displacements);
+			HCL_NAMED(victim);
+
+			out.insertBusy = engineBusy | !queue.empty();
+		}
+		else
+		{
+			engineBusy = '0';
+			carried.valid = '0';
+			carried.key = 0;
+			carried.value = 0;
+		}
+		HCL_NAMED(engineWrite);
+
+		update.valid = in.update.valid | engineWrite;
+		update.tableIdx = in.update.tableIdx;
+		update.itemIdx = in.update.itemIdx;
+		update.item = in.update.item;
+		IF(!in.update.valid)
+		{
+			update.tableIdx = engineTable;
+			update.itemIdx = engineItem;
+			update.item = engineData;
+		}
+		HCL_NAMED(update);
+
+		for (size_t t = 0; t < in.numTables; ++t)
+			for (Memory<TinyCuckooItem>& mem : tables[t])
+				IF(update.valid & update.tableIdx == t)
+					mem[update.itemIdx] = update.item;
+
+		HCL_NAMED(out);
+		return out;
+	}
 }
@@ -103,6 +103,63 @@ namespace gtry::scl
 
 	TinyCuckooOut tinyCuckoo(const TinyCuckooIn& in);
 
+	struct TinyCuckooLookup
+	{
+		BVec key;
+		BVec hash;
+		BVec userData;
+	};
+
+	struct TinyCuckooInsert
+	{
+		Bit valid;
+		BVec key;
+		BVec value;
+	};
+
+	struct TinyCuckooMultiIn
+	{
+		/// One lookup lane per entry, all lanes are served every cycle.
+		std::vector<TinyCuckooLookup> lookups = {};
+		/// Direct table writes, e.g. from the cpu. They take precedence over the insert engine.
+		TinyCuckooUpdate update;
+
+		size_t numTables = 2;
+		size_t latency = 2;
+		/// Tables are replicated until every lane has its own read port, all replicas share the update path.
+		size_t readPortsPerMemory = 1;
+
+		/// Optional hardware inserts with bounded cuckoo displacement, requires the hash function to rehash displaced keys.
+		std::optional<TinyCuckooInsert> insert = {};
+		std::function<BVec(const BVec& key)> hash = {};
+		size_t insertQueueDepth = 16;
+		size_t maxDisplacements = 16;
+
+		BitWidth valueWidth() const { return update.item.value.getWidth(); }
+		BitWidth tableWidth() const { return update.itemIdx.getWidth(); }
+	};
+
+	struct TinyCuckooMultiOut
+	{
+		std::vector<TinyCuckooOut> lookups;
+
+		/// The insert queue can take another item.
+		Bit insertReady;
+		/// Items are queued or being placed.
+		Bit insertBusy;
+		/// A displacement chain reached maxDisplacements, the item it carried is dropped from the table.
+		Bit insertFailed;
+		TinyCuckooItem insertDropped;
+	};
+
+	/**
+	 * @brief Cuckoo lookup engine that serves several lookups per cycle.
+	 * @details Lookups reflect all updates of the cycles before their result is presented, writes during the
+	 * lookup latency are forwarded into the pipeline. An item that is carried by the insert engine between two
+	 * displacements is visible to lookups as well, so keys do not disappear while being moved.
+	 */
+	TinyCuckooMultiOut tinyCuckooMultiLane(const TinyCuckooMultiIn& in);
+
 	template<typename Tkey, typename Tval>
 	inline TinyCuckoo<Tkey, Tval>::TinyCuckoo(size_t capacity, const Tkey& key, const Tval& val, size_t numTables)
 	{
@@ -194,3 +251,6 @@ BOOST_HANA_ADAPT_STRUCT(gtry::scl::TinyCuckooItem, valid, key, value);
 BOOST_HANA_ADAPT_STRUCT(gtry::scl::TinyCuckooUpdate, valid, tableIdx, itemIdx, item);
 BOOST_HANA_ADAPT_STRUCT(gtry::scl::TinyCuckooIn, key, hash, userData, update, numTables, latency);
 BOOST_HANA_ADAPT_STRUCT(gtry::scl::TinyCuckooOut, found, key, hash, value, userData);
+BOOST_HANA_ADAPT_STRUCT(gtry::scl::TinyCuckooLookup, key, hash, userData);
+BOOST_HANA_ADAPT_STRUCT(gtry::scl::TinyCuckooInsert, valid, key, value);
+BOOST_HANA_ADAPT_STRUCT(gtry::scl::TinyCuckooMultiOut, lookups, insertReady, insertBusy, insertFailed, insertDropped);
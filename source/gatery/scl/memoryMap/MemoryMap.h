@@ -58,7 +58,8 @@ namespace gtry::scl
 		Bit add(BVec& value, RegDesc desc);
 
 		template<typename T> void stage(Memory<T>& mem);
-		template<typename T> void stage(std::vector<Memory<T>>& mem);
+		/// replicas[i] lists copies of mems[i] that receive the same writes, reads are served by mems[i]
+		template<typename T> void stage(std::vector<Memory<T>>& mems, const std::vector<std::vector<Memory<T>>>& replicas = {});
 
 		void flags(size_t f) { m_flags = f; }
 		bool readEnabled() const { return (m_flags & F_READ) != 0; }
@@ -129,7 +130,8 @@ namespace gtry::scl
 
 		SigVis v{ this };
         VisitCompound<T>{}(stage, v);
-		stage = reg(stage);
+		T stageReg = reg(stage);
+		stage = stageReg; // copy assign, moving a container would replace the signals the registers above are bound to
 
 		IF(writeEnabled() & cmdTrigger & cmdAddr.msb() == '0')
 			port = stage;
@@ -147,10 +149,11 @@ namespace gtry::scl
 	}
 
 	template<typename T>
-	inline void scl::MemoryMap::stage(std::vector<Memory<T>>& mems)
+	inline void scl::MemoryMap::stage(std::vector<Memory<T>>& mems, const std::vector<std::vector<Memory<T>>>& replicas)
 	{
 		if (mems.empty())
 			return;
+		HCL_DESIGNCHECK_HINT(replicas.empty() || replicas.size() == mems.size(), "Replicas must be listed for every staged memory.");
 
 		GroupScope ent{ GroupScope::GroupType::ENTITY };
 		ent.setName("MemoryMapRamStage");
@@ -234,7 +237,8 @@ namespace gtry::scl
 		enterScope("staging");
 		VisitCompound<T>{}(stage, v);
 		leaveScope();
-		stage = reg(stage);
+		T stageReg = reg(stage);
+		stage = stageReg; // copy assign, moving a container would replace the signals the registers above are bound to
 
 		Bit readTrigger = reg(readEnabled() & cmdTrigger & cmdAddr.msb() == '1', '0');
 		BVec readTabAddr = reg(cmdAddr(memTabSel));
@@ -248,7 +252,13 @@ namespace gtry::scl
 			IF(cmdAddr(memTabSel) == t)
 			{
 				IF(writeEnabled() & cmdTrigger & cmdAddr.msb() == '0')
+				{
 					port = stage;
+					// write through copies, they share the memory node of the replica
+					if (!replicas.empty())
+						for (Memory<T> replica : replicas[t])
+							replica[cmdAddr(0, replica.addressWidth().value)] = stage;
+				}
 			}
 
 			T readData = reg(port.read());
@@ -37,19 +37,24 @@ size_t BitAllocator::allocate(size_t size) {
             case 8: bucket = BUCKET_8; break;
             case 16: bucket = BUCKET_16; break;
             case 32: bucket = BUCKET_32; break;
+            default: HCL_ASSERT(false);
         }
         
+        // Don't keep filling words that are far behind the current allocation front, they would drag in cold cache lines.
+        if (m_buckets[bucket].remaining != 0 && m_totalSize - (m_buckets[bucket].offset & ~(WORD_SIZE-1ull)) > CACHE_LINE_SIZE)
+            m_buckets[bucket].remaining = 0;
+
         if (m_buckets[bucket].remaining == 0) {
             m_buckets[bucket].offset = m_totalSize;
-            m_totalSize += 64;
-            m_buckets[bucket].remaining = 64 / size;
+            m_totalSize += WORD_SIZE;
+            m_buckets[bucket].remaining = WORD_SIZE / size;
         }
         size_t offset = m_buckets[bucket].offset;
         m_buckets[bucket].offset += size;
         m_buckets[bucket].remaining--;
         return offset;
     } else {
-        size = (size + 63ull) & ~63ull;
+        size = (size + WORD_SIZE-1ull) & ~(WORD_SIZE-1ull);
         size_t offset = m_totalSize;
         m_totalSize += size;
         return offset;
@@ -62,4 +67,9 @@ void BitAllocator::flushBuckets() {
     }
 }
 
+void BitAllocator::alignToCacheLine() {
+    flushBuckets();
+    m_totalSize = (m_totalSize + CACHE_LINE_SIZE-1ull) & ~(CACHE_LINE_SIZE-1ull);
+}
+
 }
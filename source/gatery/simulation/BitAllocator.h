@@ -22,7 +22,14 @@
 #include <array>
 
 namespace gtry::sim {
-    
+
+/**
+ * @brief Hands out bit offsets into the simulation state.
+ * @details Signals of up to 32 bits are packed into power-of-two buckets, larger signals are word aligned,
+ * so that no signal of up to 64 bits ever straddles a BaseType word.
+ * Allocations are expected to arrive in evaluation order, so to keep the working set of neighbouring nodes close together
+ * a bucket is abandoned once its word falls more than a cache line behind the allocation front.
+ */
 class BitAllocator {
     public:
         enum {
@@ -35,8 +42,15 @@ class BitAllocator {
             NUM_BUCKETS
         };
 
+        enum {
+            WORD_SIZE = 64,
+            CACHE_LINE_SIZE = 64*8
+        };
+
         size_t allocate(size_t size);
         void flushBuckets();
+        /// Flushes all buckets and pads to the next cache line, such that subsequent allocations start a new group of cache lines.
+        void alignToCacheLine();
         inline size_t getTotalSize() const { return m_totalSize; }
     protected:
         struct Bucket {
@@ -41,6 +41,7 @@
 #include "simProc/WaitUntil.h"
 #include "simProc/WaitClock.h"
 #include "RunTimeSimulationContext.h"
+#include "SignalSubscription.h"
 
 #include <iostream>
 
@@ -49,8 +50,98 @@
 namespace gtry::sim {
 
 
-void ExecutionBlock::evaluate(SimulatorCallbacks &simCallbacks, DataState &state) const
+namespace {
+
+hlim::NodePort getEvaluationDriver(hlim::BaseNode *node, size_t port)
 {
+    auto driver = node->getNonSignalDriver(port);
+    while (dynamic_cast<hlim::Node_ExportOverride*>(driver.node)) // Skip all export override nodes
+        driver = driver.node->getNonSignalDriver(0);
+    return driver;
+}
+
+/// Prints the nodes that take part in a combinatorial loop and moves them into a "loopGroup" entity for inspection in loop.svg.
+void reportCombinatorialLoop(const hlim::Circuit &circuit, const std::vector<hlim::BaseNode*> &nodesRemaining, const std::function<bool(const hlim::NodePort&)> &isReady)
+{
+    std::cout << "nodesRemaining : " << nodesRemaining.size() << std::endl;
+
+    std::set<hlim::BaseNode*> loopNodes(nodesRemaining.begin(), nodesRemaining.end());
+    while (true) {
+        std::set<hlim::BaseNode*> tmp = std::move(loopNodes);
+        loopNodes.clear();
+
+        bool done = true;
+        for (auto* n : tmp) {
+            bool anyDrivenInLoop = false;
+            for (auto i : utils::Range(n->getNumOutputPorts()))
+                for (auto nh : n->exploreOutput(i)) {
+                    if (!nh.isSignal()) {
+                        if (tmp.contains(nh.node())) {
+                            anyDrivenInLoop = true;
+                            break;
+                        }
+                        nh.backtrack();
+                    }
+                }
+
+            if (anyDrivenInLoop)
+                loopNodes.insert(n);
+            else
+                done = false;
+        }
+
+        if (done) break;
+    }
+
+
+    auto& nonConstCircuit = const_cast<hlim::Circuit&>(circuit);
+
+    auto* loopGroup = nonConstCircuit.getRootNodeGroup()->addChildNodeGroup(hlim::NodeGroup::GroupType::ENTITY);
+    loopGroup->setInstanceName("loopGroup");
+    loopGroup->setName("loopGroup");
+
+    for (auto node : loopNodes) {
+        std::cout << node->getName() << " in group " << node->getGroup()->getName() << " - " << std::dec << node->getId() << " -  " << node->getTypeName() << "  " << std::hex << (size_t)node << std::endl;
+        for (auto i : utils::Range(node->getNumInputPorts())) {
+            auto driver = getEvaluationDriver(node, i);
+            if (!isReady(driver)) {
+                std::cout << "    Input " << i << " not ready." << std::endl;
+                std::cout << "        " << driver.node->getName() << "  " << driver.node->getTypeName() << "  " << std::hex << (size_t)driver.node << std::endl;
+            }
+        }
+        std::cout << "  stack trace:" << std::endl << node->getStackTrace() << std::endl;
+
+        node->moveToGroup(loopGroup);
+
+        for (auto i : utils::Range(node->getNumOutputPorts()))
+            for (auto nh : node->exploreOutput(i)) {
+                if (nh.isSignal())
+                    nh.node()->moveToGroup(loopGroup);
+                else
+                    nh.backtrack();
+            }
+    }
+
+    DotExport exp("loop.dot");
+    exp(circuit);
+    exp.runGraphViz("loop.svg");
+}
+
+}
+
+void ExecutionBlock::evaluate(SimulatorCallbacks &simCallbacks, DataState &state, NodeProfile *profile) const
+{
+    if (profile != nullptr) {
+        for (auto i : utils::Range(m_steps.size())) {
+            const auto &step = m_steps[i];
+            std::uint64_t start = __rdtsc();
+            step.node->simulateEvaluate(simCallbacks, state.signalState, step.internal.data(), step.inputs.data(), step.outputs.data());
+            profile[i].ticks += __rdtsc() - start;
+            profile[i].samples++;
+        }
+        return;
+    }
+
 #if 1
     for (const auto &step : m_steps)
         step.node->simulateEvaluate(simCallbacks, state.signalState, step.internal.data(), step.inputs.data(), step.outputs.data());
@@ -83,15 +174,24 @@ ClockedNode::ClockedNode(MappedNode mappedNode, size_t clockPort) : m_mappedNode
 {
 }
 
-void ClockedNode::advance(SimulatorCallbacks &simCallbacks, DataState &state) const
+void ClockedNode::advance(SimulatorCallbacks &simCallbacks, DataState &state, NodeProfile *profile) const
 {
-    m_mappedNode.node->simulateAdvance(simCallbacks, state.signalState, m_mappedNode.internal.data(), m_mappedNode.outputs.data(), m_clockPort);
+    if (profile != nullptr) {
+        std::uint64_t start = __rdtsc();
+        m_mappedNode.node->simulateAdvance(simCallbacks, state.signalState, m_mappedNode.internal.data(), m_mappedNode.outputs.data(), m_clockPort);
+        profile->ticks += __rdtsc() - start;
+        profile->samples++;
+    } else
+        m_mappedNode.node->simulateAdvance(simCallbacks, state.signalState, m_mappedNode.internal.data(), m_mappedNode.outputs.data(), m_clockPort);
 }
 
 
 void Program::compileProgram(const hlim::Circuit &circuit, const std::vector<hlim::BaseNode*> &nodes)
 {
-    allocateSignals(circuit, nodes);
+    std::vector<hlim::BaseNode*> evaluationOrder = computeEvaluationOrder(circuit, nodes);
+
+    // Allocate in evaluation order so that nodes evaluated back to back also have their state side by side.
+    allocateSignals(circuit, nodes, evaluationOrder);
 
 
     for (const auto &clock : circuit.getClocks()) {
@@ -101,49 +201,12 @@ void Program::compileProgram(const hlim::Circuit &circuit, const std::vector<hli
         });
     }
 
+    m_executionBlocks.push_back({});
+    ExecutionBlock &execBlock = m_executionBlocks.back();
 
-    std::set<hlim::NodePort> outputsReady;
-
-    std::set<hlim::BaseNode*> nodesRemaining;
-    for (auto node : nodes) {
-        if (dynamic_cast<hlim::Node_Signal*>(node) != nullptr) continue;
-        nodesRemaining.insert(node);
-
-
-        MappedNode mappedNode;
-        mappedNode.node = node;
-        mappedNode.internal = m_stateMapping.nodeToInternalOffset[node];
-        for (auto i : utils::Range(node->getNumInputPorts())) {
-            auto driver = node->getNonSignalDriver(i);
-            mappedNode.inputs.push_back(m_stateMapping.outputToOffset[driver]);
-        }
-        for (auto i : utils::Range(node->getNumOutputPorts()))
-            mappedNode.outputs.push_back(m_stateMapping.outputToOffset[{.node = node, .port = i}]);
-
-        for (auto i : utils::Range(node->getNumOutputPorts())) {
-
-            switch (node->getOutputType(i)) {
-                case hlim::NodeIO::OUTPUT_IMMEDIATE:
-                    // nothing
-                break;
-                case hlim::NodeIO::OUTPUT_CONSTANT: {
-                    hlim::NodePort driver;
-                    driver.node = node;
-                    driver.port = i;
-                    outputsReady.insert(driver);
-
-//                    m_powerOnNodes.push_back(mappedNode);
-                } break;
-                case hlim::NodeIO::OUTPUT_LATCHED: {
-                    hlim::NodePort driver;
-                    driver.node = node;
-                    driver.port = i;
-                    outputsReady.insert(driver);
+    for (auto node : evaluationOrder) {
+        MappedNode mappedNode = mapNode(node);
 
-//                    m_powerOnNodes.push_back(mappedNode);
-                } break;
-            }
-        }
         m_powerOnNodes.push_back(mappedNode); /// @todo now we do this to all nodes, needs to be found out by some other means
 
         for (auto clockPort : utils::Range(node->getClocks().size())) {
@@ -155,128 +218,111 @@ void Program::compileProgram(const hlim::Circuit &circuit, const std::vector<hli
                     clockDomain.dependentExecutionBlocks.push_back(0ull);
             }
         }
-    }
-
-
-    m_executionBlocks.push_back({});
-    ExecutionBlock &execBlock = m_executionBlocks.back();
-
-    while (!nodesRemaining.empty()) {
-        hlim::BaseNode *readyNode = nullptr;
-        for (auto node : nodesRemaining) {
-            bool allInputsReady = true;
-            for (auto i : utils::Range(node->getNumInputPorts())) {
-                auto driver = node->getNonSignalDriver(i);
-                while (dynamic_cast<hlim::Node_ExportOverride*>(driver.node)) // Skip all export override nodes
-                    driver = driver.node->getNonSignalDriver(0);
-                if (driver.node != nullptr && !outputsReady.contains(driver)) {
-                    allInputsReady = false;
-                    break;
-                }
-            }
-
-            if (allInputsReady) {
-                readyNode = node;
-                break;
-            }
-        }
-
-        if (readyNode == nullptr) {
-            std::cout << "nodesRemaining : " << nodesRemaining.size() << std::endl;
-
-            
-            std::set<hlim::BaseNode*> loopNodes = nodesRemaining;
-            while (true) {
-                std::set<hlim::BaseNode*> tmp = std::move(loopNodes);
-                loopNodes.clear();
-
-                bool done = true;
-                for (auto* n : tmp) {
-                    bool anyDrivenInLoop = false;
-                    for (auto i : utils::Range(n->getNumOutputPorts()))
-                        for (auto nh : n->exploreOutput(i)) {
-                            if (!nh.isSignal()) {
-                                if (tmp.contains(nh.node())) {
-                                    anyDrivenInLoop = true;
-                                    break;
-                                }
-                                nh.backtrack();
-                            }
-                        }
 
-                    if (anyDrivenInLoop)
-                        loopNodes.insert(n);
-                    else
-                        done = false;
-                }
+        execBlock.addStep(std::move(mappedNode));
+    }
+}
 
-                if (done) break;
-            }
+MappedNode Program::mapNode(hlim::BaseNode *node)
+{
+    MappedNode mappedNode;
+    mappedNode.node = node;
+    mappedNode.internal = m_stateMapping.nodeToInternalOffset[node];
+    for (auto i : utils::Range(node->getNumInputPorts())) {
+        auto driver = node->getNonSignalDriver(i);
+        mappedNode.inputs.push_back(m_stateMapping.outputToOffset[driver]);
+    }
+    for (auto i : utils::Range(node->getNumOutputPorts()))
+        mappedNode.outputs.push_back(m_stateMapping.outputToOffset[{.node = node, .port = i}]);
 
+    return mappedNode;
+}
 
-            auto& nonConstCircuit = const_cast<hlim::Circuit&>(circuit);
+std::vector<hlim::BaseNode*> Program::computeEvaluationOrder(const hlim::Circuit &circuit, const std::vector<hlim::BaseNode*> &nodes)
+{
+    // All bookkeeping is dense and indexed by the position in nodes (which is sorted by id), so the schedule only depends
+    // on the circuit and not on where the nodes happen to live on the heap.
+    std::uint64_t idEnd = 0;
+    for (auto node : nodes)
+        idEnd = std::max(idEnd, node->getId()+1);
+
+    std::vector<size_t> idToIdx(idEnd, SIZE_MAX);
+    for (auto i : utils::Range(nodes.size()))
+        idToIdx[nodes[i]->getId()] = i;
+
+    auto getIdx = [&](const hlim::BaseNode *node)->size_t {
+        if (node->getId() >= idEnd) return SIZE_MAX;
+        return idToIdx[node->getId()];
+    };
 
-            auto* loopGroup = nonConstCircuit.getRootNodeGroup()->addChildNodeGroup(hlim::NodeGroup::GroupType::ENTITY);
-            loopGroup->setInstanceName("loopGroup");
-            loopGroup->setName("loopGroup");
+    std::vector<bool> scheduled(nodes.size(), false);
 
-            for (auto node : loopNodes) {
-                std::cout << node->getName() << " in group " << node->getGroup()->getName() << " - " << std::dec << node->getId() << " -  " << node->getTypeName() << "  " << std::hex << (size_t)node << std::endl;
-                for (auto i : utils::Range(node->getNumInputPorts())) {
-                    auto driver = node->getNonSignalDriver(i);
-                    while (dynamic_cast<hlim::Node_ExportOverride*>(driver.node)) // Skip all export override nodes
-                        driver = driver.node->getNonSignalDriver(0);
-                    if (driver.node != nullptr && !outputsReady.contains(driver)) {
-                        std::cout << "    Input " << i << " not ready." << std::endl;
-                        std::cout << "        " << driver.node->getName() << "  " << driver.node->getTypeName() << "  " << std::hex << (size_t)driver.node << std::endl;
-                    }
-                }
-                std::cout << "  stack trace:" << std::endl << node->getStackTrace() << std::endl;
+    auto isReady = [&](const hlim::NodePort &driver)->bool {
+        if (driver.node == nullptr) return true;
+        size_t idx = getIdx(driver.node);
+        if (idx == SIZE_MAX) return false;
+        if (driver.node->getOutputType(driver.port) != hlim::NodeIO::OUTPUT_IMMEDIATE) return true;
+        return scheduled[idx];
+    };
 
-                node->moveToGroup(loopGroup);
+    std::vector<size_t> numInputsPending(nodes.size(), 0);
+    std::vector<std::vector<size_t>> consumers(nodes.size());
+    std::vector<size_t> readyStack;
 
-                for (auto i : utils::Range(node->getNumOutputPorts()))
-                    for (auto nh : node->exploreOutput(i)) {
-                        if (nh.isSignal())
-                            nh.node()->moveToGroup(loopGroup);
-                        else
-                            nh.backtrack();
-                    }
+    size_t numNodesToSchedule = 0;
+    for (auto i : utils::Range(nodes.size())) {
+        auto *node = nodes[i];
+        if (dynamic_cast<hlim::Node_Signal*>(node) != nullptr) continue;
+        numNodesToSchedule++;
+
+        for (auto j : utils::Range(node->getNumInputPorts())) {
+            auto driver = getEvaluationDriver(node, j);
+            if (!isReady(driver)) {
+                numInputsPending[i]++;
+                size_t driverIdx = getIdx(driver.node);
+                if (driverIdx != SIZE_MAX)
+                    consumers[driverIdx].push_back(i);
             }
-
-            DotExport exp("loop.dot");
-            exp(circuit);
-            exp.runGraphViz("loop.svg");
         }
+    }
 
-        HCL_DESIGNCHECK_HINT(readyNode != nullptr, "Cyclic dependency!");
+    // Push in reverse so that the lowest id is scheduled first
+    for (size_t i = nodes.size(); i-- > 0; )
+        if (numInputsPending[i] == 0 && dynamic_cast<hlim::Node_Signal*>(nodes[i]) == nullptr)
+            readyStack.push_back(i);
 
-        nodesRemaining.erase(readyNode);
+    std::vector<hlim::BaseNode*> evaluationOrder;
+    evaluationOrder.reserve(numNodesToSchedule);
 
-        MappedNode mappedNode;
-        mappedNode.node = readyNode;
-        mappedNode.internal = m_stateMapping.nodeToInternalOffset[readyNode];
-        for (auto i : utils::Range(readyNode->getNumInputPorts())) {
-            auto driver = readyNode->getNonSignalDriver(i);
-            mappedNode.inputs.push_back(m_stateMapping.outputToOffset[driver]);
-        }
+    // Depth first, so that consumers tend to be evaluated (and thus allocated) right after their producers.
+    while (!readyStack.empty()) {
+        size_t idx = readyStack.back();
+        readyStack.pop_back();
 
-        for (auto i : utils::Range(readyNode->getNumOutputPorts()))
-            mappedNode.outputs.push_back(m_stateMapping.outputToOffset[{.node = readyNode, .port = i}]);
+        scheduled[idx] = true;
+        evaluationOrder.push_back(nodes[idx]);
 
-        execBlock.addStep(std::move(mappedNode));
+        const auto &nodeConsumers = consumers[idx];
+        for (auto it = nodeConsumers.rbegin(); it != nodeConsumers.rend(); ++it)
+            if (--numInputsPending[*it] == 0)
+                readyStack.push_back(*it);
+    }
 
-        for (auto i : utils::Range(readyNode->getNumOutputPorts())) {
-            hlim::NodePort driver;
-            driver.node = readyNode;
-            driver.port = i;
-            outputsReady.insert(driver);
-        }
+    if (evaluationOrder.size() != numNodesToSchedule) {
+        std::vector<hlim::BaseNode*> nodesRemaining;
+        for (auto i : utils::Range(nodes.size()))
+            if (!scheduled[i] && dynamic_cast<hlim::Node_Signal*>(nodes[i]) == nullptr)
+                nodesRemaining.push_back(nodes[i]);
+
+        reportCombinatorialLoop(circuit, nodesRemaining, isReady);
     }
 
+    HCL_DESIGNCHECK_HINT(evaluationOrder.size() == numNodesToSchedule, "Cyclic dependency!");
+
+    return evaluationOrder;
 }
 
-void Program::allocateSignals(const hlim::Circuit &circuit, const std::vector<hlim::BaseNode*> &nodes)
+void Program::allocateSignals(const hlim::Circuit &circuit, const std::vector<hlim::BaseNode*> &nodes, const std::vector<hlim::BaseNode*> &evaluationOrder)
 {
     m_stateMapping.clear();
 
@@ -290,52 +336,62 @@ void Program::allocateSignals(const hlim::Circuit &circuit, const std::vector<hl
 
     std::vector<ReferringNode> referringNodes;
 
+    auto isSignalLike = [](hlim::BaseNode *node) {
+        return dynamic_cast<hlim::Node_Signal*>(node) || dynamic_cast<hlim::Node_ExportOverride*>(node);
+    };
+
+    // The (single) execution block gets its own set of cache lines.
+    allocator.alignToCacheLine();
 
-    // First, loop through all nodes and allocate state and output state space.
+    // First, loop through all nodes in evaluation order and allocate state and output state space.
     // Keep a list of nodes that refer to other node's internal state to fill in once all internal state has been allocated.
-    for (auto node : nodes) {
-        // Signals simply point to the actual producer's output, as do export overrides
-        if (dynamic_cast<hlim::Node_Signal*>(node) || dynamic_cast<hlim::Node_ExportOverride*>(node)) {
-            auto driver = node->getNonSignalDriver(0);
-            while (dynamic_cast<hlim::Node_ExportOverride*>(driver.node))
-                driver = driver.node->getNonSignalDriver(0);
-
-            size_t width = node->getOutputConnectionType(0).width;
-
-            if (driver.node != nullptr) {
-                auto it = m_stateMapping.outputToOffset.find(driver);
-                if (it == m_stateMapping.outputToOffset.end()) {
-                    auto offset = allocator.allocate(width);
-                    m_stateMapping.outputToOffset[driver] = offset;
-                    m_stateMapping.outputToOffset[{.node = node, .port = 0ull}] = offset;
-                } else {
-                    // point to same output port
-                    m_stateMapping.outputToOffset[{.node = node, .port = 0ull}] = it->second;
-                }
-            }
-        } else {
-            std::vector<size_t> internalSizes = node->getInternalStateSizes();
-            ReferringNode refNode;
-            refNode.node = node;
-            refNode.refs = node->getReferencedInternalStateSizes();
-            refNode.internalSizeOffset = internalSizes.size();
-
-            std::vector<size_t> internalOffsets(internalSizes.size() + refNode.refs.size());
-            for (auto i : utils::Range(internalSizes.size()))
-                internalOffsets[i] = allocator.allocate(internalSizes[i]);
-            m_stateMapping.nodeToInternalOffset[node] = std::move(internalOffsets);
-
-            for (auto i : utils::Range(node->getNumOutputPorts())) {
-                hlim::NodePort driver = {.node = node, .port = i};
-                auto it = m_stateMapping.outputToOffset.find(driver);
-                if (it == m_stateMapping.outputToOffset.end()) {
-                    size_t width = node->getOutputConnectionType(i).width;
-                    m_stateMapping.outputToOffset[driver] = allocator.allocate(width);
-                }
+    for (auto node : evaluationOrder) {
+        if (isSignalLike(node)) continue;
+
+        std::vector<size_t> internalSizes = node->getInternalStateSizes();
+        ReferringNode refNode;
+        refNode.node = node;
+        refNode.refs = node->getReferencedInternalStateSizes();
+        refNode.internalSizeOffset = internalSizes.size();
+
+        std::vector<size_t> internalOffsets(internalSizes.size() + refNode.refs.size());
+        for (auto i : utils::Range(internalSizes.size()))
+            internalOffsets[i] = allocator.allocate(internalSizes[i]);
+        m_stateMapping.nodeToInternalOffset[node] = std::move(internalOffsets);
+
+        for (auto i : utils::Range(node->getNumOutputPorts())) {
+            hlim::NodePort driver = {.node = node, .port = i};
+            auto it = m_stateMapping.outputToOffset.find(driver);
+            if (it == m_stateMapping.outputToOffset.end()) {
+                size_t width = node->getOutputConnectionType(i).width;
+                m_stateMapping.outputToOffset[driver] = allocator.allocate(width);
             }
+        }
 
-            if (!refNode.refs.empty())
-                referringNodes.push_back(refNode);
+        if (!refNode.refs.empty())
+            referringNodes.push_back(refNode);
+    }
+
+    // Signals simply point to the actual producer's output, as do export overrides
+    for (auto node : nodes) {
+        if (!isSignalLike(node)) continue;
+
+        auto driver = node->getNonSignalDriver(0);
+        while (dynamic_cast<hlim::Node_ExportOverride*>(driver.node))
+            driver = driver.node->getNonSignalDriver(0);
+
+        size_t width = node->getOutputConnectionType(0).width;
+
+        if (driver.node != nullptr) {
+            auto it = m_stateMapping.outputToOffset.find(driver);
+            if (it == m_stateMapping.outputToOffset.end()) {
+                auto offset = allocator.allocate(width);
+                m_stateMapping.outputToOffset[driver] = offset;
+                m_stateMapping.outputToOffset[{.node = node, .port = 0ull}] = offset;
+            } else {
+                // point to same output port
+                m_stateMapping.outputToOffset[{.node = node, .port = 0ull}] = it->second;
+            }
         }
     }
 
@@ -390,7 +446,15 @@ void ReferenceSimulator::compileProgram(const hlim::Circuit &circuit, const std:
             nodes.push_back(node);
     }
 #else
-    std::set<hlim::BaseNode*> nodeSet;
+    // Collect with a dense, id indexed visited bitmap and keep the nodes in id order,
+    // so that schedule and state layout are reproducible from run to run.
+    std::uint64_t idEnd = 0;
+    for (const auto &node : circuit.getNodes())
+        idEnd = std::max(idEnd, node->getId()+1);
+
+    std::vector<bool> visited(idEnd, false);
+
+    std::vector<hlim::BaseNode*> nodes;
     {
         std::vector<hlim::BaseNode*> stack;
         if (outputs.empty()) {
@@ -405,29 +469,33 @@ void ReferenceSimulator::compileProgram(const hlim::Circuit &circuit, const std:
         while (!stack.empty()) {
             hlim::BaseNode *node = stack.back();
             stack.pop_back();
-            if (nodeSet.find(node) == nodeSet.end()) {
-                // Ignore the export-only part as well as the export node
-                if (auto *expOverride = dynamic_cast<hlim::Node_ExportOverride*>(node)) {
-                    if (node->getDriver(0).node != nullptr)
-                        stack.push_back(node->getDriver(0).node);
-                } else {
-                    nodeSet.insert(node);
-                    for (auto i : utils::Range(node->getNumInputPorts()))
-                        if (node->getDriver(i).node != nullptr)
-                            stack.push_back(node->getDriver(i).node);
-                }
+            if (visited[node->getId()]) continue;
+            visited[node->getId()] = true;
+
+            // Ignore the export-only part as well as the export node
+            if (auto *expOverride = dynamic_cast<hlim::Node_ExportOverride*>(node)) {
+                if (node->getDriver(0).node != nullptr)
+                    stack.push_back(node->getDriver(0).node);
+            } else {
+                nodes.push_back(node);
+                for (auto i : utils::Range(node->getNumInputPorts()))
+                    if (node->getDriver(i).node != nullptr)
+                        stack.push_back(node->getDriver(i).node);
             }
         }
     }
 
-    std::vector<hlim::BaseNode*> nodes;
-    nodes.reserve(nodeSet.size());
-    for (const auto &node : nodeSet)
-        nodes.push_back(node);
+    std::sort(nodes.begin(), nodes.end(), [](const hlim::BaseNode *lhs, const hlim::BaseNode *rhs) { return lhs->getId() < rhs->getId(); });
 
 #endif    
 
     m_program.compileProgram(circuit, nodes);
+
+    if (m_profiler)
+        m_profiler->reset(m_program);
+
+    for (auto *subscription : m_subscriptions)
+        bindSubscription(*subscription);
 }
 
 
@@ -488,8 +556,8 @@ void ReferenceSimulator::powerOn()
 void ReferenceSimulator::reevaluate()
 {
     /// @todo respect dependencies between blocks (once they are being expressed and made use of)
-    for (auto &block : m_program.m_executionBlocks)
-        block.evaluate(m_callbackDispatcher, m_dataState);
+    for (auto i : utils::Range(m_program.m_executionBlocks.size()))
+        evaluateExecutionBlock(i);
 
     m_stateNeedsReevaluating = false;
 }
@@ -499,6 +567,9 @@ void ReferenceSimulator::commitState()
     for (auto &block : m_program.m_executionBlocks)
         block.commitState(m_callbackDispatcher, m_dataState);
 
+    for (auto *subscription : m_subscriptions)
+        subscription->record(m_dataState.signalState, m_simulationTime);
+
     m_callbackDispatcher.onCommitState();
 }
 
@@ -536,8 +607,7 @@ void ReferenceSimulator::advanceEvent()
                         for (auto id : clkDom.dependentExecutionBlocks)
                             triggeredExecutionBlocks.insert(id);
 
-                        for (auto &cn : clkDom.clockedNodes)
-                            cn.advance(m_callbackDispatcher, m_dataState);
+                        advanceClockDomain(clkEvent.clockDomainIdx);
 
                         m_dataState.clockState[clkEvent.clockDomainIdx].nextTrigger = event.timeOfEvent + hlim::ClockRational(1) / clkEvent.clock->getAbsoluteFrequency();
                     }
@@ -557,7 +627,7 @@ void ReferenceSimulator::advanceEvent()
 
         /// @todo respect dependencies between blocks (once they are being expressed and made use of)
         for (auto idx : triggeredExecutionBlocks)
-            m_program.m_executionBlocks[idx].evaluate(m_callbackDispatcher, m_dataState);
+            evaluateExecutionBlock(idx);
 
         {
             RunTimeSimulationContext context(this);
@@ -577,6 +647,32 @@ void ReferenceSimulator::advanceEvent()
     m_currentTimeStepFinished = true;
 }
 
+void ReferenceSimulator::evaluateExecutionBlock(size_t blockIdx)
+{
+    NodeProfile *profile = nullptr;
+    if (m_profiler)
+        profile = m_profiler->sampleExecutionBlock(blockIdx);
+
+    m_program.m_executionBlocks[blockIdx].evaluate(m_callbackDispatcher, m_dataState, profile);
+}
+
+void ReferenceSimulator::advanceClockDomain(size_t clockDomainIdx)
+{
+    NodeProfile *profile = nullptr;
+    if (m_profiler)
+        profile = m_profiler->sampleClockDomain(clockDomainIdx);
+
+    const auto &clockedNodes = m_program.m_clockDomains[clockDomainIdx].clockedNodes;
+    for (auto i : utils::Range(clockedNodes.size()))
+        clockedNodes[i].advance(m_callbackDispatcher, m_dataState, profile != nullptr ? &profile[i] : nullptr);
+}
+
+void ReferenceSimulator::enableProfiling(size_t sampleInterval)
+{
+    m_profiler = std::make_unique<SimulationProfiler>(sampleInterval);
+    m_profiler->reset(m_program);
+}
+
 void ReferenceSimulator::advance(hlim::ClockRational seconds)
 {
     if (m_nextEvents.empty()) {
@@ -669,6 +765,28 @@ std::array<bool, DefaultConfig::NUM_PLANES> ReferenceSimulator::getValueOfClock(
     return res;
 }
 
+void ReferenceSimulator::addSubscription(SignalSubscription &subscription)
+{
+    m_subscriptions.push_back(&subscription);
+    bindSubscription(subscription);
+}
+
+void ReferenceSimulator::removeSubscription(SignalSubscription &subscription)
+{
+    std::erase(m_subscriptions, &subscription);
+}
+
+void ReferenceSimulator::bindSubscription(SignalSubscription &subscription)
+{
+    std::vector<size_t> stateOffsets(subscription.getSignals().size(), SIZE_MAX);
+    for (auto i : utils::Range(stateOffsets.size())) {
+        auto it = m_program.m_stateMapping.outputToOffset.find(subscription.getSignals()[i]);
+        if (it != m_program.m_stateMapping.outputToOffset.end())
+            stateOffsets[i] = it->second;
+    }
+    subscription.bind(std::move(stateOffsets));
+}
+
 /*
 std::array<bool, DefaultConfig::NUM_PLANES> ReferenceSimulator::getValueOfReset(const std::string &reset)
 {
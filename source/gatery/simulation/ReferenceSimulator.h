@@ -20,6 +20,7 @@
 #include "Simulator.h"
 
 #include "BitVectorState.h"
+#include "SimulationProfiler.h"
 #include "../hlim/NodeIO.h"
 #include "../utils/BitManipulation.h"
 
@@ -28,6 +29,7 @@
 #include <map>
 #include <queue>
 #include <list>
+#include <memory>
 
 namespace gtry::sim {
 
@@ -72,10 +74,12 @@ struct MappedNode {
 class ExecutionBlock
 {
     public:
-        void evaluate(SimulatorCallbacks &simCallbacks, DataState &state) const;
+        /// Evaluates all steps, if profile is given the cost of each step is recorded in the corresponding entry.
+        void evaluate(SimulatorCallbacks &simCallbacks, DataState &state, NodeProfile *profile = nullptr) const;
         void commitState(SimulatorCallbacks &simCallbacks, DataState &state) const;
 
         void addStep(MappedNode mappedNode);
+        inline const std::vector<MappedNode> &getSteps() const { return m_steps; }
     protected:
         //std::vector<size_t> m_dependsOnExecutionBlocks;
         //std::vector<size_t> m_dependentExecutionBlocks;
@@ -93,7 +97,8 @@ class ClockedNode
     public:
         ClockedNode(MappedNode mappedNode, size_t clockPort);
 
-        void advance(SimulatorCallbacks &simCallbacks, DataState &state) const;
+        void advance(SimulatorCallbacks &simCallbacks, DataState &state, NodeProfile *profile = nullptr) const;
+        inline const MappedNode &getMappedNode() const { return m_mappedNode; }
     protected:
         MappedNode m_mappedNode;
         size_t m_clockPort;
@@ -127,7 +132,9 @@ struct Program
     std::vector<ExecutionBlock> m_executionBlocks;
 
     protected:
-        void allocateSignals(const hlim::Circuit &circuit, const std::vector<hlim::BaseNode*> &nodes);
+        std::vector<hlim::BaseNode*> computeEvaluationOrder(const hlim::Circuit &circuit, const std::vector<hlim::BaseNode*> &nodes);
+        void allocateSignals(const hlim::Circuit &circuit, const std::vector<hlim::BaseNode*> &nodes, const std::vector<hlim::BaseNode*> &evaluationOrder);
+        MappedNode mapNode(hlim::BaseNode *node);
 };
 
 struct Event {
@@ -181,6 +188,9 @@ class ReferenceSimulator : public Simulator
         virtual DefaultBitVectorState getValueOfInternalState(const hlim::BaseNode *node, size_t idx) override;
         virtual DefaultBitVectorState getValueOfOutput(const hlim::NodePort &nodePort) override;
         virtual std::array<bool, DefaultConfig::NUM_PLANES> getValueOfClock(const hlim::Clock *clk) override;
+
+        virtual void addSubscription(SignalSubscription &subscription) override;
+        virtual void removeSubscription(SignalSubscription &subscription) override;
         //virtual std::array<bool, DefaultConfig::NUM_PLANES> getValueOfReset(const std::string &reset) override;
 
         virtual void addSimulationProcess(std::function<SimulationProcess()> simProc) override;
@@ -188,6 +198,12 @@ class ReferenceSimulator : public Simulator
         virtual void simulationProcessSuspending(std::coroutine_handle<> handle, WaitFor &waitFor, utils::RestrictTo<RunTimeSimulationContext>) override;
         virtual void simulationProcessSuspending(std::coroutine_handle<> handle, WaitUntil &waitUntil, utils::RestrictTo<RunTimeSimulationContext>) override;
         virtual void simulationProcessSuspending(std::coroutine_handle<> handle, WaitClock &waitClock, utils::RestrictTo<RunTimeSimulationContext>) override;
+
+        /// Starts attributing evaluation time to nodes, timing every sampleInterval-th evaluation of each execution block and clock domain.
+        void enableProfiling(size_t sampleInterval = 16);
+        void disableProfiling() { m_profiler.reset(); }
+        /// Returns the profiler for writing reports or nullptr if profiling is not enabled.
+        inline const SimulationProfiler *getProfiler() const { return m_profiler.get(); }
     protected:
         Program m_program;
         DataState m_dataState;
@@ -201,6 +217,14 @@ class ReferenceSimulator : public Simulator
 
         bool m_currentTimeStepFinished = true;
         bool m_abortCalled = false;
+
+        std::unique_ptr<SimulationProfiler> m_profiler;
+
+        std::vector<SignalSubscription*> m_subscriptions;
+        void bindSubscription(SignalSubscription &subscription);
+
+        void evaluateExecutionBlock(size_t blockIdx);
+        void advanceClockDomain(size_t clockDomainIdx);
 };
 
 }
@@ -0,0 +1,144 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#include "gatery/pch.h"
+#include "SignalSubscription.h"
+
+#include "BitAllocator.h"
+
+#include "../hlim/Node.h"
+#include "../utils/Range.h"
+#include "../utils/Exceptions.h"
+
+namespace gtry::sim {
+
+SignalSubscription::SignalSubscription(std::vector<hlim::NodePort> signals, size_t capacity) : m_signals(std::move(signals)), m_capacity(capacity)
+{
+    HCL_DESIGNCHECK_HINT(m_capacity > 0, "A signal subscription needs room for at least one record!");
+
+    BitAllocator allocator;
+    m_signalWidths.resize(m_signals.size());
+    m_signalOffsets.resize(m_signals.size());
+    for (auto i : utils::Range(m_signals.size())) {
+        HCL_ASSERT(m_signals[i].node != nullptr);
+        m_signalWidths[i] = hlim::getOutputWidth(m_signals[i]);
+        m_signalOffsets[i] = allocator.allocate(m_signalWidths[i]);
+    }
+    m_recordWidth = (allocator.getTotalSize() + BitAllocator::WORD_SIZE-1) / BitAllocator::WORD_SIZE * BitAllocator::WORD_SIZE;
+
+    m_buffer.resize(m_recordWidth * m_capacity);
+    m_lastValues.resize(m_recordWidth);
+    m_times.resize(m_capacity);
+
+    m_stateOffsets.resize(m_signals.size(), SIZE_MAX);
+}
+
+std::uint64_t SignalSubscription::value(size_t recordIdx, size_t signalIdx) const
+{
+    HCL_ASSERT(recordIdx < m_size);
+    HCL_ASSERT(m_signalWidths[signalIdx] <= 64);
+    return m_buffer.extractNonStraddling(DefaultConfig::VALUE, getRecordOffset(recordIdx) + m_signalOffsets[signalIdx], m_signalWidths[signalIdx]);
+}
+
+std::uint64_t SignalSubscription::defined(size_t recordIdx, size_t signalIdx) const
+{
+    HCL_ASSERT(recordIdx < m_size);
+    HCL_ASSERT(m_signalWidths[signalIdx] <= 64);
+    return m_buffer.extractNonStraddling(DefaultConfig::DEFINED, getRecordOffset(recordIdx) + m_signalOffsets[signalIdx], m_signalWidths[signalIdx]);
+}
+
+bool SignalSubscription::allDefined(size_t recordIdx, size_t signalIdx) const
+{
+    HCL_ASSERT(recordIdx < m_size);
+    return sim::allDefined(m_buffer, getRecordOffset(recordIdx) + m_signalOffsets[signalIdx], m_signalWidths[signalIdx]);
+}
+
+void SignalSubscription::pop(size_t count)
+{
+    count = std::min(count, m_size);
+    m_first = (m_first + count) % m_capacity;
+    m_size -= count;
+}
+
+void SignalSubscription::clear()
+{
+    m_first = 0;
+    m_size = 0;
+    m_totalRecords = 0;
+    m_lastValuesValid = false;
+}
+
+void SignalSubscription::bind(std::vector<size_t> stateOffsets)
+{
+    HCL_ASSERT(stateOffsets.size() == m_signals.size());
+    m_stateOffsets = std::move(stateOffsets);
+    m_lastValuesValid = false;
+}
+
+bool SignalSubscription::signalChanged(const DefaultBitVectorState &state, size_t signalIdx) const
+{
+    size_t width = m_signalWidths[signalIdx];
+    size_t srcOffset = m_stateOffsets[signalIdx];
+    size_t lastOffset = m_signalOffsets[signalIdx];
+
+    for (size_t offset = 0; offset < width; offset += DefaultConfig::NUM_BITS_PER_BLOCK) {
+        size_t chunkSize = std::min<size_t>(DefaultConfig::NUM_BITS_PER_BLOCK, width - offset);
+        auto defined = state.extract(DefaultConfig::DEFINED, srcOffset + offset, chunkSize);
+        auto lastDefined = m_lastValues.extract(DefaultConfig::DEFINED, lastOffset + offset, chunkSize);
+        if (defined != lastDefined) return true;
+
+        auto value = state.extract(DefaultConfig::VALUE, srcOffset + offset, chunkSize);
+        auto lastValue = m_lastValues.extract(DefaultConfig::VALUE, lastOffset + offset, chunkSize);
+        if ((value & defined) != (lastValue & defined)) return true;
+    }
+    return false;
+}
+
+void SignalSubscription::record(const DefaultBitVectorState &state, const hlim::ClockRational &simulationTime)
+{
+    size_t slot;
+    if (m_size < m_capacity) {
+        slot = (m_first + m_size) % m_capacity;
+        m_size++;
+    } else {
+        slot = m_first;
+        m_first = (m_first + 1) % m_capacity;
+    }
+
+    size_t recordOffset = slot * m_recordWidth;
+    for (auto i : utils::Range(m_signals.size())) {
+        if (m_stateOffsets[i] == SIZE_MAX)
+            m_buffer.clearRange(DefaultConfig::DEFINED, recordOffset + m_signalOffsets[i], m_signalWidths[i]);
+        else
+            m_buffer.copyRange(recordOffset + m_signalOffsets[i], state, m_stateOffsets[i], m_signalWidths[i]);
+    }
+    m_times[slot] = simulationTime;
+    m_totalRecords++;
+
+    if (m_onChange) {
+        for (auto i : utils::Range(m_signals.size())) {
+            if (m_stateOffsets[i] == SIZE_MAX) continue;
+            if (!m_lastValuesValid || signalChanged(state, i)) {
+                m_lastValues.copyRange(m_signalOffsets[i], state, m_stateOffsets[i], m_signalWidths[i]);
+                m_onChange(i);
+            }
+        }
+        m_lastValuesValid = true;
+    }
+}
+
+}
@@ -0,0 +1,100 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#pragma once
+
+#include "BitVectorState.h"
+#include "../hlim/NodePort.h"
+#include "../hlim/ClockRational.h"
+
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+namespace gtry::sim {
+
+/**
+ * @brief Records the values of a fixed set of signals on every commit into a ring buffer owned by the caller.
+ * @details The signals are resolved to simulation state offsets once when the program is compiled (or the subscription is added),
+ * recording is then a plain copy per signal without allocations, map lookups, or onSimProcOutputRead callbacks.
+ * Each record holds all signals packed back to back, signals of up to 64 bits never straddle a word.
+ * Once the buffer is full, the oldest records get overwritten.
+ */
+class SignalSubscription
+{
+    public:
+        SignalSubscription(std::vector<hlim::NodePort> signals, size_t capacity);
+
+        /// Registers a callback that is invoked on every commit for each signal whose value or definedness changed since the last commit.
+        /// @details On the first commit, all signals are reported as changed.
+        void setOnChange(std::function<void(size_t signalIdx)> onChange) { m_onChange = std::move(onChange); }
+
+        inline const std::vector<hlim::NodePort> &getSignals() const { return m_signals; }
+        inline size_t getCapacity() const { return m_capacity; }
+        /// Number of records currently held in the buffer, index 0 being the oldest.
+        inline size_t size() const { return m_size; }
+        inline bool empty() const { return m_size == 0; }
+        /// Number of records written since the subscription was created or cleared, including overwritten ones.
+        inline std::uint64_t getTotalRecords() const { return m_totalRecords; }
+
+        /// Width of a record in bits, always a multiple of the word size.
+        inline size_t getRecordWidth() const { return m_recordWidth; }
+        inline size_t getSignalOffset(size_t signalIdx) const { return m_signalOffsets[signalIdx]; }
+        inline size_t getSignalWidth(size_t signalIdx) const { return m_signalWidths[signalIdx]; }
+
+        /// Offset of the given record within getBuffer().
+        inline size_t getRecordOffset(size_t recordIdx) const { return ((m_first + recordIdx) % m_capacity) * m_recordWidth; }
+        inline const hlim::ClockRational &getRecordTime(size_t recordIdx) const { return m_times[(m_first + recordIdx) % m_capacity]; }
+        inline const DefaultBitVectorState &getBuffer() const { return m_buffer; }
+
+        /// Value plane of a signal of up to 64 bits in the given record.
+        std::uint64_t value(size_t recordIdx, size_t signalIdx) const;
+        /// Defined plane of a signal of up to 64 bits in the given record.
+        std::uint64_t defined(size_t recordIdx, size_t signalIdx) const;
+        bool allDefined(size_t recordIdx, size_t signalIdx) const;
+
+        /// Drops the given amount of oldest records.
+        void pop(size_t count = 1);
+        void clear();
+
+        /// Resolves the simulation state offsets of the signals, SIZE_MAX marks signals that are not part of the simulation.
+        void bind(std::vector<size_t> stateOffsets);
+        /// Appends a record with the current values of all signals.
+        void record(const DefaultBitVectorState &state, const hlim::ClockRational &simulationTime);
+    protected:
+        std::vector<hlim::NodePort> m_signals;
+        std::vector<size_t> m_signalWidths;
+        std::vector<size_t> m_signalOffsets;
+        std::vector<size_t> m_stateOffsets;
+        size_t m_recordWidth = 0;
+
+        size_t m_capacity;
+        size_t m_first = 0;
+        size_t m_size = 0;
+        std::uint64_t m_totalRecords = 0;
+
+        DefaultBitVectorState m_buffer;
+        std::vector<hlim::ClockRational> m_times;
+
+        std::function<void(size_t signalIdx)> m_onChange;
+        DefaultBitVectorState m_lastValues;
+        bool m_lastValuesValid = false;
+
+        bool signalChanged(const DefaultBitVectorState &state, size_t signalIdx) const;
+};
+
+}
@@ -0,0 +1,298 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#include "gatery/pch.h"
+#include "SimulationProfiler.h"
+
+#include "ReferenceSimulator.h"
+
+#include "../hlim/Node.h"
+#include "../hlim/NodeGroup.h"
+#include "../utils/Range.h"
+#include "../utils/Exceptions.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <iomanip>
+#include <algorithm>
+
+namespace gtry::sim {
+
+struct SimulationProfiler::GroupStats {
+    struct TypeStats {
+        double ticks = 0.0;
+        std::uint64_t calls = 0;
+        size_t numNodes = 0;
+    };
+
+    std::string name;
+    double selfTicks = 0.0;
+    double totalTicks = 0.0;
+    std::map<std::string, TypeStats> nodeTypes;
+    std::vector<std::unique_ptr<GroupStats>> children;
+
+    void accumulate() {
+        totalTicks = selfTicks;
+        for (auto &c : children) {
+            c->accumulate();
+            totalTicks += c->totalTicks;
+        }
+        std::stable_sort(children.begin(), children.end(), [](const auto &lhs, const auto &rhs) { return lhs->totalTicks > rhs->totalTicks; });
+    }
+};
+
+namespace {
+
+std::string escapeJson(const std::string &str)
+{
+    std::string res;
+    res.reserve(str.size());
+    for (char c : str) {
+        switch (c) {
+            case '"': res += "\\\""; break;
+            case '\\': res += "\\\\"; break;
+            case '\n': res += "\\n"; break;
+            case '\t': res += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)c);
+                    res += buf;
+                } else
+                    res += c;
+        }
+    }
+    return res;
+}
+
+/// Flame graph tools split frames on ';' and the sample count on the last ' '.
+std::string escapeFrame(std::string str)
+{
+    std::replace(str.begin(), str.end(), ';', '_');
+    std::replace(str.begin(), str.end(), ' ', '_');
+    return str;
+}
+
+std::string groupName(const hlim::NodeGroup *group)
+{
+    if (!group->getInstanceName().empty())
+        return group->getInstanceName();
+    if (!group->getName().empty())
+        return group->getName();
+    return "<unnamed>";
+}
+
+}
+
+SimulationProfiler::SimulationProfiler(size_t sampleInterval) : m_sampleInterval(std::max<size_t>(sampleInterval, 1))
+{
+}
+
+void SimulationProfiler::reset(const Program &program)
+{
+    m_executionBlocks.clear();
+    m_executionBlocks.resize(program.m_executionBlocks.size());
+    for (auto i : utils::Range(program.m_executionBlocks.size())) {
+        auto &track = m_executionBlocks[i];
+        for (const auto &step : program.m_executionBlocks[i].getSteps())
+            track.nodes.push_back(step.node);
+        track.profile.resize(track.nodes.size());
+    }
+
+    m_clockDomains.clear();
+    m_clockDomains.resize(program.m_clockDomains.size());
+    for (auto i : utils::Range(program.m_clockDomains.size())) {
+        auto &track = m_clockDomains[i];
+        for (const auto &clockedNode : program.m_clockDomains[i].clockedNodes)
+            track.nodes.push_back(clockedNode.getMappedNode().node);
+        track.profile.resize(track.nodes.size());
+    }
+}
+
+void SimulationProfiler::gatherStats(GroupStats &root) const
+{
+    root.name = "simulation";
+
+    std::map<const hlim::NodeGroup*, GroupStats*> group2stats;
+    std::function<GroupStats*(const hlim::NodeGroup*)> getGroupStats;
+    getGroupStats = [&](const hlim::NodeGroup *group)->GroupStats* {
+        if (group == nullptr) return &root;
+
+        auto it = group2stats.find(group);
+        if (it != group2stats.end()) return it->second;
+
+        GroupStats *parent = getGroupStats(group->getParent());
+        parent->children.push_back(std::make_unique<GroupStats>());
+        GroupStats *stats = parent->children.back().get();
+        stats->name = groupName(group);
+        group2stats[group] = stats;
+        return stats;
+    };
+
+    auto gatherTrack = [&](const Track &track) {
+        for (auto i : utils::Range(track.nodes.size())) {
+            const auto *node = track.nodes[i];
+            const auto &profile = track.profile[i];
+
+            double estimatedTicks = 0.0;
+            if (profile.samples > 0)
+                estimatedTicks = (double) profile.ticks * track.invocations / profile.samples;
+
+            GroupStats *stats = getGroupStats(node->getGroup());
+            stats->selfTicks += estimatedTicks;
+            auto &typeStats = stats->nodeTypes[node->getTypeName()];
+            typeStats.ticks += estimatedTicks;
+            typeStats.calls += track.invocations;
+            typeStats.numNodes++;
+        }
+    };
+
+    for (const auto &track : m_executionBlocks)
+        gatherTrack(track);
+    for (const auto &track : m_clockDomains)
+        gatherTrack(track);
+
+    root.accumulate();
+}
+
+void SimulationProfiler::writeTextReport(std::ostream &stream) const
+{
+    GroupStats root;
+    gatherStats(root);
+
+    double total = std::max(root.totalTicks, 1.0);
+
+    // The report switches to fixed point, restore the caller's formatting afterwards
+    auto flags = stream.flags();
+    auto precision = stream.precision();
+
+    stream << "Simulation profile: " << std::fixed << std::setprecision(0) << root.totalTicks
+           << " ticks (extrapolated from every " << m_sampleInterval << ". evaluation)" << std::endl << std::endl;
+
+    std::map<std::string, GroupStats::TypeStats> typeTotals;
+    std::function<void(const GroupStats&)> gatherTypeTotals;
+    gatherTypeTotals = [&](const GroupStats &stats) {
+        for (const auto &p : stats.nodeTypes) {
+            auto &t = typeTotals[p.first];
+            t.ticks += p.second.ticks;
+            t.calls += p.second.calls;
+            t.numNodes += p.second.numNodes;
+        }
+        for (const auto &c : stats.children)
+            gatherTypeTotals(*c);
+    };
+    gatherTypeTotals(root);
+
+    std::vector<std::pair<std::string, GroupStats::TypeStats>> sortedTypes(typeTotals.begin(), typeTotals.end());
+    std::stable_sort(sortedTypes.begin(), sortedTypes.end(), [](const auto &lhs, const auto &rhs) { return lhs.second.ticks > rhs.second.ticks; });
+
+    stream << "Per node type:" << std::endl;
+    stream << std::setw(16) << "ticks" << std::setw(9) << "%" << std::setw(10) << "nodes" << std::setw(14) << "calls" << "  type" << std::endl;
+    for (const auto &p : sortedTypes)
+        stream << std::setw(16) << std::setprecision(0) << p.second.ticks
+               << std::setw(9) << std::setprecision(2) << p.second.ticks / total * 100.0
+               << std::setw(10) << p.second.numNodes
+               << std::setw(14) << p.second.calls
+               << "  " << p.first << std::endl;
+
+    stream << std::endl << "Per node group:" << std::endl;
+    stream << std::setw(16) << "total ticks" << std::setw(9) << "%" << std::setw(16) << "self ticks" << "  group" << std::endl;
+
+    std::function<void(const GroupStats&, size_t)> writeGroup;
+    writeGroup = [&](const GroupStats &stats, size_t depth) {
+        std::string indent(depth*4, ' ');
+        stream << std::setw(16) << std::setprecision(0) << stats.totalTicks
+               << std::setw(9) << std::setprecision(2) << stats.totalTicks / total * 100.0
+               << std::setw(16) << std::setprecision(0) << stats.selfTicks
+               << "  " << indent << stats.name << std::endl;
+
+        for (const auto &p : stats.nodeTypes)
+            stream << std::setw(16) << "" << std::setw(9) << "" << std::setw(16) << std::setprecision(0) << p.second.ticks
+                   << "  " << indent << "  - " << p.first << " (" << p.second.numNodes << " nodes)" << std::endl;
+
+        for (const auto &c : stats.children)
+            writeGroup(*c, depth+1);
+    };
+    writeGroup(root, 0);
+
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
+void SimulationProfiler::writeJsonReport(std::ostream &stream) const
+{
+    GroupStats root;
+    gatherStats(root);
+
+    auto flags = stream.flags();
+    auto precision = stream.precision();
+    stream << std::fixed << std::setprecision(0);
+
+    std::function<void(const GroupStats&, size_t)> writeGroup;
+    writeGroup = [&](const GroupStats &stats, size_t depth) {
+        std::string indent(depth*2, ' ');
+        stream << indent << "{" << std::endl;
+        stream << indent << "  \"name\": \"" << escapeJson(stats.name) << "\"," << std::endl;
+        stream << indent << "  \"totalTicks\": " << stats.totalTicks << "," << std::endl;
+        stream << indent << "  \"selfTicks\": " << stats.selfTicks << "," << std::endl;
+        stream << indent << "  \"nodeTypes\": [";
+        bool first = true;
+        for (const auto &p : stats.nodeTypes) {
+            stream << (first?"":",") << std::endl;
+            stream << indent << "    { \"type\": \"" << escapeJson(p.first) << "\", \"ticks\": " << p.second.ticks
+                   << ", \"nodes\": " << p.second.numNodes << ", \"calls\": " << p.second.calls << " }";
+            first = false;
+        }
+        stream << std::endl << indent << "  ]," << std::endl;
+        stream << indent << "  \"children\": [";
+        first = true;
+        for (const auto &c : stats.children) {
+            stream << (first?"":",") << std::endl;
+            writeGroup(*c, depth+2);
+            first = false;
+        }
+        stream << std::endl << indent << "  ]" << std::endl;
+        stream << indent << "}";
+    };
+    writeGroup(root, 0);
+    stream << std::endl;
+
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
+void SimulationProfiler::writeFoldedStacks(std::ostream &stream) const
+{
+    GroupStats root;
+    gatherStats(root);
+
+    std::function<void(const GroupStats&, const std::string&)> writeGroup;
+    writeGroup = [&](const GroupStats &stats, const std::string &parentStack) {
+        std::string stack = parentStack.empty()?escapeFrame(stats.name):parentStack + ';' + escapeFrame(stats.name);
+        for (const auto &p : stats.nodeTypes) {
+            auto ticks = (std::uint64_t) p.second.ticks;
+            if (ticks > 0)
+                stream << stack << ';' << escapeFrame(p.first) << ' ' << ticks << '\n';
+        }
+        for (const auto &c : stats.children)
+            writeGroup(*c, stack);
+    };
+    writeGroup(root, {});
+}
+
+}
@@ -0,0 +1,84 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#pragma once
+
+#include <vector>
+#include <ostream>
+#include <cstdint>
+
+namespace gtry::hlim {
+    class BaseNode;
+}
+
+namespace gtry::sim {
+
+struct Program;
+
+/// Accumulated cost of a single node in one execution block or clock domain.
+struct NodeProfile {
+    /// Number of evaluations that were timed.
+    std::uint64_t samples = 0;
+    /// Sum of the rdtsc deltas of all timed evaluations.
+    std::uint64_t ticks = 0;
+};
+
+/**
+ * @brief Attributes simulation time to individual nodes and, through them, to node types and node groups.
+ * @details Only every n-th evaluation of an execution block (and every n-th advance of a clock domain) is timed, all others
+ * take the regular, unprofiled path. Reports extrapolate the timed evaluations to all evaluations.
+ */
+class SimulationProfiler
+{
+    public:
+        SimulationProfiler(size_t sampleInterval = 16);
+
+        /// Rebuilds all counters for a freshly compiled program.
+        void reset(const Program &program);
+
+        /// Registers an evaluation of the execution block and returns the per step profile if this evaluation is to be timed, nullptr otherwise.
+        NodeProfile *sampleExecutionBlock(size_t blockIdx) { return sample(m_executionBlocks[blockIdx]); }
+        /// Registers an advance of the clock domain and returns the per clocked node profile if this advance is to be timed, nullptr otherwise.
+        NodeProfile *sampleClockDomain(size_t clockDomainIdx) { return sample(m_clockDomains[clockDomainIdx]); }
+
+        /// Writes the per node type totals followed by the node group hierarchy in human readable form.
+        void writeTextReport(std::ostream &stream) const;
+        /// Writes the node group hierarchy with per node type costs as json.
+        void writeJsonReport(std::ostream &stream) const;
+        /// Writes "group;subgroup;nodeType ticks" lines as consumed by flamegraph.pl and compatible viewers.
+        void writeFoldedStacks(std::ostream &stream) const;
+    protected:
+        struct Track {
+            std::vector<const hlim::BaseNode*> nodes;
+            std::vector<NodeProfile> profile;
+            std::uint64_t invocations = 0;
+        };
+
+        size_t m_sampleInterval;
+        std::vector<Track> m_executionBlocks;
+        std::vector<Track> m_clockDomains;
+
+        NodeProfile *sample(Track &track) {
+            if (track.invocations++ % m_sampleInterval != 0) return nullptr;
+            return track.profile.data();
+        }
+
+        struct GroupStats;
+        void gatherStats(GroupStats &root) const;
+};
+
+}
@@ -45,6 +45,7 @@ class RunTimeSimulationContext;
 class WaitFor;
 class WaitUntil;
 class WaitClock;
+class SignalSubscription;
 
 class Simulator
 {
@@ -100,6 +101,10 @@ class Simulator
         virtual std::array<bool, DefaultConfig::NUM_PLANES> getValueOfClock(const hlim::Clock *clk) = 0;
         //virtual std::array<bool, DefaultConfig::NUM_PLANES> getValueOfReset(const std::string &reset) = 0;
 
+        /// Starts recording the subscribed signals on every commit. The subscription must stay alive until it is removed again.
+        virtual void addSubscription(SignalSubscription &subscription) = 0;
+        virtual void removeSubscription(SignalSubscription &subscription) = 0;
+
         inline const hlim::ClockRational &getCurrentSimulationTime() { return m_simulationTime; }
 
         virtual void addSimulationProcess(std::function<SimulationProcess()> simProc) = 0;
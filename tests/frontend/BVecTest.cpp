@@ -21,6 +21,8 @@
 #include <boost/test/data/test_case.hpp>
 #include <boost/test/data/monomorphic.hpp>
 
+#include <gatery/hlim/coreNodes/Node_Rewire.h>
+
 using namespace boost::unit_test;
 
 using UnitTestSimulationFixture = gtry::UnitTestSimulationFixture;
@@ -205,3 +207,30 @@ BOOST_FIXTURE_TEST_CASE(BVecSelectorAccess, UnitTestSimulationFixture)
 
     eval();
 }
+
+BOOST_FIXTURE_TEST_CASE(BVecSliceAssignmentCoalescing, UnitTestSimulationFixture)
+{
+    using namespace gtry;
+
+    BVec in = "x12345678";
+
+    BVec reversed = "32b0";
+    for (size_t i = 0; i < 32; ++i)
+        reversed[i] = in[31 - i];
+
+    BVec swapped = "32b0";
+    for (size_t i = 0; i < 32; i += 8)
+        swapped(i, 8) = in(24 - i, 8);
+
+    size_t numMultiInputRewires = 0;
+    for (auto &node : design.getCircuit().getNodes())
+        if (auto *rewire = dynamic_cast<hlim::Node_Rewire*>(node.get()))
+            if (rewire->getNumInputPorts() > 1)
+                numMultiInputRewires++;
+    BOOST_TEST(numMultiInputRewires == 2);
+
+    sim_assert(reversed == "x1E6A2C48");
+    sim_assert(swapped == "x78563412");
+
+    eval();
+}
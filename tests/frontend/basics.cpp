@@ -21,6 +21,10 @@
 #include <boost/test/data/test_case.hpp>
 #include <boost/test/data/monomorphic.hpp>
 
+#include <gatery/hlim/coreNodes/Node_Arithmetic.h>
+#include <gatery/hlim/coreNodes/Node_PipelineRegister.h>
+#include <gatery/hlim/coreNodes/Node_Register.h>
+
 using namespace boost::unit_test;
 
 const auto optimizationLevels = data::make({0, 1, 2, 3});
@@ -1175,3 +1179,231 @@ BOOST_FIXTURE_TEST_CASE(msbBroadcast, UnitTestSimulationFixture)
 
     runEvalOnlyTest();
 }
+
+BOOST_DATA_TEST_CASE_F(UnitTestSimulationFixture, PipelineRegisterRetiming, data::make({false, true}), retime)
+{
+    using namespace gtry;
+
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(10'000));
+    ClockScope clockScope(clock);
+
+    BVec a = pinIn(8_b);
+    BVec b = pinIn(8_b);
+    BVec c = pinIn(8_b);
+
+    BVec result = pipeline(((((a + b) ^ c) + c) & a) + b, 3);
+    pinOut(result);
+
+    auto reference = [](std::uint64_t a, std::uint64_t b, std::uint64_t c) { return (((((a + b) ^ c) + c) & a) + b) & 0xFF; };
+
+    addSimulationProcess([=, this, &clock]()->SimProcess {
+        std::vector<std::uint64_t> expected;
+        for (std::uint64_t i = 0; i < 20; i++) {
+            if (i >= 3) {
+                BOOST_TEST(simu(result).defined() == 0xFF);
+                BOOST_TEST(simu(result) == expected[i-3]);
+            }
+
+            std::uint64_t x = i * 37 + 5, y = i * 11 + 100, z = i * 73;
+            simu(a) = x & 0xFF;
+            simu(b) = y & 0xFF;
+            simu(c) = z & 0xFF;
+            expected.push_back(reference(x, y, z));
+
+            co_await WaitClk(clock);
+        }
+        stopTest();
+    });
+
+    if (retime) {
+        design.getCircuit().postprocess(DefaultPostprocessing{});
+
+        size_t numRegisters = 0;
+        size_t numRegistersInsideLogic = 0;
+        for (auto &node : design.getCircuit().getNodes()) {
+            BOOST_TEST(dynamic_cast<hlim::Node_PipelineRegister*>(node.get()) == nullptr);
+            if (auto *reg = dynamic_cast<hlim::Node_Register*>(node.get())) {
+                numRegisters++;
+                for (auto nh : reg->exploreOutput(0).skipDependencies()) {
+                    if (nh.isSignal()) continue;
+                    if (dynamic_cast<hlim::Node_Register*>(nh.node()) == nullptr && dynamic_cast<hlim::Node_Pin*>(nh.node()) == nullptr)
+                        numRegistersInsideLogic++;
+                    nh.backtrack();
+                }
+            }
+        }
+        BOOST_TEST(numRegisters > 3);
+        BOOST_TEST(numRegistersInsideLogic > 0);
+    }
+
+    runTest(100u / clock.getClk()->getAbsoluteFrequency());
+}
+
+BOOST_FIXTURE_TEST_CASE(PipelineRegisterRetimingFeedback, UnitTestSimulationFixture)
+{
+    using namespace gtry;
+
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(10'000));
+    ClockScope clockScope(clock);
+
+    Bit clear = pinIn();
+
+    // The output of the pipeline register feeds back into the logic in front of it.
+    BVec counter = 8_b;
+    BVec next = counter + 1;
+    IF(clear)
+        next = 0;
+    counter = pipeline(next, 2);
+    pinOut(counter);
+
+    // Unobserved, so the fed back signal becomes part of the region that is retimed.
+    BVec unobserved = 8_b;
+    unobserved = pipeline(unobserved + 1, 2);
+
+    addSimulationProcess([=, this, &clock]()->SimProcess {
+        std::vector<std::uint64_t> nextValues;
+        for (std::uint64_t i = 0; i < 20; i++) {
+            bool doClear = i < 2 || i == 11;
+            simu(clear) = doClear;
+
+            std::uint64_t current = 0;
+            if (i >= 2) {
+                current = nextValues[i-2];
+                BOOST_TEST(simu(counter).defined() == 0xFF);
+                BOOST_TEST(simu(counter) == current);
+            }
+            nextValues.push_back(doClear ? 0 : (current + 1) & 0xFF);
+
+            co_await WaitClk(clock);
+        }
+        stopTest();
+    });
+
+    design.getCircuit().postprocess(DefaultPostprocessing{});
+
+    size_t numRegisters = 0;
+    for (auto &node : design.getCircuit().getNodes()) {
+        BOOST_TEST(dynamic_cast<hlim::Node_PipelineRegister*>(node.get()) == nullptr);
+        if (dynamic_cast<hlim::Node_Register*>(node.get()))
+            numRegisters++;
+    }
+    BOOST_TEST(numRegisters >= 4);
+    BOOST_TEST(numRegisters < 16);
+
+    runTest(100u / clock.getClk()->getAbsoluteFrequency());
+}
+
+BOOST_FIXTURE_TEST_CASE(MergeEquivalentNodes, UnitTestSimulationFixture)
+{
+    using namespace gtry;
+
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(10'000));
+    ClockScope clockScope(clock);
+
+    BVec x = pinIn(8_b);
+    BVec y = pinIn(8_b);
+
+    BVec a = (x + y) & "8xF0";
+    BVec b = (y + x) & "8xF0";
+    pinOut(a);
+    pinOut(b);
+
+    addSimulationProcess([=, this, &clock]()->SimProcess {
+        for (std::uint64_t i = 0; i < 10; i++) {
+            simu(x) = i * 29;
+            simu(y) = i * 71;
+            co_await WaitClk(clock);
+            BOOST_TEST(simu(a) == ((i * 29 + i * 71) & 0xF0));
+            BOOST_TEST(simu(b) == ((i * 29 + i * 71) & 0xF0));
+        }
+        stopTest();
+    });
+
+    auto countAdders = [&] {
+        size_t count = 0;
+        for (auto &node : design.getCircuit().getNodes())
+            if (dynamic_cast<hlim::Node_Arithmetic*>(node.get()))
+                count++;
+        return count;
+    };
+
+    BOOST_TEST(countAdders() == 2);
+    design.getCircuit().postprocess(DefaultPostprocessing{});
+    BOOST_TEST(countAdders() == 1);
+
+    runTest(100u / clock.getClk()->getAbsoluteFrequency());
+}
+
+BOOST_FIXTURE_TEST_CASE(MergeEquivalentNodesKeepsReferencedNodes, UnitTestSimulationFixture)
+{
+    using namespace gtry;
+
+    BVec x = pinIn(8_b);
+    pinOut(x & "8xF0");
+
+    // Equivalent to the constant above, but still referenced after postprocessing.
+    BVecDefault mask = 0xF0;
+    auto *maskNode = mask.getNodePort().node;
+    BOOST_REQUIRE(dynamic_cast<hlim::Node_Constant*>(maskNode) != nullptr);
+
+    design.getCircuit().postprocess(DefaultPostprocessing{});
+
+    bool found = false;
+    for (auto &node : design.getCircuit().getNodes())
+        if (node.get() == maskNode)
+            found = true;
+    BOOST_TEST(found);
+}
+
+BOOST_FIXTURE_TEST_CASE(DeeplyNestedConditionalAssignment, UnitTestSimulationFixture)
+{
+    using namespace gtry;
+
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(10'000));
+    ClockScope clockScope(clock);
+
+    const size_t depth = 16;
+
+    BVec sel = pinIn(BitWidth{depth});
+    BVec value = pinIn(8_b);
+
+    BVec out = "8b0";
+    std::function<void(size_t)> nest = [&](size_t level) {
+        if (level == depth) return;
+        IF (sel[level]) {
+            out = value + level;
+            nest(level + 1);
+        } ELSE {
+            out += level;
+        }
+    };
+    nest(0);
+    pinOut(out);
+
+    auto reference = [&](std::uint64_t sel, std::uint64_t value) {
+        std::uint64_t out = 0;
+        for (size_t level = 0; level < depth; level++) {
+            if (sel & (1ull << level)) {
+                out = (value + level) & 0xFF;
+            } else {
+                out = (out + level) & 0xFF;
+                break;
+            }
+        }
+        return out;
+    };
+
+    addSimulationProcess([=, this, &clock]()->SimProcess {
+        for (std::uint64_t s : {0x0000ull, 0x0001ull, 0x00FFull, 0x0F0Full, 0x7FFFull, 0xFFFFull, 0xBFFFull}) {
+            simu(sel) = s;
+            simu(value) = s * 13 + 7;
+            co_await WaitClk(clock);
+            BOOST_TEST(simu(out) == reference(s, (s * 13 + 7) & 0xFF));
+        }
+        stopTest();
+    });
+
+    design.getCircuit().postprocess(DefaultPostprocessing{});
+
+    runTest(100u / clock.getClk()->getAbsoluteFrequency());
+}
@@ -0,0 +1,327 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#include "frontend/pch.h"
+#include <boost/test/unit_test.hpp>
+#include <boost/test/data/dataset.hpp>
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/data/monomorphic.hpp>
+
+#include <gatery/hlim/CircuitCache.h>
+#include <gatery/frontend/ElaborationCache.h>
+#include <gatery/hlim/postprocessing/MemoryDetector.h>
+#include <gatery/export/vhdl/VHDLExport.h>
+#include <gatery/simulation/ReferenceSimulator.h>
+
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+
+using namespace boost::unit_test;
+using UnitTestSimulationFixture = gtry::BoostUnitTestSimulationFixture;
+
+namespace {
+
+void buildCounterAndRom(gtry::DesignScope &design)
+{
+    using namespace gtry;
+    using namespace gtry::sim;
+
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+    ClockScope clkScp(clock);
+
+    Memory<BVec> rom(16, 4_b);
+    rom.fillPowerOnState(createDefaultBitVectorState(16, 4, [](std::size_t i, std::size_t *words){
+        words[DefaultConfig::VALUE] = (i * 7) % 16;
+        words[DefaultConfig::DEFINED] = ~0ull;
+    }));
+
+    BVec counter = 4_b;
+    counter = reg(counter + 1, "4b0");
+    pinOut(reg(rom[counter])).setName("romOut");
+    pinOut(counter).setName("counter");
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+}
+
+std::string serialize(const gtry::hlim::Circuit &circuit)
+{
+    std::ostringstream stream;
+    circuit.serialize(stream);
+    return stream.str();
+}
+
+const gtry::hlim::MemoryGroup *findMemoryGroup(const gtry::hlim::NodeGroup *group)
+{
+    if (auto *memGrp = dynamic_cast<const gtry::hlim::MemoryGroup*>(group))
+        return memGrp;
+    for (const auto &child : group->getChildren())
+        if (auto *memGrp = findMemoryGroup(child.get()))
+            return memGrp;
+    return nullptr;
+}
+
+/// Accumulates the xor of both inputs.
+std::vector<gtry::SignalReadPort> buildAccumulator(gtry::ElaborationCache &cache, const gtry::BVec &a, const gtry::BVec &b)
+{
+    using namespace gtry;
+
+    return cache.elaborate("accumulator", "v1", { a.getReadPort(), b.getReadPort() }, [](const std::vector<SignalReadPort> &inputs) {
+        BVec x = inputs[0];
+        BVec y = inputs[1];
+        BVec acc = 8_b;
+        acc = reg(acc ^ x ^ y, "8b0");
+        return std::vector<SignalReadPort>{ acc.getReadPort() };
+    });
+}
+
+/// Simulates the circuit for a number of events and records the values of all output pins after each event, keyed by pin name.
+std::map<std::string, std::vector<std::string>> simulateOutputs(const gtry::hlim::Circuit &circuit, size_t numEvents)
+{
+    using namespace gtry;
+
+    std::map<std::string, hlim::NodePort> outputs;
+    for (const auto &node : circuit.getNodes())
+        if (auto *pin = dynamic_cast<const hlim::Node_Pin*>(node.get()))
+            if (pin->isOutputPin())
+                outputs[pin->getName()] = pin->getDriver(0);
+
+    sim::ReferenceSimulator simulator;
+    simulator.compileProgram(circuit);
+    simulator.powerOn();
+
+    std::map<std::string, std::vector<std::string>> trace;
+    for ([[maybe_unused]] auto i : gtry::utils::Range(numEvents)) {
+        simulator.advanceEvent();
+        for (const auto &[name, driver] : outputs) {
+            std::stringstream value;
+            value << simulator.getValueOfOutput(driver);
+            trace[name].push_back(value.str());
+        }
+    }
+    return trace;
+}
+}
+
+BOOST_FIXTURE_TEST_CASE(CircuitSerialization_RoundTrip, UnitTestSimulationFixture)
+{
+    using namespace gtry;
+
+    buildCounterAndRom(design);
+    const auto &original = design.getCircuit();
+
+    std::string bytes = serialize(original);
+
+    hlim::Circuit loaded;
+    std::istringstream stream(bytes);
+    loaded.deserialize(stream);
+
+    BOOST_TEST(loaded.getNodes().size() == original.getNodes().size());
+    BOOST_TEST(loaded.getClocks().size() == original.getClocks().size());
+    BOOST_TEST(serialize(loaded) == bytes);
+
+    auto *memGrp = findMemoryGroup(loaded.getRootNodeGroup());
+    BOOST_REQUIRE(memGrp != nullptr);
+    BOOST_TEST(memGrp->getMemory() != nullptr);
+    BOOST_TEST(memGrp->getReadPorts().size() == 1);
+
+    hlim::Circuit truncated;
+    std::istringstream truncatedStream(bytes.substr(0, bytes.size()/2));
+    BOOST_CHECK_THROW(truncated.deserialize(truncatedStream), gtry::utils::DesignError);
+}
+
+BOOST_FIXTURE_TEST_CASE(CircuitSerialization_SimulationMatches, UnitTestSimulationFixture)
+{
+    using namespace gtry;
+
+    buildCounterAndRom(design);
+
+    hlim::Circuit loaded;
+    std::istringstream stream(serialize(design.getCircuit()));
+    loaded.deserialize(stream);
+
+    auto originalTrace = simulateOutputs(design.getCircuit(), 64);
+    auto loadedTrace = simulateOutputs(loaded, 64);
+    BOOST_TEST(originalTrace.size() == 2);
+    BOOST_TEST((originalTrace == loadedTrace));
+
+    auto tmp = std::filesystem::temp_directory_path() / "gatery_circuit_serialization_test";
+    std::filesystem::remove_all(tmp);
+
+    vhdl::VHDLExport exportLoaded(tmp);
+    exportLoaded(loaded);
+    BOOST_TEST(!std::filesystem::is_empty(tmp));
+
+    std::filesystem::remove_all(tmp);
+}
+
+BOOST_FIXTURE_TEST_CASE(CircuitCache_StoreLoad, UnitTestSimulationFixture)
+{
+    using namespace gtry;
+
+    buildCounterAndRom(design);
+
+    auto tmp = std::filesystem::temp_directory_path() / "gatery_circuit_cache_test";
+    std::filesystem::remove_all(tmp);
+
+    hlim::CircuitCache cache(tmp);
+
+    hlim::Circuit missed;
+    BOOST_TEST(!cache.load("counterAndRom", missed));
+    BOOST_TEST(missed.getNodes().empty());
+
+    BOOST_TEST(cache.store("counterAndRom", design.getCircuit()));
+    BOOST_TEST(cache.store("sameDesignOtherKey", design.getCircuit()));
+
+    size_t numCircuitFiles = 0;
+    for ([[maybe_unused]] const auto &entry : std::filesystem::directory_iterator(tmp / "circuits"))
+        numCircuitFiles++;
+    BOOST_TEST(numCircuitFiles == 1);
+
+    hlim::Circuit hit;
+    BOOST_TEST(cache.load("counterAndRom", hit));
+    BOOST_TEST(hlim::CircuitCache::structuralHash(hit) == hlim::CircuitCache::structuralHash(design.getCircuit()));
+
+    hlim::Circuit otherKey;
+    BOOST_TEST(!cache.load("someOtherDesign", otherKey));
+
+    std::filesystem::remove_all(tmp);
+}
+
+BOOST_FIXTURE_TEST_CASE(ElaborationCache_Reuse, UnitTestSimulationFixture)
+{
+    using namespace gtry;
+
+    auto tmp = std::filesystem::temp_directory_path() / "gatery_elaboration_cache_test";
+    std::filesystem::remove_all(tmp);
+
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+    ClockScope clkScp(clock);
+
+    BVec a = pinIn(8_b).setName("a");
+    BVec b = pinIn(8_b).setName("b");
+
+    ElaborationCache cache(tmp);
+    auto first = pinOut(BVec(buildAccumulator(cache, a, b).front())).setName("first");
+    auto second = pinOut(BVec(buildAccumulator(cache, b, a).front())).setName("second");
+    BOOST_TEST(cache.getNumMisses() == 1);
+    BOOST_TEST(cache.getNumHits() == 1);
+
+    addSimulationProcess([=, this]()->SimProcess {
+        std::uint8_t expected = 0;
+        for (auto i : gtry::utils::Range(16)) {
+            simu(a) = i * 3;
+            simu(b) = i * 7;
+            co_await WaitClk(clock);
+            expected ^= std::uint8_t(i * 3) ^ std::uint8_t(i * 7);
+            BOOST_TEST(simu(first).value() == expected);
+            BOOST_TEST(simu(second).value() == expected);
+        }
+        stopTest();
+    });
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+    runTest(hlim::ClockRational(100, 1) / clock.getClk()->getAbsoluteFrequency());
+
+    std::filesystem::remove_all(tmp);
+}
+
+BOOST_AUTO_TEST_CASE(ElaborationCache_RestoreFromDisk)
+{
+    using namespace gtry;
+
+    auto tmp = std::filesystem::temp_directory_path() / "gatery_elaboration_cache_disk_test";
+    std::filesystem::remove_all(tmp);
+
+    auto buildDesign = [&](DesignScope &design, size_t expectedMisses) {
+        Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+        ClockScope clkScp(clock);
+
+        BVec a = pinIn(8_b).setName("a");
+        BVec b = pinIn(8_b).setName("b");
+
+        ElaborationCache cache(tmp);
+        pinOut(BVec(buildAccumulator(cache, a, b).front())).setName("first");
+        pinOut(BVec(buildAccumulator(cache, b, a).front())).setName("second");
+        BOOST_TEST(cache.getNumMisses() == expectedMisses);
+        BOOST_TEST(cache.getNumHits() == 2 - expectedMisses);
+        return design.getCircuit().getNodes().size();
+    };
+
+    size_t numNodes;
+    {
+        DesignScope design;
+        numNodes = buildDesign(design, 1);
+    }
+    {
+        // A later run restores both instances from disk
+        DesignScope design;
+        BOOST_TEST(buildDesign(design, 0) == numNodes);
+    }
+
+    std::filesystem::remove_all(tmp);
+}
+
+BOOST_FIXTURE_TEST_CASE(ElaborationCache_HitRequiresClockScope, UnitTestSimulationFixture)
+{
+    using namespace gtry;
+
+    auto tmp = std::filesystem::temp_directory_path() / "gatery_elaboration_cache_clock_test";
+    std::filesystem::remove_all(tmp);
+
+    BVec a = pinIn(8_b).setName("a");
+    BVec b = pinIn(8_b).setName("b");
+
+    ElaborationCache cache(tmp);
+    {
+        Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+        ClockScope clkScp(clock);
+        buildAccumulator(cache, a, b);
+    }
+    BOOST_TEST(cache.getNumMisses() == 1);
+
+    // The cached accumulator has a register, so it can not be instantiated without a clock
+    size_t numNodes = design.getCircuit().getNodes().size();
+    BOOST_CHECK_THROW(buildAccumulator(cache, b, a), gtry::utils::DesignError);
+    BOOST_TEST(cache.getNumHits() == 1);
+    BOOST_TEST(design.getCircuit().getNodes().size() == numNodes);
+
+    std::filesystem::remove_all(tmp);
+}
+
+BOOST_FIXTURE_TEST_CASE(ElaborationCache_ImplicitInputsAreNotCached, UnitTestSimulationFixture)
+{
+    using namespace gtry;
+
+    auto tmp = std::filesystem::temp_directory_path() / "gatery_elaboration_cache_implicit_test";
+    std::filesystem::remove_all(tmp);
+
+    BVec a = pinIn(8_b).setName("a");
+    BVec hidden = pinIn(8_b).setName("hidden");
+
+    ElaborationCache cache(tmp);
+    for ([[maybe_unused]] auto i : gtry::utils::Range(2))
+        cache.elaborate("adder", "v1", { a.getReadPort() }, [&](const std::vector<SignalReadPort> &inputs) {
+            BVec sum = BVec(inputs[0]) + hidden;
+            return std::vector<SignalReadPort>{ sum.getReadPort() };
+        });
+
+    BOOST_TEST(cache.getNumMisses() == 2);
+    BOOST_TEST(cache.getNumHits() == 0);
+
+    std::filesystem::remove_all(tmp);
+}
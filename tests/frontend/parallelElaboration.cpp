@@ -0,0 +1,132 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#include "frontend/pch.h"
+#include <boost/test/unit_test.hpp>
+#include <boost/test/data/dataset.hpp>
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/data/monomorphic.hpp>
+
+#include <gatery/frontend/ParallelElaboration.h>
+
+using namespace boost::unit_test;
+using UnitTestSimulationFixture = gtry::BoostUnitTestSimulationFixture;
+
+namespace {
+
+/// Adds one conditional accumulator per lane, each lane adds its index on top of the input.
+std::vector<gtry::BVec> buildLanes(size_t numLanes, size_t numThreads, const gtry::BVec &data, const gtry::Bit &enable)
+{
+    using namespace gtry;
+
+    ParallelElaboration parallel(numThreads);
+    for (auto lane : gtry::utils::Range(numLanes))
+        parallel.add("lane", { data.getReadPort(), enable.getReadPort() }, [lane](const std::vector<SignalReadPort> &inputs) {
+            BVec x = inputs[0];
+            Bit en = inputs[1];
+
+            BVec acc = 8_b;
+            BVec next = acc;
+            IF (en)
+                next = acc + x + lane;
+            acc = reg(next, "8b0");
+            return std::vector<SignalReadPort>{ acc.getReadPort() };
+        });
+
+    std::vector<BVec> outputs;
+    for (const auto &laneOutputs : parallel.run())
+        outputs.emplace_back(laneOutputs.front());
+    return outputs;
+}
+
+}
+
+BOOST_FIXTURE_TEST_CASE(ParallelElaboration_Lanes, UnitTestSimulationFixture)
+{
+    using namespace gtry;
+
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+    ClockScope clkScp(clock);
+
+    BVec data = pinIn(8_b).setName("data");
+    Bit enable = pinIn().setName("enable");
+
+    std::vector<OutputPins> outputs;
+    for (auto &lane : buildLanes(16, 4, data, enable))
+        outputs.push_back(pinOut(lane));
+
+    std::set<std::uint64_t> ids;
+    for (const auto &node : design.getCircuit().getNodes())
+        ids.insert(node->getId());
+    BOOST_TEST(ids.size() == design.getCircuit().getNodes().size());
+
+    addSimulationProcess([=, this]()->SimProcess {
+        std::vector<std::uint8_t> expected(outputs.size(), 0);
+        for (auto i : gtry::utils::Range(32)) {
+            bool en = i % 3 != 0;
+            simu(data) = i;
+            simu(enable) = en;
+            co_await WaitClk(clock);
+            for (auto lane : gtry::utils::Range(outputs.size())) {
+                if (en) expected[lane] += std::uint8_t(i + lane);
+                BOOST_TEST(simu(outputs[lane]).value() == expected[lane]);
+            }
+        }
+        stopTest();
+    });
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+    runTest(hlim::ClockRational(100, 1) / clock.getClk()->getAbsoluteFrequency());
+}
+
+BOOST_AUTO_TEST_CASE(ParallelElaboration_DeterministicIds)
+{
+    using namespace gtry;
+
+    auto buildDesign = [](size_t numThreads) {
+        DesignScope design;
+        Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+        ClockScope clkScp(clock);
+
+        BVec data = pinIn(8_b).setName("data");
+        Bit enable = pinIn().setName("enable");
+        for (auto &lane : buildLanes(16, numThreads, data, enable))
+            pinOut(lane);
+
+        std::vector<std::pair<std::uint64_t, std::string>> nodes;
+        for (const auto &node : design.getCircuit().getNodes())
+            nodes.push_back({ node->getId(), node->getTypeName() });
+        return nodes;
+    };
+
+    BOOST_TEST((buildDesign(1) == buildDesign(8)));
+}
+
+BOOST_FIXTURE_TEST_CASE(ParallelElaboration_ImplicitInputsAreRejected, UnitTestSimulationFixture)
+{
+    using namespace gtry;
+
+    BVec a = pinIn(8_b).setName("a");
+    BVec hidden = pinIn(8_b).setName("hidden");
+
+    ParallelElaboration parallel(1);
+    parallel.add("adder", { a.getReadPort() }, [&](const std::vector<SignalReadPort> &inputs) {
+        BVec sum = BVec(inputs[0]) + hidden;
+        return std::vector<SignalReadPort>{ sum.getReadPort() };
+    });
+    BOOST_CHECK_THROW(parallel.run(), gtry::utils::DesignError);
+}
@@ -21,6 +21,12 @@
 #include <boost/test/data/test_case.hpp>
 #include <boost/test/data/monomorphic.hpp>
 
+#include <gatery/simulation/ReferenceSimulator.h>
+#include <gatery/simulation/SignalSubscription.h>
+#include <gatery/simulation/BitAllocator.h>
+
+#include <sstream>
+
 using namespace boost::unit_test;
 using namespace gtry;
 using namespace gtry::utils;
@@ -129,3 +135,131 @@ BOOST_FIXTURE_TEST_CASE(SimProc_PingPong, UnitTestSimulationFixture)
     design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
     runTicks(clock.getClk(), 10);
 }
+
+
+
+BOOST_FIXTURE_TEST_CASE(SimProc_Profiling, UnitTestSimulationFixture)
+{
+    using namespace gtry;
+
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(10'000));
+    {
+        ClockScope clkScp(clock);
+        GroupScope entity(GroupScope::GroupType::ENTITY);
+        entity.setName("profiledEntity");
+
+        BVec counter(8_b);
+        counter = reg(counter, 0);
+        counter += 1;
+        pinOut(counter);
+    }
+
+    auto &simulator = dynamic_cast<sim::ReferenceSimulator&>(getSimulator());
+    simulator.enableProfiling(1);
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+    runTicks(clock.getClk(), 100);
+
+    BOOST_REQUIRE(simulator.getProfiler() != nullptr);
+
+    std::stringstream text, json, folded;
+    simulator.getProfiler()->writeTextReport(text);
+    simulator.getProfiler()->writeJsonReport(json);
+    simulator.getProfiler()->writeFoldedStacks(folded);
+
+    BOOST_TEST(text.str().find("profiledEntity") != std::string::npos);
+    BOOST_TEST(text.str().find("Register") != std::string::npos);
+    BOOST_TEST(json.str().find("\"name\": \"profiledEntity") != std::string::npos);
+    BOOST_TEST(folded.str().find("profiledEntity") != std::string::npos);
+
+    // The reports leave the formatting of the stream untouched
+    text << 1.5;
+    json << 1.5;
+    BOOST_TEST(text.str().ends_with("1.5"));
+    BOOST_TEST(json.str().ends_with("1.5"));
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(SimProc_SignalSubscription, UnitTestSimulationFixture)
+{
+    using namespace gtry;
+
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(10'000));
+    ClockScope clkScp(clock);
+
+    BVec counter(8_b);
+    counter = reg(counter, 0);
+    counter += 1;
+    auto outputPin = pinOut(counter);
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+
+    sim::SignalSubscription subscription({ simu(outputPin).getOutput() }, 8);
+    size_t numChanges = 0;
+    subscription.setOnChange([&](size_t signalIdx) {
+        BOOST_TEST(signalIdx == 0);
+        numChanges++;
+    });
+    getSimulator().addSubscription(subscription);
+
+    runTicks(clock.getClk(), 20);
+
+    BOOST_TEST(subscription.size() == 8);
+    BOOST_TEST(subscription.getTotalRecords() > 8);
+    BOOST_TEST(numChanges >= 20);
+
+    for (auto i : Range(subscription.size())) {
+        BOOST_TEST(subscription.allDefined(i, 0));
+        if (i > 0) {
+            auto prev = subscription.value(i-1, 0);
+            auto cur = subscription.value(i, 0);
+            BOOST_TEST((cur == prev || cur == prev+1));
+            BOOST_TEST(subscription.getRecordTime(i-1) < subscription.getRecordTime(i));
+        }
+    }
+    // Starts at 1 (register reset value plus one) and changes once per rising edge
+    BOOST_TEST(subscription.value(subscription.size()-1, 0) == numChanges);
+
+    subscription.pop(3);
+    BOOST_TEST(subscription.size() == 5);
+
+    getSimulator().removeSubscription(subscription);
+}
+
+BOOST_AUTO_TEST_CASE(BitAllocator_BucketReuse)
+{
+    sim::BitAllocator allocator;
+
+    // Small signals share the word of their bucket
+    size_t first = allocator.allocate(8);
+    BOOST_TEST(allocator.allocate(8) == first + 8);
+    BOOST_TEST(allocator.allocate(5) == first + 16);
+
+    // Other buckets and large signals get their own words
+    size_t other = allocator.allocate(4);
+    BOOST_TEST(other % sim::BitAllocator::WORD_SIZE == 0);
+    BOOST_TEST(other != first);
+    size_t large = allocator.allocate(100);
+    BOOST_TEST(large % sim::BitAllocator::WORD_SIZE == 0);
+
+    // As long as the word of the bucket is within a cache line of the allocation front, it keeps being filled
+    BOOST_TEST(allocator.allocate(8) == first + 24);
+
+    // Once it falls further behind, a new word is started at the front
+    allocator.allocate(sim::BitAllocator::CACHE_LINE_SIZE);
+    size_t front = allocator.getTotalSize();
+    BOOST_TEST(allocator.allocate(8) == front);
+    BOOST_TEST(allocator.allocate(8) == front + 8);
+
+    allocator.alignToCacheLine();
+    size_t aligned = allocator.getTotalSize();
+    BOOST_TEST(aligned % sim::BitAllocator::CACHE_LINE_SIZE == 0);
+    BOOST_TEST(allocator.allocate(8) == aligned);
+
+    // No signal of up to 64 bits straddles a word
+    for (size_t size = 1; size <= 64; size++) {
+        size_t offset = allocator.allocate(size);
+        BOOST_TEST(offset / sim::BitAllocator::WORD_SIZE == (offset + size - 1) / sim::BitAllocator::WORD_SIZE);
+    }
+}
@@ -0,0 +1,97 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#include "frontend/pch.h"
+#include <boost/test/unit_test.hpp>
+#include <boost/test/data/dataset.hpp>
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/data/monomorphic.hpp>
+
+#include <gatery/hlim/TimingAnalysis.h>
+#include <gatery/hlim/coreNodes/Node_Arithmetic.h>
+#include <gatery/hlim/coreNodes/Node_Constant.h>
+#include <gatery/hlim/coreNodes/Node_Register.h>
+
+#include <sstream>
+
+using namespace boost::unit_test;
+using UnitTestSimulationFixture = gtry::BoostUnitTestSimulationFixture;
+
+BOOST_FIXTURE_TEST_CASE(TimingAnalysis_WorstPathsPerClock, UnitTestSimulationFixture)
+{
+    using namespace gtry;
+
+    Clock clockA(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clockA"));
+    Clock clockB(ClockConfig{}.setAbsoluteFrequency(50'000'000).setName("clockB"));
+
+    {
+        ClockScope clkScp(clockA);
+        BVec a = pinIn(8_b);
+        BVec r = reg(a);
+        BVec deep = reg(((r + r) + r) + a);
+        BVec shallow = reg(r ^ a);
+        pinOut(deep);
+        pinOut(shallow);
+    }
+    {
+        ClockScope clkScp(clockB);
+        BVec in = pinIn(4_b);
+        BVec b = reg(in);
+        Bit isZero = reg(b == "4b0");
+        pinOut(isZero);
+    }
+
+    hlim::TimingAnalysis analysis(design.getCircuit());
+
+    auto clocks = analysis.getClocks();
+    BOOST_TEST(clocks.size() == 2);
+
+    auto pathsA = analysis.getWorstPaths(clockA.getClk(), 2);
+    BOOST_REQUIRE(pathsA.size() == 2);
+    BOOST_TEST(pathsA[0].logicLevels == 3);
+    BOOST_TEST(pathsA[1].logicLevels == 1);
+    BOOST_TEST(dynamic_cast<hlim::Node_Register*>(pathsA[0].endPoint.node) != nullptr);
+    BOOST_TEST(dynamic_cast<hlim::Node_Register*>(pathsA[0].outputs.front().node) != nullptr);
+    BOOST_TEST(analysis.getLogicLevels(pathsA[0].outputs.back()) == 3);
+
+    auto pathsB = analysis.getWorstPaths(clockB.getClk(), 10);
+    BOOST_REQUIRE(!pathsB.empty());
+    BOOST_TEST(pathsB[0].logicLevels == 2);
+    BOOST_TEST(dynamic_cast<hlim::Node_Register*>(pathsB[0].outputs.front().node) != nullptr);
+
+    std::stringstream report;
+    analysis.writeReport(report, 3, false);
+    BOOST_TEST(report.str().find("Clock clockA: deepest path has 3 logic levels") != std::string::npos);
+    BOOST_TEST(report.str().find("Clock clockB: deepest path has 2 logic levels") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(TimingAnalysis_ArithmeticScalesWithWidth)
+{
+    using namespace gtry;
+
+    auto adderLevels = [](size_t width) {
+        hlim::Circuit circuit;
+        sim::DefaultBitVectorState value;
+        value.resize(width);
+        auto *operand = circuit.createNode<hlim::Node_Constant>(value, hlim::ConnectionType::BITVEC);
+        auto *add = circuit.createNode<hlim::Node_Arithmetic>(hlim::Node_Arithmetic::ADD);
+        add->connectInput(0, {.node = operand, .port = 0ull});
+        add->connectInput(1, {.node = operand, .port = 0ull});
+        return hlim::estimateLogicLevels(add);
+    };
+    BOOST_TEST(adderLevels(8) < adderLevels(64));
+}
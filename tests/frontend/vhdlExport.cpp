@@ -0,0 +1,92 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#include "frontend/pch.h"
+#include <boost/test/unit_test.hpp>
+#include <boost/test/data/dataset.hpp>
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/data/monomorphic.hpp>
+
+#include <gatery/export/vhdl/VHDLExport.h>
+#include <gatery/export/vhdl/Entity.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace boost::unit_test;
+using UnitTestSimulationFixture = gtry::BoostUnitTestSimulationFixture;
+
+BOOST_FIXTURE_TEST_CASE(VHDLExport_DeduplicateEntities, UnitTestSimulationFixture)
+{
+    using namespace gtry;
+
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+    ClockScope clkScp(clock);
+
+    BVec data = pinIn(8_b).setName("data");
+
+    auto buildLane = [&](size_t increment) {
+        GroupScope entity(GroupScope::GroupType::ENTITY);
+        entity.setName("lane");
+
+        BVec acc = 8_b;
+        acc = reg(acc + data + increment, "8b0");
+        acc.setName("acc");
+        return acc;
+    };
+
+    for (auto i : gtry::utils::Range(4))
+        pinOut(buildLane(1)).setName((boost::format("out%d") % i).str());
+    pinOut(buildLane(2)).setName("other");
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+
+    auto tmp = std::filesystem::temp_directory_path() / "gatery_vhdl_dedup_test";
+    std::filesystem::remove_all(tmp);
+
+    vhdl::VHDLExport vhdl(tmp);
+    vhdl(design.getCircuit());
+
+    size_t numWritten = 0, numDuplicates = 0;
+    for (const auto &entity : vhdl.getAST()->getEntities()) {
+        if (entity->isDuplicate())
+            numDuplicates++;
+        else
+            numWritten++;
+    }
+    BOOST_TEST(numDuplicates == 3);
+    BOOST_TEST(numWritten == 3);
+    BOOST_TEST(vhdl.getAST()->getDependencySortedEntities().size() == 3);
+
+    size_t numEntityFiles = 0;
+    for ([[maybe_unused]] const auto &entry : std::filesystem::directory_iterator(tmp))
+        numEntityFiles++;
+    // Helper package, top, and two lane variants
+    BOOST_TEST(numEntityFiles == 4);
+
+    std::ifstream topFile((tmp / "top.vhdl").string().c_str());
+    std::stringstream top;
+    top << topFile.rdbuf();
+    std::string topCode = top.str();
+    size_t numInstances = 0;
+    for (size_t pos = topCode.find("entity work.lane("); pos != std::string::npos; pos = topCode.find("entity work.lane(", pos+1))
+        numInstances++;
+    BOOST_TEST(numInstances == 4);
+
+    std::filesystem::remove_all(tmp);
+}
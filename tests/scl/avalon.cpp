@@ -0,0 +1,120 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#include "scl/pch.h"
+#include <boost/test/unit_test.hpp>
+#include <boost/test/data/dataset.hpp>
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/data/monomorphic.hpp>
+
+#include <gatery/scl/Avalon.h>
+
+#include <deque>
+
+using namespace boost::unit_test;
+using namespace gtry;
+
+BOOST_DATA_TEST_CASE_F(UnitTestSimulationFixture, AvalonNetworkSection_demuxTree, data::make({ 0, 2, 4 }) * data::make({ false, true }), fanout, registered)
+{
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+    ClockScope clkScp(clock);
+
+    // 20 memories with 16 words each and read latencies of 0 to 2 cycles, two of them in a subsection with wider addresses
+    const size_t numPorts = 20;
+    scl::AvalonNetworkSection net;
+    scl::AvalonNetworkSection& sub = net.addSection("sub");
+    for (size_t p = 0; p < numPorts; ++p)
+    {
+        scl::AvalonMM slave;
+        slave.address = 4_b;
+        slave.read = Bit{};
+        slave.write = Bit{};
+        slave.writeData = 16_b;
+        slave.readData = 16_b;
+        slave.readLatency = p % 3;
+        scl::attachMem(slave);
+
+        if (p < 2)
+            sub.add("mem" + std::to_string(p), std::move(slave));
+        else
+            net.add("mem" + std::to_string(p), std::move(slave));
+    }
+
+    scl::AvalonMM mm = net.demux(fanout, registered);
+    mm.pinIn("mm");
+
+    // port index | port address, the subsection is the last port of the root section
+    auto address = [](size_t p, size_t word) -> size_t {
+        if (p < 2)
+            return (numPorts - 2) << 5 | p << 4 | word;
+        return (p - 2) << 5 | word;
+    };
+
+    const size_t readLatency = mm.readLatency;
+    BOOST_TEST(!mm.readDataValid);
+    if (fanout == 0 && !registered)
+        BOOST_TEST(readLatency == 2);
+    if (fanout != 0 && registered)
+        BOOST_TEST(readLatency > 2);
+
+    bool checked = false;
+    addSimulationProcess([&, readLatency]()->SimProcess {
+        std::mt19937 rng{ 9871 };
+        std::vector<std::array<uint16_t, 16>> reference(numPorts);
+
+        simu(*mm.read) = 0;
+        for (size_t p = 0; p < numPorts; ++p)
+            for (size_t w = 0; w < 16; ++w)
+            {
+                reference[p][w] = uint16_t(rng());
+                simu(mm.address) = address(p, w);
+                simu(*mm.write) = 1;
+                simu(*mm.writeData) = reference[p][w];
+                co_await WaitClk(clock);
+            }
+        simu(*mm.write) = 0;
+
+        for (size_t i = 0; i < 8; ++i)
+            co_await WaitClk(clock);
+
+        // back to back reads, each response arrives after the fixed read latency
+        std::deque<std::pair<size_t, uint16_t>> pending;
+        for (size_t cycle = 0; cycle < 512; ++cycle)
+        {
+            const size_t p = rng() % numPorts;
+            const size_t w = rng() % 16;
+            const bool read = cycle < 500 && rng() % 4 != 0;
+            simu(mm.address) = address(p, w);
+            simu(*mm.read) = read;
+            if (read)
+                pending.emplace_back(cycle + readLatency, reference[p][w]);
+
+            if (!pending.empty() && pending.front().first == cycle)
+            {
+                BOOST_TEST(simu(*mm.readData) == pending.front().second);
+                pending.pop_front();
+            }
+            co_await WaitClk(clock);
+        }
+        BOOST_TEST(pending.empty());
+        checked = true;
+    });
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+    runTicks(clock.getClk(), 20 * 16 + 8 + 520);
+    BOOST_TEST(checked);
+}
@@ -0,0 +1,389 @@
+/*  This file is part of Gatery, a library for circuit design.
+    Copyright (C) 2021 Michael Offel, Andreas Ley
+
+    Gatery is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 3 of the License, or (at your option) any later version.
+
+    Gatery is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#include "scl/pch.h"
+#include <boost/test/unit_test.hpp>
+#include <boost/test/data/dataset.hpp>
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/data/monomorphic.hpp>
+
+#include <gatery/scl/hardCores/BlockRam.h>
+#include <gatery/scl/hardCores/blockRam/XilinxTrueDualPortBlockRam.h>
+#include <gatery/export/vhdl/VHDLExport.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace boost::unit_test;
+using namespace gtry;
+
+namespace {
+
+/// Exports the circuit and returns the concatenated content of all written files.
+std::string exportVHDL(hlim::Circuit &circuit, const std::string &name)
+{
+    auto tmp = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(tmp);
+
+    vhdl::VHDLExport vhdl(tmp);
+    vhdl(circuit);
+
+    std::stringstream content;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(tmp))
+        if (entry.is_regular_file())
+            content << std::ifstream(entry.path().string().c_str()).rdbuf();
+
+    std::filesystem::remove_all(tmp);
+    return content.str();
+}
+
+}
+
+BOOST_DATA_TEST_CASE_F(UnitTestSimulationFixture, Ram_readWrite, data::make({ true, false }), inOrder)
+{
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+    ClockScope clkScp(clock);
+
+    scl::Ram<BVec> ram(1024, 8_b);
+    auto conflict = inOrder ? scl::PortConflict::inOrder : scl::PortConflict::dontCare;
+    ram.portConflicts(conflict, conflict, conflict);
+
+    BVec wrAddr = pinIn(10_b).setName("wrAddr");
+    BVec wrData = pinIn(8_b).setName("wrData");
+    Bit wrEn = pinIn().setName("wrEn");
+    BVec rdAddr = pinIn(10_b).setName("rdAddr");
+
+    IF(wrEn)
+        ram[wrAddr] = wrData;
+    BVec rdData = reg(ram[rdAddr]);
+    auto rdDataPin = pinOut(rdData).setName("rdData");
+
+    size_t numMemories = 0, numPorts = 0;
+    for (auto &node : design.getCircuit().getNodes()) {
+        if (dynamic_cast<hlim::Node_Memory*>(node.get())) numMemories++;
+        if (dynamic_cast<hlim::Node_MemPort*>(node.get())) numPorts++;
+    }
+    BOOST_TEST(numMemories == 1);
+    BOOST_TEST(numPorts == 2);
+
+    addSimulationProcess([&, inOrder]()->SimProcess {
+        simu(wrEn) = '1';
+        for (size_t i = 0; i < 64; ++i)
+        {
+            simu(wrAddr) = i * 13;
+            simu(wrData) = uint8_t(i * 3);
+            simu(rdAddr) = i * 13;
+            co_await WaitClk(clock);
+            if (inOrder)
+                BOOST_TEST(simu(rdDataPin) == uint8_t(i * 3));
+        }
+        simu(wrEn) = '0';
+
+        for (size_t i = 0; i < 64; ++i)
+        {
+            simu(rdAddr) = i * 13;
+            co_await WaitClk(clock);
+            BOOST_TEST(simu(rdDataPin) == uint8_t(i * 3));
+        }
+    });
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+    runTicks(clock.getClk(), 200);
+}
+
+BOOST_FIXTURE_TEST_CASE(Rom_constantDefault, UnitTestSimulationFixture)
+{
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+    ClockScope clkScp(clock);
+
+    scl::Rom<BVec> rom(100, BVec("8b10100101"));
+
+    BVec addr = pinIn(7_b).setName("addr");
+    auto dataPin = pinOut(reg(rom[addr])).setName("data");
+
+    addSimulationProcess([&]()->SimProcess {
+        for (size_t i = 0; i < 100; i += 7)
+        {
+            simu(addr) = i;
+            co_await WaitClk(clock);
+            BOOST_TEST(simu(dataPin) == 0xA5);
+        }
+    });
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+    runTicks(clock.getClk(), 20);
+}
+
+BOOST_FIXTURE_TEST_CASE(Rom_nonConstantDefault, UnitTestSimulationFixture)
+{
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+    ClockScope clkScp(clock);
+
+    // derived from constants and a bit width, so it can be evaluated at construction time
+    BVec constantDefault = pack(BVec("4b1010"), BVec(4_b)) ^ "8x0F";
+    scl::Rom<BVec> rom(16, constantDefault);
+
+    BVec pinDefault = pinIn(8_b).setName("pinDefault");
+    BOOST_CHECK_THROW(scl::Rom<BVec>(16, pinDefault), gtry::utils::DesignError);
+    BOOST_CHECK_THROW(scl::Ram<BVec>(16, reg(constantDefault)), gtry::utils::DesignError);
+}
+
+BOOST_FIXTURE_TEST_CASE(Ram_byteEnable, UnitTestSimulationFixture)
+{
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+    ClockScope clkScp(clock);
+
+    scl::Ram<BVec> ram(1024, 16_b);
+
+    BVec wrAddr = pinIn(10_b).setName("wrAddr");
+    BVec wrData = pinIn(16_b).setName("wrData");
+    BVec wrByteEnable = pinIn(2_b).setName("wrByteEnable");
+    Bit wrEn = pinIn().setName("wrEn");
+    BVec rdAddr = pinIn(10_b).setName("rdAddr");
+
+    IF(wrEn)
+        ram[wrAddr].byteEnable(wrByteEnable) = wrData;
+    auto rdDataPin = pinOut(reg(ram[rdAddr])).setName("rdData");
+
+    addSimulationProcess([&]()->SimProcess {
+        simu(wrEn) = '1';
+        simu(wrByteEnable) = 3;
+        for (size_t i = 0; i < 32; ++i)
+        {
+            simu(wrAddr) = i;
+            simu(wrData) = 0x1111 * (i % 8);
+            co_await WaitClk(clock);
+        }
+        for (size_t i = 0; i < 32; ++i)
+        {
+            simu(wrAddr) = i;
+            simu(wrData) = 0xFFFF;
+            simu(wrByteEnable) = i % 3;
+            co_await WaitClk(clock);
+        }
+        simu(wrEn) = '0';
+
+        for (size_t i = 0; i < 32; ++i)
+        {
+            simu(rdAddr) = i;
+            co_await WaitClk(clock);
+
+            size_t expected = 0x1111 * (i % 8);
+            if (i % 3 & 1) expected |= 0x00FF;
+            if (i % 3 & 2) expected |= 0xFF00;
+            BOOST_TEST(simu(rdDataPin) == expected);
+        }
+    });
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+    runTicks(clock.getClk(), 120);
+}
+
+BOOST_FIXTURE_TEST_CASE(XilinxTrueDualPortBlockRam_simulation, UnitTestSimulationFixture)
+{
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+    ClockScope clkScp(clock);
+
+    auto *bram = DesignScope::createNode<scl::blockram::XilinxTrueDualPortBlockRam>(16, 16, 8);
+    bram->setClocks(clock.getClk(), clock.getClk());
+
+    Bit enA = pinIn().setName("enA");
+    BVec weA = pinIn(2_b).setName("weA");
+    BVec addrA = pinIn(4_b).setName("addrA");
+    BVec dinA = pinIn(16_b).setName("dinA");
+    BVec addrB = pinIn(4_b).setName("addrB");
+
+    bram->connectPort(scl::blockram::XilinxTrueDualPortBlockRam::PORT_A, enA, weA, addrA, dinA);
+    bram->connectPort(scl::blockram::XilinxTrueDualPortBlockRam::PORT_B, Bit('1'), BVec("2b00"), addrB, BVec("16b0"));
+
+    auto doutA = pinOut(bram->getReadData(scl::blockram::XilinxTrueDualPortBlockRam::PORT_A)).setName("doutA");
+    auto doutB = pinOut(bram->getReadData(scl::blockram::XilinxTrueDualPortBlockRam::PORT_B)).setName("doutB");
+
+    addSimulationProcess([&]()->SimProcess {
+        simu(enA) = '1';
+        simu(weA) = 3;
+        simu(addrA) = 5;
+        simu(dinA) = 0x1234;
+        simu(addrB) = 0;
+        co_await WaitClk(clock);
+        // Write first: the written word appears on the output of the writing port
+        BOOST_TEST(simu(doutA) == 0x1234);
+
+        simu(weA) = 2;
+        simu(dinA) = 0xABCD;
+        simu(addrB) = 5;
+        co_await WaitClk(clock);
+        BOOST_TEST(simu(doutA) == 0xAB34);
+        // Reading an address the other port writes in the same cycle is undefined
+        BOOST_TEST(simu(doutB).defined() != 0xFFFF);
+
+        simu(enA) = '0';
+        co_await WaitClk(clock);
+        BOOST_TEST(simu(doutA) == 0xAB34);
+        BOOST_TEST(simu(doutB) == 0xAB34);
+    });
+
+    runTicks(clock.getClk(), 10);
+}
+
+BOOST_DATA_TEST_CASE_F(UnitTestSimulationFixture, Memory_orderedByteEnableWrites, data::make({ true, false }), firstHasByteEnable)
+{
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+    ClockScope clkScp(clock);
+
+    Memory<BVec> mem(4, 16_b);
+    mem.setPowerOnStateZero();
+
+    BVec wrAddr1 = pinIn(2_b).setName("wrAddr1");
+    BVec wrData1 = pinIn(16_b).setName("wrData1");
+    BVec wrByteEnable1 = pinIn(2_b).setName("wrByteEnable1");
+    Bit wrEn1 = pinIn().setName("wrEn1");
+    BVec wrAddr2 = pinIn(2_b).setName("wrAddr2");
+    BVec wrData2 = pinIn(16_b).setName("wrData2");
+    BVec wrByteEnable2 = pinIn(2_b).setName("wrByteEnable2");
+    Bit wrEn2 = pinIn().setName("wrEn2");
+    BVec rdAddr = pinIn(2_b).setName("rdAddr");
+
+    IF(wrEn1) {
+        if (firstHasByteEnable)
+            mem[wrAddr1].write(wrData1, wrByteEnable1);
+        else
+            mem[wrAddr1] = wrData1;
+    }
+    IF(wrEn2)
+        mem[wrAddr2].write(wrData2, wrByteEnable2);
+    // Reads after both writes, so it must see the lanes of both writes merged in order.
+    auto rdDataPin = pinOut(mem[rdAddr]).setName("rdData");
+
+    addSimulationProcess([&, firstHasByteEnable]()->SimProcess {
+        std::mt19937 rng{ 1337 };
+        std::array<std::uint16_t, 4> model = {};
+
+        auto writeLanes = [](std::uint16_t word, std::uint16_t data, size_t byteEnable) {
+            for (auto lane : gtry::utils::Range(2))
+                if (byteEnable & (1ull << lane)) {
+                    std::uint16_t mask = 0xFF << (lane * 8);
+                    word = (word & ~mask) | (data & mask);
+                }
+            return word;
+        };
+
+        for ([[maybe_unused]] auto i : gtry::utils::Range(256))
+        {
+            size_t addr1 = rng() % 4, addr2 = rng() % 4, addr = rng() % 4;
+            std::uint16_t data1 = rng(), data2 = rng();
+            size_t byteEnable1 = rng() % 4, byteEnable2 = rng() % 4;
+            bool en1 = rng() % 4 != 0, en2 = rng() % 4 != 0;
+
+            simu(wrAddr1) = addr1;
+            simu(wrData1) = data1;
+            simu(wrByteEnable1) = byteEnable1;
+            simu(wrEn1) = en1;
+            simu(wrAddr2) = addr2;
+            simu(wrData2) = data2;
+            simu(wrByteEnable2) = byteEnable2;
+            simu(wrEn2) = en2;
+            simu(rdAddr) = addr;
+
+            if (en1)
+                model[addr1] = writeLanes(model[addr1], data1, firstHasByteEnable ? byteEnable1 : 3);
+            if (en2)
+                model[addr2] = writeLanes(model[addr2], data2, byteEnable2);
+
+            BOOST_TEST(simu(rdDataPin) == model[addr]);
+            co_await WaitClk(clock);
+        }
+
+        simu(wrEn1) = '0';
+        simu(wrEn2) = '0';
+        for (auto addr : gtry::utils::Range(4))
+        {
+            simu(rdAddr) = addr;
+            co_await WaitClk(clock);
+            BOOST_TEST(simu(rdDataPin) == model[addr]);
+        }
+    });
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+    runTicks(clock.getClk(), 270);
+}
+
+BOOST_FIXTURE_TEST_CASE(Memory_byteEnableExport, UnitTestSimulationFixture)
+{
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+    ClockScope clkScp(clock);
+
+    Memory<BVec> mem(16, 16_b);
+    mem.noConflicts();
+
+    for (auto i : gtry::utils::Range(2)) {
+        BVec wrAddr = pinIn(4_b).setName((boost::format("wrAddr%d") % i).str());
+        BVec wrData = pinIn(16_b).setName((boost::format("wrData%d") % i).str());
+        BVec wrByteEnable = pinIn(2_b).setName((boost::format("wrByteEnable%d") % i).str());
+        Bit wrEn = pinIn().setName((boost::format("wrEn%d") % i).str());
+        IF(wrEn)
+            mem[wrAddr].write(wrData, wrByteEnable);
+    }
+    BVec rdAddr = pinIn(4_b).setName("rdAddr");
+    pinOut(reg(mem[rdAddr])).setName("rdData");
+    BVec asyncRdAddr = pinIn(4_b).setName("asyncRdAddr");
+    pinOut(mem[asyncRdAddr]).setName("asyncRdData");
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+
+    std::string vhdl = exportVHDL(design.getCircuit(), "gatery_byte_enable_export_test");
+    // Both write ports are in the same clocked process, so the memory stays a signal that also triggers the async read process
+    BOOST_TEST(vhdl.find("SIGNAL memory : mem_type") != std::string::npos);
+    BOOST_TEST(vhdl.find("SHARED VARIABLE") == std::string::npos);
+    BOOST_TEST(vhdl.find("(15 downto 8) <= ") != std::string::npos);
+    BOOST_TEST(vhdl.find("(7 downto 0) <= ") != std::string::npos);
+    BOOST_TEST(vhdl.find("(0) = '1') THEN") != std::string::npos);
+    BOOST_TEST(vhdl.find("(1) = '1') THEN") != std::string::npos);
+    BOOST_TEST(vhdl.find("PROCESS(all)") != std::string::npos);
+}
+
+BOOST_FIXTURE_TEST_CASE(XilinxTrueDualPortBlockRam_export, UnitTestSimulationFixture)
+{
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+    ClockScope clkScp(clock);
+
+    auto *bram = DesignScope::createNode<scl::blockram::XilinxTrueDualPortBlockRam>(16, 16, 8);
+    bram->setClocks(clock.getClk(), clock.getClk());
+
+    Bit enA = pinIn().setName("enA");
+    BVec weA = pinIn(2_b).setName("weA");
+    BVec addrA = pinIn(4_b).setName("addrA");
+    BVec dinA = pinIn(16_b).setName("dinA");
+    BVec addrB = pinIn(4_b).setName("addrB");
+
+    bram->connectPort(scl::blockram::XilinxTrueDualPortBlockRam::PORT_A, enA, weA, addrA, dinA);
+    bram->connectPort(scl::blockram::XilinxTrueDualPortBlockRam::PORT_B, Bit('1'), BVec("2b00"), addrB, BVec("16b0"));
+
+    pinOut(bram->getReadData(scl::blockram::XilinxTrueDualPortBlockRam::PORT_A)).setName("doutA");
+    pinOut(bram->getReadData(scl::blockram::XilinxTrueDualPortBlockRam::PORT_B)).setName("doutB");
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+
+    std::string vhdl = exportVHDL(design.getCircuit(), "gatery_xpm_tdpram_export_test");
+    BOOST_TEST(vhdl.find("LIBRARY XPM;") != std::string::npos);
+    BOOST_TEST(vhdl.find(": entity XPM.xpm_memory_tdpram") != std::string::npos);
+    BOOST_TEST(vhdl.find("WRITE_MODE_A => \"write_first\"") != std::string::npos);
+    // Bit vectors are exported as UNSIGNED and converted at the ports of the vendor primitive
+    BOOST_TEST(vhdl.find("addra => STD_LOGIC_VECTOR(") != std::string::npos);
+    BOOST_TEST(vhdl.find("UNSIGNED(douta) => ") != std::string::npos);
+}
@@ -21,6 +21,9 @@
 #include <boost/test/data/test_case.hpp>
 #include <boost/test/data/monomorphic.hpp>
 
+#include <gatery/hlim/coreNodes/Node_Multiplexer.h>
+#include <gatery/scl/memoryMap/AvalonMM.h>
+
 extern "C"
 {
 #include <gatery/scl/crypto/TabulationHashingDriver.h>
@@ -275,6 +278,192 @@ BOOST_FIXTURE_TEST_CASE(Md5, gtry::sim::UnitTestSimulationFixture)
 	eval(design.getCircuit());
 }
 
+namespace
+{
+	using Block = std::array<uint8_t, 64>;
+
+	uint32_t refRotl(uint32_t v, uint32_t s) { return s ? (v << s) | (v >> (32 - s)) : v; }
+	uint32_t refRotr(uint32_t v, uint32_t s) { return refRotl(v, 32 - s); }
+	uint32_t loadBE(const uint8_t* p) { return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | p[3]; }
+	uint32_t loadLE(const uint8_t* p) { return uint32_t(p[3]) << 24 | uint32_t(p[2]) << 16 | uint32_t(p[1]) << 8 | p[0]; }
+
+	void storeBE(std::vector<uint8_t>& out, uint32_t v) { for (int i = 3; i >= 0; --i) out.push_back(uint8_t(v >> (i * 8))); }
+	void storeLE(std::vector<uint8_t>& out, uint32_t v) { for (int i = 0; i < 4; ++i) out.push_back(uint8_t(v >> (i * 8))); }
+
+	// single block compression functions starting from the standard initial values
+	std::vector<uint8_t> refSha1(const Block& block)
+	{
+		uint32_t w[80];
+		for (size_t i = 0; i < 16; ++i) w[i] = loadBE(&block[i * 4]);
+		for (size_t i = 16; i < 80; ++i) w[i] = refRotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+		const uint32_t iv[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+		uint32_t a = iv[0], b = iv[1], c = iv[2], d = iv[3], e = iv[4];
+		for (size_t i = 0; i < 80; ++i)
+		{
+			uint32_t f, k;
+			if (i < 20)			{ f = (b & c) | (~b & d);			k = 0x5A827999; }
+			else if (i < 40)	{ f = b ^ c ^ d;					k = 0x6ED9EBA1; }
+			else if (i < 60)	{ f = (b & c) | (b & d) | (c & d);	k = 0x8F1BBCDC; }
+			else				{ f = b ^ c ^ d;					k = 0xCA62C1D6; }
+			uint32_t tmp = refRotl(a, 5) + f + e + k + w[i];
+			e = d; d = c; c = refRotl(b, 30); b = a; a = tmp;
+		}
+
+		std::vector<uint8_t> digest;
+		for (uint32_t v : { a + iv[0], b + iv[1], c + iv[2], d + iv[3], e + iv[4] })
+			storeBE(digest, v);
+		return digest;
+	}
+
+	std::vector<uint8_t> refSha256(const Block& block)
+	{
+		uint32_t w[64];
+		for (size_t i = 0; i < 16; ++i) w[i] = loadBE(&block[i * 4]);
+		for (size_t i = 16; i < 64; ++i)
+		{
+			uint32_t s0 = refRotr(w[i - 15], 7) ^ refRotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+			uint32_t s1 = refRotr(w[i - 2], 17) ^ refRotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+			w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+		}
+
+		const uint32_t iv[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+		uint32_t v[8];
+		std::copy(std::begin(iv), std::end(iv), v);
+		for (size_t i = 0; i < 64; ++i)
+		{
+			uint32_t s1 = refRotr(v[4], 6) ^ refRotr(v[4], 11) ^ refRotr(v[4], 25);
+			uint32_t ch = (v[4] & v[5]) ^ (~v[4] & v[6]);
+			uint32_t tmp1 = v[7] + s1 + ch + scl::Sha2_256<>::K[i] + w[i];
+			uint32_t s0 = refRotr(v[0], 2) ^ refRotr(v[0], 13) ^ refRotr(v[0], 22);
+			uint32_t maj = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
+			for (size_t j = 7; j > 0; --j)
+				v[j] = v[j - 1];
+			v[4] += tmp1;
+			v[0] = tmp1 + s0 + maj;
+		}
+
+		std::vector<uint8_t> digest;
+		for (size_t i = 0; i < 8; ++i)
+			storeBE(digest, v[i] + iv[i]);
+		return digest;
+	}
+
+	std::vector<uint8_t> refMd5(const Block& block)
+	{
+		uint32_t w[16];
+		for (size_t i = 0; i < 16; ++i) w[i] = loadLE(&block[i * 4]);
+
+		const uint32_t iv[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+		uint32_t a = iv[0], b = iv[1], c = iv[2], d = iv[3];
+		for (uint32_t i = 0; i < 64; ++i)
+		{
+			uint32_t f, g;
+			switch (i / 16) {
+			case 0: f = (b & c) | (~b & d); g = i;         break;
+			case 1: f = (d & b) | (~d & c); g = 5 * i + 1; break;
+			case 2: f = b ^ c ^ d;          g = 3 * i + 5; break;
+			default:f = c ^ (b | ~d);       g = 7 * i;
+			}
+			uint32_t tmp = refRotl(a + f + scl::Md5Generator<>::K[i] + w[g % 16], scl::Md5Generator<>::S[i / 16 * 4 + i % 4]);
+			a = d; d = c; c = b; b = b + tmp;
+		}
+
+		std::vector<uint8_t> digest;
+		for (uint32_t v : { a + iv[0], b + iv[1], c + iv[2], d + iv[3] })
+			storeLE(digest, v);
+		return digest;
+	}
+
+	template<typename THash>
+	void testHashPipeline(gtry::sim::UnitTestSimulationFixture& fixture, std::vector<uint8_t>(*reference)(const Block&), size_t latency, const char* emptyDigest)
+	{
+		DesignScope design;
+
+		Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+		ClockScope clockScope(clock);
+
+		// the first message byte is the most significant byte of the block
+		BVec block = pinIn(512_b).setName("block");
+
+		THash hash;
+		hash.beginBlock(block);
+		scl::HashEngine<THash>{ 1, latency }.buildRoundProcessor(0, hash);
+		hash.endBlock();
+		BVec digest = hash.finalize();
+		pinOut(digest).setName("digest");
+
+		size_t numMuxes = 0;
+		for (auto& node : design.getCircuit().getNodes())
+			if (dynamic_cast<hlim::Node_Multiplexer*>(node.get()))
+				numMuxes++;
+		BOOST_TEST(numMuxes == 0);
+
+		const size_t numBlocks = 2048;
+		std::vector<Block> blocks(numBlocks);
+		std::mt19937 rng{ 2024 };
+		for (size_t i = 1; i < numBlocks; ++i)
+			for (uint8_t& byte : blocks[i])
+				byte = uint8_t(rng());
+		// padded empty message
+		blocks[0][0] = 0x80;
+
+		std::vector<uint8_t> expectedEmpty;
+		for (size_t i = 0; emptyDigest[i]; i += 2)
+			expectedEmpty.push_back(uint8_t(std::stoul(std::string(emptyDigest + i, 2), nullptr, 16)));
+		BOOST_TEST(reference(blocks[0]) == expectedEmpty);
+
+		size_t checked = 0;
+		fixture.addSimulationProcess([&]()->SimProcess {
+			for (size_t cycle = 0; cycle < numBlocks + latency; ++cycle)
+			{
+				if (cycle < numBlocks)
+				{
+					std::array<uint32_t, 16> words;
+					for (size_t i = 0; i < 16; ++i)
+						words[15 - i] = loadBE(&blocks[cycle][i * 4]);
+					simu(block) = words;
+				}
+
+				if (cycle >= latency)
+				{
+					const std::vector<uint8_t> expected = reference(blocks[cycle - latency]);
+					auto state = simu(digest).eval();
+					bool match = true;
+					for (size_t i = 0; i < expected.size(); ++i)
+					{
+						const size_t offset = (expected.size() - 1 - i) * 8;
+						match &= state.extractNonStraddling(sim::DefaultConfig::DEFINED, offset, 8) == 0xFF;
+						match &= state.extractNonStraddling(sim::DefaultConfig::VALUE, offset, 8) == expected[i];
+					}
+					BOOST_TEST(match, "digest of block " << cycle - latency);
+					checked++;
+				}
+				co_await WaitClk(clock);
+			}
+		});
+
+		design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+		fixture.runTicks(design.getCircuit(), clock.getClk(), uint32_t(numBlocks + latency + 1));
+		BOOST_TEST(checked == numBlocks);
+	}
+}
+
+BOOST_FIXTURE_TEST_CASE(Sha1Pipeline, gtry::sim::UnitTestSimulationFixture)
+{
+	testHashPipeline<scl::Sha1Generator<>>(*this, refSha1, 20, "DA39A3EE5E6B4B0D3255BFEF95601890AFD80709");
+}
+
+BOOST_FIXTURE_TEST_CASE(Sha2_256Pipeline, gtry::sim::UnitTestSimulationFixture)
+{
+	testHashPipeline<scl::Sha2_256<>>(*this, refSha256, 24, "E3B0C44298FC1C149AFBF4C8996FB92427AE41E4649B934CA495991B7852B855");
+}
+
+BOOST_FIXTURE_TEST_CASE(Md5Pipeline, gtry::sim::UnitTestSimulationFixture)
+{
+	testHashPipeline<scl::Md5Generator<>>(*this, refMd5, 16, "D41D8CD98F00B204E9800998ECF8427E");
+}
+
 #if 0
 #include <gatery/vis/MainWindowSimulate.h>
 #include <QApplication>
@@ -578,3 +767,190 @@ BOOST_AUTO_TEST_CASE(TabulationHashingDriverBaseTest)
 
 	tabulation_hashing_destroy(ctx);
 }
+
+namespace
+{
+	uint64_t refSipHash(const std::vector<uint8_t>& msg, uint64_t k0, uint64_t k1)
+	{
+		uint64_t v[4] = { 0x736f6d6570736575ull ^ k0, 0x646f72616e646f6dull ^ k1, 0x6c7967656e657261ull ^ k0, 0x7465646279746573ull ^ k1 };
+		auto rotl = [](uint64_t x, int b) { return (x << b) | (x >> (64 - b)); };
+		auto round = [&]() {
+			v[0] += v[1]; v[1] = rotl(v[1], 13) ^ v[0]; v[0] = rotl(v[0], 32);
+			v[2] += v[3]; v[3] = rotl(v[3], 16) ^ v[2];
+			v[2] += v[1]; v[1] = rotl(v[1], 17) ^ v[2]; v[2] = rotl(v[2], 32);
+			v[0] += v[3]; v[3] = rotl(v[3], 21) ^ v[0];
+		};
+
+		std::vector<uint8_t> padded = msg;
+		padded.resize(msg.size() / 8 * 8 + 8, 0);
+		padded.back() = uint8_t(msg.size());
+
+		for (size_t i = 0; i < padded.size(); i += 8)
+		{
+			uint64_t m = 0;
+			for (size_t b = 0; b < 8; ++b)
+				m |= uint64_t(padded[i + b]) << (b * 8);
+			v[3] ^= m;
+			round();
+			round();
+			v[0] ^= m;
+		}
+
+		v[2] ^= 0xFF;
+		for (size_t i = 0; i < 4; ++i)
+			round();
+		return v[0] ^ v[1] ^ v[2] ^ v[3];
+	}
+}
+
+BOOST_FIXTURE_TEST_CASE(SipHash64MultiBlockHelperTest, gtry::sim::UnitTestSimulationFixture)
+{
+	DesignScope design;
+
+	std::vector<uint8_t> msg(15);
+	std::iota(msg.begin(), msg.end(), uint8_t(0));
+	BOOST_TEST(refSipHash(msg, 0x0706050403020100ull, 0x0F0E0D0C0B0A0908ull) == 0xa129ca6149be45e5ull);
+
+	auto [hash, latency] = scl::sipHash("x0E0D0C0B0A09080706050403020100", "x0F0E0D0C0B0A09080706050403020100", false);
+	BOOST_TEST(latency == 0);
+	sim_assert(hash == 0xa129ca6149be45e5) << hash;
+
+	eval(design.getCircuit());
+}
+
+BOOST_FIXTURE_TEST_CASE(SipHash64WidePipeline, gtry::sim::UnitTestSimulationFixture)
+{
+	DesignScope design;
+
+	Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000));
+	ClockScope clockScope(clock);
+
+	// one 64 byte message and key per cycle
+	InputPins msg = pinIn(512_b).setName("msg");
+	InputPins key = pinIn(128_b).setName("key");
+	auto [hashValue, latency] = scl::sipHash(msg, key);
+	OutputPins hash = pinOut(hashValue).setName("hash");
+	BOOST_TEST(latency == 2 * (2 * 9 + 4));
+
+	const size_t numMessages = 256;
+	std::vector<std::vector<uint8_t>> messages(numMessages, std::vector<uint8_t>(64));
+	std::vector<std::array<uint32_t, 4>> keys(numMessages);
+	std::mt19937 rng{ 2024 };
+	for (size_t i = 0; i < numMessages; ++i)
+	{
+		for (uint8_t& byte : messages[i])
+			byte = uint8_t(rng());
+		for (uint32_t& word : keys[i])
+			word = rng();
+	}
+
+	size_t checked = 0;
+	addSimulationProcess([&]()->SimProcess {
+		for (size_t cycle = 0; cycle < numMessages + latency; ++cycle)
+		{
+			if (cycle < numMessages)
+			{
+				std::array<uint32_t, 16> words;
+				for (size_t i = 0; i < 16; ++i)
+					words[i] = loadLE(&messages[cycle][i * 4]);
+				simu(msg) = words;
+				simu(key) = keys[cycle];
+			}
+
+			if (cycle >= latency)
+			{
+				const std::array<uint32_t, 4>& k = keys[cycle - latency];
+				const uint64_t expected = refSipHash(messages[cycle - latency], k[0] | uint64_t(k[1]) << 32, k[2] | uint64_t(k[3]) << 32);
+				BOOST_TEST(simu(hash) == expected, "hash of message " << cycle - latency);
+				checked++;
+			}
+			co_await WaitClk(clock);
+		}
+	});
+
+	design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+	runTicks(design.getCircuit(), clock.getClk(), uint32_t(numMessages + latency + 1));
+	BOOST_TEST(checked == numMessages);
+}
+
+BOOST_FIXTURE_TEST_CASE(TabulationHashingWidePipeline, gtry::sim::UnitTestSimulationFixture)
+{
+	DesignScope design;
+
+	Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000));
+	ClockScope clockScope(clock);
+
+	const size_t numLanes = 3;
+	scl::TabulationHashing gen{ 32_b };
+	gen.readPortsPerTable(2).xorTreeRegisters(2);
+
+	std::vector<BVec> keys;
+	for (size_t lane = 0; lane < numLanes; ++lane)
+		keys.push_back(pinIn(128_b).setName("key" + std::to_string(lane)));
+
+	std::vector<OutputPins> hashes;
+	for (const BVec& hash : gen(keys))
+		hashes.push_back(pinOut(hash).setName("hash" + std::to_string(hashes.size())));
+
+	BOOST_TEST(gen.numTables() == 16);
+	BOOST_TEST(gen.numReplicas() == 2);
+	BOOST_TEST(gen.latency() == 3);
+
+	scl::AvalonMMSlave avmm{ 8_b, 32_b };
+	gen.addCpuInterface(avmm);
+	scl::pinIn(avmm, "avmm");
+
+	TabulationHashingContext* ctx = tabulation_hashing_init(128, 32, driver_alloc, driver_free);
+	std::deque<std::pair<uint32_t, uint32_t>> mmWrites;
+	tabulation_hashing_set_mm(ctx, [](void* c, uint32_t offset, uint32_t value) {
+		((std::deque<std::pair<uint32_t, uint32_t>>*)c)->emplace_back(offset, value);
+	}, &mmWrites);
+
+	std::mt19937 rng{ 1337 };
+	tabulation_hashing_set_random_content(ctx, driver_random_generator, &rng);
+
+	const size_t numKeys = 256;
+	size_t checked = 0;
+	addSimulationProcess([&]()->SimProcess {
+		for (; !mmWrites.empty(); mmWrites.pop_front())
+		{
+			simu(avmm.write) = '1';
+			simu(avmm.address) = mmWrites.front().first;
+			simu(avmm.writeData) = mmWrites.front().second;
+			co_await WaitClk(clock);
+		}
+		simu(avmm.write) = '0';
+
+		std::deque<std::array<std::array<uint32_t, 4>, numLanes>> inFlight;
+		for (size_t cycle = 0; cycle < numKeys + gen.latency(); ++cycle)
+		{
+			std::array<std::array<uint32_t, 4>, numLanes> laneKeys;
+			for (size_t lane = 0; lane < numLanes; ++lane)
+			{
+				for (uint32_t& word : laneKeys[lane])
+					word = rng();
+				simu(keys[lane]) = laneKeys[lane];
+			}
+			inFlight.push_back(laneKeys);
+
+			if (inFlight.size() > gen.latency())
+			{
+				for (size_t lane = 0; lane < numLanes; ++lane)
+				{
+					uint32_t expected;
+					tabulation_hashing_hash(ctx, inFlight.front()[lane].data(), &expected);
+					BOOST_TEST(simu(hashes[lane]) == expected, "lane " << lane << " cycle " << cycle);
+				}
+				inFlight.pop_front();
+				checked++;
+			}
+			co_await WaitClk(clock);
+		}
+	});
+
+	design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+	runTicks(design.getCircuit(), clock.getClk(), uint32_t(16 * 256 * 2 + numKeys + 16));
+	BOOST_TEST(checked == numKeys);
+
+	tabulation_hashing_destroy(ctx);
+}
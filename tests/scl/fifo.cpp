@@ -34,9 +34,10 @@ struct FifoTest
 {
     FifoTest(Clock& clk) : clk(clk) {}
 
-    scl::Fifo<BVec> create(size_t depth, BitWidth width)
+    scl::Fifo<BVec> create(size_t depth, BitWidth width, scl::FifoLatency latency = scl::FifoLatency::registered)
     {
-        scl::Fifo<BVec> fifo{ depth, BVec{ width } };
+        scl::Fifo<BVec> fifo{ depth, BVec{ width }, latency };
+        this->latency = latency;
         pushData = width;
         popData = width;
         fifo.push(pushData, push);
@@ -61,7 +62,7 @@ struct FifoTest
 
         while (true)
         {
-            if (simu(empty) == 0)
+            if (latency == scl::FifoLatency::registered && simu(empty) == 0)
                 BOOST_TEST(!model.empty());
             if (simu(full) == 1)
                 BOOST_TEST(!model.empty());
@@ -69,6 +70,10 @@ struct FifoTest
             if (simu(push) && !simu(full))
                 model.push(uint8_t(simu(pushData)));
 
+            // a bypass fifo forwards the pushed element in the same cycle, so only check after the push
+            if (latency == scl::FifoLatency::bypass && simu(empty) == 0)
+                BOOST_TEST(!model.empty());
+
             if (!simu(empty))
             {
                 uint8_t peekValue = (uint8_t)simu(popData);
@@ -88,6 +93,7 @@ struct FifoTest
     }
 
     Clock clk;
+    scl::FifoLatency latency = scl::FifoLatency::registered;
 
     BVec pushData;
     Bit push;
@@ -245,3 +251,166 @@ BOOST_FIXTURE_TEST_CASE(Fifo_fuzz, UnitTestSimulationFixture)
 
     runTicks(clock.getClk(), 2048);
 }
+
+BOOST_FIXTURE_TEST_CASE(Fifo_bypass, UnitTestSimulationFixture)
+{
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+    ClockScope clkScp(clock);
+
+    FifoTest fifo{ clock };
+    fifo.create(16, 8_b, scl::FifoLatency::bypass);
+
+    FifoTest registeredFifo{ clock };
+    registeredFifo.create(16, 8_b);
+
+    addSimulationProcess([&]()->SimProcess {
+        for (auto *f : { &fifo, &registeredFifo })
+        {
+            simu(f->pushData) = 0;
+            simu(f->push) = 0;
+            simu(f->pop) = 0;
+        }
+        co_await WaitClk(clock);
+
+        // An element pushed into the empty fifo is visible in the same cycle
+        for (auto *f : { &fifo, &registeredFifo })
+        {
+            simu(f->push) = 1;
+            simu(f->pushData) = 42;
+        }
+        BOOST_TEST(simu(fifo.empty) == 0);
+        BOOST_TEST(simu(fifo.popData) == 42);
+        BOOST_TEST(simu(registeredFifo.empty) == 1);
+
+        // and can be popped right away
+        simu(fifo.pop) = 1;
+        co_await WaitClk(clock);
+        simu(fifo.pop) = 0;
+        for (auto *f : { &fifo, &registeredFifo })
+            simu(f->push) = 0;
+
+        BOOST_TEST(simu(fifo.empty) == 1);
+        BOOST_TEST(simu(registeredFifo.empty) == 0);
+        BOOST_TEST(simu(registeredFifo.popData) == 42);
+        co_await WaitClk(clock);
+
+        std::mt19937 rng{ 8211 };
+        while (true)
+        {
+            if (!simu(fifo.full) && (rng() % 2 == 0))
+            {
+                simu(fifo.push) = 1;
+                simu(fifo.pushData) = uint8_t(rng());
+            }
+            else
+            {
+                simu(fifo.push) = 0;
+            }
+
+            simu(fifo.pop) = !simu(fifo.empty) && (rng() % 2 == 0);
+            co_await WaitClk(clock);
+        }
+    });
+
+    addSimulationProcess(fifo);
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+
+    runTicks(clock.getClk(), 2048);
+}
+
+BOOST_FIXTURE_TEST_CASE(DualClockFifo_fuzz, UnitTestSimulationFixture)
+{
+    Clock pushClock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("push_clock"));
+    Clock popClock(ClockConfig{}.setAbsoluteFrequency(37'000'000).setName("pop_clock"));
+
+    scl::DualClockFifo<BVec> fifo{ 16, BVec{ 8_b }, pushClock, popClock };
+
+    Bit push = pinIn().setName("push_valid");
+    BVec pushData = pinIn(8_b).setName("push_data");
+    Bit pop = pinIn().setName("pop_ready");
+    BVec popData = 8_b;
+    fifo.push(pushData, push);
+    fifo.pop(popData, pop);
+    pinOut(popData).setName("pop_data");
+
+    Bit full = fifo.full();
+    Bit empty = fifo.empty();
+    pinOut(full).setName("full");
+    pinOut(empty).setName("empty");
+    Bit almostFull = fifo.almostFull(12);
+    Bit almostEmpty = fifo.almostEmpty(4);
+    pinOut(almostFull).setName("almost_full");
+    pinOut(almostEmpty).setName("almost_empty");
+
+    std::queue<uint8_t> model;
+    size_t numPopped = 0;
+    bool sawFull = false;
+    bool sawAlmostFull = false;
+
+    addSimulationProcess([&]()->SimProcess {
+        simu(push) = 0;
+        simu(pushData) = 0;
+
+        std::mt19937 rng{ 1337 };
+        uint8_t counter = 0;
+        while (true)
+        {
+            sawFull |= simu(full) == 1;
+            sawAlmostFull |= simu(almostFull) == 1;
+            if (simu(almostFull) == 0)
+                BOOST_TEST(model.size() < 12);
+
+            if (!simu(full) && (rng() % 4 != 0))
+            {
+                simu(push) = 1;
+                simu(pushData) = counter;
+                model.push(counter++);
+            }
+            else
+            {
+                simu(push) = 0;
+            }
+            co_await WaitClk(pushClock);
+        }
+    });
+
+    addSimulationProcess([&]()->SimProcess {
+        simu(pop) = 0;
+
+        std::mt19937 rng{ 4711 };
+        while (true)
+        {
+            if (simu(almostEmpty) == 0)
+                BOOST_TEST(model.size() >= 4);
+
+            if (!simu(empty))
+            {
+                BOOST_TEST(!model.empty());
+                if (!model.empty())
+                    BOOST_TEST(simu(popData) == model.front());
+            }
+
+            if (!simu(empty) && (rng() % 8 != 0))
+            {
+                simu(pop) = 1;
+                if (!model.empty())
+                    model.pop();
+                numPopped++;
+            }
+            else
+            {
+                simu(pop) = 0;
+            }
+            co_await WaitClk(popClock);
+        }
+    });
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+
+    runTicks(pushClock.getClk(), 2048);
+
+    BOOST_TEST(sawFull);
+    BOOST_TEST(sawAlmostFull);
+    BOOST_TEST(numPopped > 500);
+}
@@ -24,8 +24,13 @@
 extern "C"
 {
 #include <gatery/scl/kvs/TinyCuckooDriver.h>
+#include <gatery/scl/kvs/BucketCuckooDriver.h>
 }
 
+#include <gatery/scl/kvs/BucketCuckoo.h>
+#include <gatery/scl/memoryMap/AvalonMM.h>
+#include <chrono>
+
 using namespace boost::unit_test;
 using namespace gtry;
 
@@ -242,6 +247,266 @@ BOOST_DATA_TEST_CASE_F(gtry::sim::UnitTestSimulationFixture, TinyCuckooTableLook
     runTicks(design.getCircuit(), clock.getClk(), 4096);
 }
 
+BOOST_DATA_TEST_CASE_F(gtry::sim::UnitTestSimulationFixture, TinyCuckooMultiLaneLookup, data::make({ 1, 3 }) * data::make({ 0, 1, 3 }), numLanes, latency)
+{
+    DesignScope design;
+
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000));
+    ClockScope clockScope(clock);
+
+    const size_t numTables = 2;
+    const BitWidth keySize{ numTables * 4 };
+
+    InputPin update = pinIn().setName("update");
+    InputPins updateTableIdx = pinIn(1_b).setName("updateTableIdx");
+    InputPins updateItemIdx = pinIn(4_b).setName("updateItemIdx");
+    InputPin updateItemValid = pinIn().setName("updateItemValid");
+    InputPins updateItemKey = pinIn(keySize).setName("updateItemKey");
+    InputPins updateItemValue = pinIn(8_b).setName("updateItemValue");
+
+    scl::TinyCuckooMultiIn params{
+        .update = {
+            .valid = update,
+            .tableIdx = updateTableIdx,
+            .itemIdx = updateItemIdx,
+            .item = {
+                .valid = updateItemValid,
+                .key = updateItemKey,
+                .value = updateItemValue
+            }
+        },
+        .numTables = numTables,
+        .latency = size_t(latency),
+        .readPortsPerMemory = 2,
+    };
+
+    std::vector<BVec> lookupKeys;
+    for (size_t l = 0; l < size_t(numLanes); ++l)
+    {
+        lookupKeys.push_back(pinIn(keySize).setName("key" + std::to_string(l)));
+        params.lookups.push_back({ .key = lookupKeys.back(), .hash = lookupKeys.back(), .userData = 0 });
+    }
+
+    scl::TinyCuckooMultiOut result = scl::tinyCuckooMultiLane(params);
+    for (size_t l = 0; l < size_t(numLanes); ++l)
+    {
+        pinOut(result.lookups[l].found).setName("found" + std::to_string(l));
+        pinOut(result.lookups[l].value).setName("value" + std::to_string(l));
+    }
+
+    const size_t invalid = std::numeric_limits<size_t>::max();
+    std::vector<std::vector<std::pair<size_t, size_t>>> state{
+        numTables,
+        std::vector<std::pair<size_t, size_t>>{ 16, std::make_pair(invalid, invalid) }
+    };
+
+    addSimulationProcess([&]()->SimProcess {
+        std::mt19937 rng{ 1337 };
+        std::vector<std::deque<size_t>> inFlight(numLanes);
+        std::vector<size_t> recentKeys{ 0 };
+
+        for (size_t cycle = 0; cycle < 2048; ++cycle)
+        {
+            // results reflect all updates of previous cycles
+            for (size_t l = 0; l < size_t(numLanes); ++l)
+            {
+                size_t key = rng() % 2 ? recentKeys[rng() % recentKeys.size()] : rng() & 0xFF;
+                simu(lookupKeys[l]) = key;
+                inFlight[l].push_back(key);
+                if (inFlight[l].size() <= size_t(latency))
+                    continue;
+
+                key = inFlight[l].front();
+                inFlight[l].pop_front();
+
+                size_t expected = invalid;
+                for (size_t t = 0; t < numTables; ++t)
+                    if (state[t][(key >> (t * 4)) & 0xF].first == key)
+                        expected = state[t][(key >> (t * 4)) & 0xF].second;
+
+                if (expected == invalid)
+                    BOOST_TEST(simu(result.lookups[l].found) == 0, "lane " << l << " cycle " << cycle);
+                else
+                {
+                    BOOST_TEST(simu(result.lookups[l].found) == 1, "lane " << l << " cycle " << cycle);
+                    BOOST_TEST(simu(result.lookups[l].value) == expected, "lane " << l << " cycle " << cycle);
+                }
+            }
+
+            simu(update) = '0';
+            if (rng() % 3 == 0)
+            {
+                const size_t key = rng() & 0xFF;
+                const size_t value = rng() & 0xFF;
+                const size_t tableIdx = rng() % numTables;
+                const size_t itemIdx = (key >> (tableIdx * 4)) & 0xF;
+
+                simu(update) = '1';
+                simu(updateItemKey) = key;
+                simu(updateItemValue) = value;
+                simu(updateTableIdx) = tableIdx;
+                simu(updateItemIdx) = itemIdx;
+
+                if (rng() % 5 == 0)
+                {
+                    simu(updateItemValid) = '0';
+                    state[tableIdx][itemIdx] = std::make_pair(invalid, invalid);
+                }
+                else
+                {
+                    simu(updateItemValid) = '1';
+                    state[tableIdx][itemIdx] = std::make_pair(key, value);
+                    recentKeys.push_back(key);
+                }
+            }
+
+            co_await WaitClk(clock);
+        }
+    });
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+    runTicks(design.getCircuit(), clock.getClk(), 2048);
+}
+
+BOOST_DATA_TEST_CASE_F(gtry::sim::UnitTestSimulationFixture, TinyCuckooMultiLaneInsert, data::make({ 40, 47 }) ^ data::make({ 8, 2 }), numKeys, maxDisplacements)
+{
+    DesignScope design;
+
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000));
+    ClockScope clockScope(clock);
+
+    const size_t numTables = 3;
+    const size_t numLanes = 4;
+    const size_t latency = 2;
+
+    InputPin insertValid = pinIn().setName("insertValid");
+    InputPins insertKey = pinIn(16_b).setName("insertKey");
+    InputPins insertValue = pinIn(8_b).setName("insertValue");
+
+    scl::TinyCuckooMultiIn params{
+        .update = {
+            .valid = '0',
+            .tableIdx = "2b0",
+            .itemIdx = "4b0",
+            .item = {
+                .valid = '0',
+                .key = "16b0",
+                .value = "8b0"
+            }
+        },
+        .numTables = numTables,
+        .latency = latency,
+        .readPortsPerMemory = 2,
+        .insert = scl::TinyCuckooInsert{ .valid = insertValid, .key = insertKey, .value = insertValue },
+        .hash = [](const BVec& key) { return key(0, 12_b) ^ rotl(key(4, 12_b), 5); },
+        .insertQueueDepth = 4,
+        .maxDisplacements = size_t(maxDisplacements),
+    };
+
+    std::vector<BVec> lookupKeys;
+    for (size_t l = 0; l < numLanes; ++l)
+    {
+        lookupKeys.push_back(pinIn(16_b).setName("key" + std::to_string(l)));
+        params.lookups.push_back({ .key = lookupKeys.back(), .hash = params.hash(lookupKeys.back()), .userData = 0 });
+    }
+
+    scl::TinyCuckooMultiOut result = scl::tinyCuckooMultiLane(params);
+    for (size_t l = 0; l < numLanes; ++l)
+    {
+        pinOut(result.lookups[l].found).setName("found" + std::to_string(l));
+        pinOut(result.lookups[l].value).setName("value" + std::to_string(l));
+    }
+    pinOut(result.insertReady).setName("insertReady");
+    pinOut(result.insertBusy).setName("insertBusy");
+    pinOut(result.insertFailed).setName("insertFailed");
+    pinOut(result.insertDropped.key).setName("insertDroppedKey");
+
+    bool done = false;
+    addSimulationProcess([&]()->SimProcess {
+        std::mt19937 rng{ 4242 };
+        auto valueOf = [](size_t key) { return (key * 37) & 0xFF; };
+
+        std::vector<size_t> keys;
+        while (keys.size() < size_t(numKeys))
+        {
+            size_t key = rng() & 0xFFFF;
+            if (std::find(keys.begin(), keys.end(), key) == keys.end())
+                keys.push_back(key);
+        }
+
+        std::set<size_t> pushed, placed, dropped;
+        std::vector<std::deque<size_t>> inFlight(numLanes);
+        size_t nextInsert = 0;
+        size_t idleCycles = 0;
+
+        for (size_t cycle = 0; cycle < 4096 && idleCycles < 256; ++cycle)
+        {
+            for (size_t l = 0; l < numLanes; ++l)
+            {
+                // sweep over all keys to catch keys while they are moved, the last lane looks for unknown keys
+                size_t key = keys[(cycle * (numLanes - 1) + l) % keys.size()];
+                if (l == numLanes - 1)
+                    key = rng() & 0xFFFF;
+                simu(lookupKeys[l]) = key;
+                inFlight[l].push_back(key);
+                if (inFlight[l].size() <= latency)
+                    continue;
+
+                key = inFlight[l].front();
+                inFlight[l].pop_front();
+
+                const bool found = simu(result.lookups[l].found) != 0;
+                if (found)
+                {
+                    BOOST_TEST(pushed.contains(key), "unknown key found in cycle " << cycle);
+                    BOOST_TEST(!dropped.contains(key), "dropped key found in cycle " << cycle);
+                    BOOST_TEST(simu(result.lookups[l].value) == valueOf(key));
+                    placed.insert(key);
+                }
+                else
+                {
+                    BOOST_TEST(!placed.contains(key), "key " << key << " disappeared in cycle " << cycle);
+                    if (idleCycles > latency && pushed.contains(key))
+                        BOOST_TEST(dropped.contains(key), "key " << key << " missing after all inserts");
+                }
+            }
+
+            if (simu(result.insertFailed))
+            {
+                const size_t key = simu(result.insertDropped.key);
+                BOOST_TEST(pushed.contains(key));
+                dropped.insert(key);
+                placed.erase(key);
+            }
+
+            if (nextInsert == keys.size() && !simu(result.insertBusy))
+                idleCycles++;
+
+            simu(insertValid) = '0';
+            if (nextInsert < keys.size() && simu(result.insertReady) && rng() % 4 != 0)
+            {
+                simu(insertValid) = '1';
+                simu(insertKey) = keys[nextInsert];
+                simu(insertValue) = valueOf(keys[nextInsert]);
+                pushed.insert(keys[nextInsert]);
+                nextInsert++;
+            }
+
+            co_await WaitClk(clock);
+        }
+
+        BOOST_TEST(idleCycles == 256);
+        BOOST_TEST(placed.size() + dropped.size() == keys.size());
+        BOOST_TEST(dropped.size() < keys.size() / 4);
+        BOOST_TEST_MESSAGE("placed " << placed.size() << " of " << keys.size() << " keys, dropped " << dropped.size());
+        done = true;
+    });
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+    runTicks(design.getCircuit(), clock.getClk(), 4096);
+    BOOST_TEST(done);
+}
+
 BOOST_AUTO_TEST_CASE(TinyCuckooDriverBaseTest)
 {
     TinyCuckooContext* ctx = tiny_cuckoo_init(32 * 1024, 4, 32, 32, 
@@ -358,3 +623,222 @@ BOOST_DATA_TEST_CASE(TinyCuckooDriverFuzzTest, data::xrange(0, 3), tableShift)
 
     tiny_cuckoo_destroy(ctx);
 }
+
+BOOST_AUTO_TEST_CASE(BucketCuckooDriverBaseTest)
+{
+    BOOST_TEST(!bucket_cuckoo_init(1000, 2, 4, 32, 32, driver_alloc, driver_free));
+    BOOST_TEST(!bucket_cuckoo_init(3 * 8, 2, 4, 32, 32, driver_alloc, driver_free));
+
+    BucketCuckooContext* ctx = bucket_cuckoo_init(32 * 1024, 2, 4, 32, 32,
+        driver_alloc, driver_free);
+    BOOST_TEST(ctx);
+    BOOST_TEST(bucket_cuckoo_get_hashwidth(ctx) == 24);
+
+    MmTestCtx mmCtx;
+    bucket_cuckoo_set_mm(ctx, MmTestWrite, &mmCtx);
+    bucket_cuckoo_set_hash(ctx, driver_basic_hash, NULL);
+
+    uint32_t testKey = 128;
+    uint32_t testVal = 1337;
+    BOOST_TEST(!bucket_cuckoo_lookup(ctx, &testKey));
+
+    BOOST_TEST(bucket_cuckoo_update(ctx, &testKey, &testVal) == 2);
+    // key and value of empty slots are not written
+    BOOST_TEST(mmCtx.mem.size() == 1 + 3 * 3 + 1);
+    uint32_t testHash[8];
+    driver_basic_hash(NULL, &testKey, testHash);
+    BOOST_TEST(mmCtx.mem[0] == (testHash[0] & 0xFFF));
+    BOOST_TEST(mmCtx.mem[1] == 1);
+    BOOST_TEST(mmCtx.mem[2] == testKey);
+    BOOST_TEST(mmCtx.mem[3] == testVal);
+    BOOST_TEST(mmCtx.mem[4] == 0);
+
+    uint32_t* lookupVal = bucket_cuckoo_lookup(ctx, &testKey);
+    BOOST_TEST(lookupVal);
+    BOOST_TEST(*lookupVal == testVal);
+
+    testVal = ~testVal;
+    BOOST_TEST(bucket_cuckoo_update(ctx, &testKey, &testVal) == 1);
+
+    lookupVal = bucket_cuckoo_lookup(ctx, &testKey);
+    BOOST_TEST(lookupVal);
+    BOOST_TEST(*lookupVal == testVal);
+
+    BOOST_TEST(bucket_cuckoo_remove(ctx, &testKey));
+    BOOST_TEST(mmCtx.mem[1] == 0);
+    BOOST_TEST(!bucket_cuckoo_remove(ctx, &testKey));
+    BOOST_TEST(!bucket_cuckoo_lookup(ctx, &testKey));
+
+    bucket_cuckoo_destroy(ctx);
+}
+
+BOOST_DATA_TEST_CASE(BucketCuckooDriverFillTest, data::make({ 2, 4 }) * data::make({ 2, 4 }), numTables, slotsPerBucket)
+{
+    const uint32_t capacity = 64 * 1024;
+    BucketCuckooContext* ctx = bucket_cuckoo_init(capacity, numTables, slotsPerBucket, 32, 32,
+        driver_alloc, driver_free);
+    BOOST_TEST(ctx);
+
+    MmTestCtx mmCtx;
+    bucket_cuckoo_set_mm(ctx, MmTestWrite, &mmCtx);
+    bucket_cuckoo_set_hash(ctx, driver_basic_hash, NULL);
+
+    std::map<uint32_t, uint32_t> ref;
+    std::mt19937 rng{ 1337 };
+
+    // the chain statistics are collected per 10% of load
+    std::array<size_t, 10> moves{}, inserts{}, maxChain{};
+
+    auto start = std::chrono::steady_clock::now();
+    while (true)
+    {
+        uint32_t key = rng();
+        uint32_t val = rng();
+        if (ref.contains(key))
+            continue;
+
+        const size_t loadBucket = ref.size() * 10 / capacity;
+        int ret = bucket_cuckoo_update(ctx, &key, &val);
+        if (!ret)
+            break;
+        BOOST_TEST(ret != 1);
+        BOOST_TEST(ctx->lastChainLength <= ctx->limitChainDepth);
+
+        inserts[loadBucket]++;
+        moves[loadBucket] += ctx->lastChainLength;
+        maxChain[loadBucket] = std::max<size_t>(maxChain[loadBucket], ctx->lastChainLength);
+        ref[key] = val;
+    }
+    auto duration = std::chrono::steady_clock::now() - start;
+
+    const double load = ref.size() / double(capacity);
+    BOOST_TEST_MESSAGE("tables: " << numTables << ", slots: " << slotsPerBucket << ", load: " << load << ", inserts per second: "
+        << ref.size() / std::chrono::duration<double>(duration).count());
+    for (size_t i = 0; i < inserts.size(); ++i)
+        if (inserts[i])
+            BOOST_TEST_MESSAGE("load " << i * 10 << "%: mean chain " << moves[i] / double(inserts[i]) << ", max chain " << maxChain[i]);
+
+    if (numTables * slotsPerBucket >= 8)
+        BOOST_TEST(load > 0.95);
+    else
+        BOOST_TEST(load > 0.8);
+
+    for (std::pair<uint32_t, uint32_t> kvp : ref)
+    {
+        const uint32_t* it = bucket_cuckoo_lookup(ctx, &kvp.first);
+        BOOST_TEST(it);
+        if (it)
+            BOOST_TEST(*it == kvp.second);
+    }
+
+    uint32_t key, value;
+    size_t numIterated = 0;
+    for (void* it = bucket_cuckoo_iterate(ctx, NULL, &key, &value); it; it = bucket_cuckoo_iterate(ctx, it, &key, &value))
+    {
+        BOOST_TEST(ref[key] == value);
+        numIterated++;
+    }
+    BOOST_TEST(numIterated == ref.size());
+
+    bucket_cuckoo_destroy(ctx);
+}
+
+BOOST_FIXTURE_TEST_CASE(BucketCuckooTableLookup, gtry::sim::UnitTestSimulationFixture)
+{
+    DesignScope design;
+
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000));
+    ClockScope clockScope(clock);
+
+    const uint32_t capacity = 256;
+    BucketCuckooContext* ctx = bucket_cuckoo_init(capacity, 2, 4, 32, 16,
+        driver_alloc, driver_free);
+    bucket_cuckoo_set_hash(ctx, driver_basic_hash, NULL);
+
+    std::deque<std::pair<uint32_t, uint32_t>> mmWrites;
+    bucket_cuckoo_set_mm(ctx, [](void* c, uint32_t offset, uint32_t value) {
+        ((std::deque<std::pair<uint32_t, uint32_t>>*)c)->emplace_back(offset, value);
+    }, &mmWrites);
+
+    scl::BucketCuckoo<BVec, BVec> table{ capacity, 32_b, 16_b, 2, 4 };
+    BOOST_TEST(table.hashWidth().value == bucket_cuckoo_get_hashwidth(ctx));
+
+    InputPins lookupKey = pinIn(32_b).setName("key");
+    InputPins lookupHash = pinIn(table.hashWidth()).setName("hash");
+    auto result = reg(table(lookupKey, lookupHash));
+    OutputPin outFound = pinOut(result.found).setName("out_found");
+    OutputPins outValue = pinOut(result.value).setName("out_value");
+
+    scl::AvalonMMSlave avmm{ 8_b, 32_b };
+    table.addCpuInterface(avmm);
+    scl::pinIn(avmm, "avmm");
+
+    bool done = false;
+    addSimulationProcess([&]()->SimProcess {
+        std::mt19937 rng{ 1337 };
+        std::map<uint32_t, uint32_t> ref;
+        size_t numMoved = 0;
+
+        simu(avmm.write) = '0';
+        for (size_t round = 0; round < 4; ++round)
+        {
+            // remove a third of the items to recycle slots, then fill close to capacity again
+            for (auto it = ref.begin(); it != ref.end();)
+            {
+                uint32_t key = it->first;
+                if (rng() % 3 == 0 && bucket_cuckoo_remove(ctx, &key))
+                    it = ref.erase(it);
+                else
+                    ++it;
+            }
+
+            while (ref.size() < capacity * 9 / 10)
+            {
+                uint32_t key = rng();
+                uint32_t val = rng() & 0xFFFF;
+                int ret = bucket_cuckoo_update(ctx, &key, &val);
+                if (!ret)
+                    break;
+                numMoved += ret == 3;
+                ref[key] = val;
+            }
+
+            for (; !mmWrites.empty(); mmWrites.pop_front())
+            {
+                simu(avmm.write) = '1';
+                simu(avmm.address) = mmWrites.front().first;
+                simu(avmm.writeData) = mmWrites.front().second;
+                co_await WaitClk(clock);
+            }
+            simu(avmm.write) = '0';
+
+            std::vector<uint32_t> keys;
+            for (auto& kvp : ref)
+                keys.push_back(kvp.first);
+            for (size_t i = 0; i < 32; ++i)
+                keys.push_back(rng());
+
+            for (uint32_t key : keys)
+            {
+                uint32_t hash[8];
+                driver_basic_hash(NULL, &key, hash);
+                simu(lookupKey) = key;
+                simu(lookupHash) = hash[0] & ((1u << table.hashWidth().value) - 1);
+                co_await WaitClk(clock);
+
+                auto it = ref.find(key);
+                BOOST_TEST(simu(outFound) == (it != ref.end()));
+                if (it != ref.end())
+                    BOOST_TEST(simu(outValue) == it->second);
+            }
+        }
+        BOOST_TEST(numMoved > 0);
+        done = true;
+    });
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+    runTicks(design.getCircuit(), clock.getClk(), 16384);
+    BOOST_TEST(done);
+
+    bucket_cuckoo_destroy(ctx);
+}
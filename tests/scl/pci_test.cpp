@@ -26,6 +26,8 @@
 #include <gatery/scl/io/pci.h>
 
 #include <queue>
+#include <deque>
+#include <map>
 
 using namespace boost::unit_test;
 using namespace gtry;
@@ -223,3 +225,273 @@ BOOST_FIXTURE_TEST_CASE(pci_AvmmBridge_basic, UnitTestSimulationFixture)
 
     runTicks(clock.getClk(), 190);
 }
+
+struct AvmmBridgeTestParams
+{
+    size_t tlpLength = 1;
+    bool burst = false;
+    BitWidth burstCountWidth = 5_b;
+    size_t maxPayloadSize = 128;
+    uint32_t addressOffset = 0;
+    size_t slaveLatency = 16;
+    size_t numReadWords = 512;
+    // the write tlps follow reads that fill all pending read transactions
+    bool writesBehindReads = false;
+    bool checkThroughput = false;
+    size_t maxCycles = 4096;
+};
+
+struct AvmmBridgeFixture : UnitTestSimulationFixture
+{
+    void runBridge(const AvmmBridgeTestParams& params);
+};
+
+void AvmmBridgeFixture::runBridge(const AvmmBridgeTestParams& params)
+{
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+    ClockScope clkScp(clock);
+
+    const size_t tlpLength = params.tlpLength;
+    const bool burst = params.burst;
+    const size_t maxPayloadWords = params.maxPayloadSize / 4;
+    // bursts are limited to the max payload size
+    const size_t maxBurst = burst ? std::min<size_t>(1ull << (params.burstCountWidth.bits() - 1), maxPayloadWords) : 1;
+    // completions end on the 64 byte read completion boundary unless bursts are larger
+    const size_t cplWords = std::max<size_t>(maxBurst, 16);
+
+    scl::Stream<scl::pci::Tlp> in;
+    in.valid = pinIn().setName("in_valid");
+    BVec inHeader = pinIn(64_b).setName("in_header");
+    BVec inAddress = pinIn(32_b).setName("in_address");
+    in.header = pack(inAddress, inHeader);
+    in.data = pinIn(32_b).setName("in_data");
+    in.ready = Bit{};
+
+    scl::pci::PciId completerId;
+    completerId.bus = 1;
+    completerId.dev = 2;
+    completerId.func = 3;
+
+    scl::AvalonMM avmm;
+    avmm.ready = Bit{};
+    avmm.address = 32_b;
+    avmm.read = Bit{};
+    avmm.write = Bit{};
+    avmm.writeData = 32_b;
+    avmm.readData = 32_b;
+    avmm.readDataValid = Bit{};
+    if (burst)
+        avmm.burstCount = params.burstCountWidth;
+    avmm.maximumPendingReadTransactions = 8;
+
+    scl::pci::AvmmBridge uut{ in, avmm, completerId, 64, params.maxPayloadSize };
+    scl::Stream<scl::pci::Tlp>& out = uut.tx();
+
+    *avmm.ready = pinIn().setName("avmm_ready");
+    *avmm.readData = pinIn(32_b).setName("avmm_readdata");
+    *avmm.readDataValid = pinIn().setName("avmm_readdatavalid");
+
+    auto memContent = [](uint32_t address) { return uint32_t(address * 2654435761u); };
+
+    struct Beat
+    {
+        uint64_t header;
+        uint32_t address;
+        uint32_t data;
+    };
+
+    struct Completion
+    {
+        uint8_t tag;
+        uint32_t address;
+        size_t length;
+    };
+
+    bool checked = false;
+    addSimulationProcess([&]()->SimProcess {
+        std::deque<Beat> rxBeats;
+        std::deque<Completion> expectedCpl;
+        uint8_t tag = 0;
+
+        const uint32_t writeAddress = 0x1000 + params.addressOffset;
+        auto pushWrites = [&]() {
+            for (size_t t = 0; t < 2; ++t)
+                for (size_t w = 0; w < tlpLength; ++w)
+                {
+                    uint32_t address = uint32_t(writeAddress + (t * tlpLength) * 4);
+                    rxBeats.push_back({ TlpBuilder{}.length(tlpLength).data().tag(tag), address, uint32_t(~(address + w * 4)) });
+                }
+        };
+        auto pushReads = [&](size_t numWords, uint32_t base) {
+            for (size_t t = 0; t < numWords / tlpLength; ++t)
+            {
+                uint32_t address = uint32_t(base + params.addressOffset + t * tlpLength * 4);
+                rxBeats.push_back({ TlpBuilder{}.length(tlpLength).tag(tag), address, 0 });
+                expectedCpl.push_back({ tag, address, tlpLength });
+                tag++;
+            }
+        };
+
+        size_t numReadWords = params.numReadWords;
+        if (params.writesBehindReads)
+        {
+            pushReads(numReadWords / 2, 0x10000);
+            pushWrites();
+            pushReads(numReadWords / 2, 0x20000);
+        }
+        else
+        {
+            pushWrites();
+            pushReads(numReadWords, 0x10000);
+        }
+
+        std::map<uint32_t, uint32_t> written;
+        std::map<uint32_t, size_t> writeCount;
+        std::deque<std::pair<size_t, uint32_t>> slaveResponses;
+        size_t writeBeat = 0;
+        size_t cplOffset = 0;
+        size_t cplBeat = 0;
+        size_t firstRead = 0;
+        size_t lastCompletion = 0;
+        size_t receivedWords = 0;
+
+        for (size_t cycle = 0; cycle < params.maxCycles && (!rxBeats.empty() || !expectedCpl.empty()); ++cycle)
+        {
+            simu(*avmm.ready) = 1;
+            if (!slaveResponses.empty() && slaveResponses.front().first <= cycle)
+            {
+                simu(*avmm.readDataValid) = 1;
+                simu(*avmm.readData) = slaveResponses.front().second;
+                slaveResponses.pop_front();
+            }
+            else
+            {
+                simu(*avmm.readDataValid) = 0;
+            }
+
+            simu(*in.valid) = !rxBeats.empty();
+            if (!rxBeats.empty())
+            {
+                simu(inHeader) = rxBeats.front().header;
+                simu(inAddress) = rxBeats.front().address;
+                simu(in.data) = rxBeats.front().data;
+            }
+
+            // avalon slave
+            const size_t burstCount = burst ? size_t(simu(*avmm.burstCount)) : 1;
+            const uint32_t address = uint32_t(simu(avmm.address));
+            if (simu(*avmm.write))
+            {
+                const uint32_t beatAddress = uint32_t(address + writeBeat * 4);
+                written[beatAddress] = uint32_t(simu(*avmm.writeData));
+                writeCount[beatAddress]++;
+                if (++writeBeat == burstCount)
+                    writeBeat = 0;
+            }
+            if (simu(*avmm.read))
+            {
+                BOOST_TEST(burstCount <= maxBurst);
+                BOOST_TEST((address / 4) % maxBurst + burstCount <= maxBurst, "bursts must not cross the burst alignment");
+                if (firstRead == 0)
+                    firstRead = cycle;
+                for (size_t i = 0; i < burstCount; ++i)
+                    slaveResponses.emplace_back(cycle + params.slaveLatency, memContent(uint32_t(address + i * 4)));
+            }
+
+            if (!rxBeats.empty() && simu(*in.ready))
+                rxBeats.pop_front();
+
+            // completions
+            if (simu(*out.valid))
+            {
+                BOOST_REQUIRE(!expectedCpl.empty());
+                const Completion& cpl = expectedCpl.front();
+                const size_t remaining = cpl.length - cplOffset;
+                const size_t word = cpl.address / 4 + cplOffset;
+                const size_t length = std::min(remaining, cplWords - word % cplWords);
+
+                auto header = simu(out.header).eval();
+                uint64_t dw01 = header.extractNonStraddling(sim::DefaultConfig::VALUE, 0, 64);
+                uint64_t dw2 = header.extractNonStraddling(sim::DefaultConfig::VALUE, 64, 32);
+                BOOST_TEST(length <= maxPayloadWords, "completions must not exceed the max payload size");
+                BOOST_TEST(gtry::utils::bitfieldExtract(dw01, 0, 10) == (length & 0x3FF));
+                BOOST_TEST(gtry::utils::bitfieldExtract(dw01, 32, 12) == ((remaining * 4) & 0xFFF));
+                BOOST_TEST(gtry::utils::bitfieldExtract(dw2, 8, 8) == cpl.tag);
+                BOOST_TEST(gtry::utils::bitfieldExtract(dw2, 0, 7) == ((cpl.address + cplOffset * 4) & 0x7F));
+
+                BOOST_TEST(simu(*out.sop) == (cplBeat == 0));
+                BOOST_TEST(simu(*out.eop) == (cplBeat + 1 == length));
+                BOOST_TEST(simu(out.data) == memContent(uint32_t(cpl.address + (cplOffset + cplBeat) * 4)));
+                receivedWords++;
+                lastCompletion = cycle;
+
+                if (++cplBeat == length)
+                {
+                    // all but the last completion end on the read completion boundary
+                    if (length != remaining)
+                        BOOST_TEST((word + length) % 16 == 0);
+
+                    cplBeat = 0;
+                    cplOffset += length;
+                    if (cplOffset == cpl.length)
+                    {
+                        cplOffset = 0;
+                        expectedCpl.pop_front();
+                    }
+                }
+            }
+
+            co_await WaitClk(clock);
+        }
+        simu(*in.valid) = 0;
+        simu(*avmm.readDataValid) = 0;
+
+        BOOST_TEST(rxBeats.empty());
+        BOOST_TEST(expectedCpl.empty());
+        BOOST_TEST(receivedWords == numReadWords);
+        BOOST_TEST(written.size() == 2 * tlpLength);
+        for (size_t i = 0; i < 2 * tlpLength; ++i)
+        {
+            uint32_t address = uint32_t(writeAddress + i * 4);
+            BOOST_TEST(written[address] == uint32_t(~address));
+            BOOST_TEST(writeCount[address] == 1);
+        }
+
+        if (params.checkThroughput)
+        {
+            const double wordsPerCycle = double(receivedWords) / double(lastCompletion - firstRead + 1);
+            BOOST_TEST_MESSAGE("tlp length " << tlpLength << (burst ? " with" : " without") << " bursts: " << wordsPerCycle << " words per cycle");
+            // single word reads are limited by the pending transactions, bursts keep the slave busy
+            if (burst && tlpLength >= 4)
+                BOOST_TEST(wordsPerCycle > 0.8);
+            else
+                BOOST_TEST(wordsPerCycle < 0.6);
+        }
+        checked = true;
+    });
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+    runTicks(clock.getClk(), unsigned(params.maxCycles + 100));
+    BOOST_TEST(checked);
+}
+
+BOOST_DATA_TEST_CASE_F(AvmmBridgeFixture, pci_AvmmBridge_burstThroughput, data::make({ 1, 4, 16, 64 }) * data::make({ false, true }), tlpLength, burst)
+{
+    runBridge({ .tlpLength = size_t(tlpLength), .burst = burst, .checkThroughput = true });
+}
+
+BOOST_DATA_TEST_CASE_F(AvmmBridgeFixture, pci_AvmmBridge_unalignedCompletions, data::make({ 4, 16, 64 }) * data::make({ false, true }), tlpLength, burst)
+{
+    runBridge({ .tlpLength = size_t(tlpLength), .burst = burst, .addressOffset = 0x14, .numReadWords = 256 });
+}
+
+BOOST_DATA_TEST_CASE_F(AvmmBridgeFixture, pci_AvmmBridge_writeBehindReads, data::make({ 1, 16 }) * data::make({ false, true }), tlpLength, burst)
+{
+    runBridge({ .tlpLength = size_t(tlpLength), .burst = burst, .slaveLatency = 64, .numReadWords = 128, .writesBehindReads = true });
+}
+
+BOOST_DATA_TEST_CASE_F(AvmmBridgeFixture, pci_AvmmBridge_maxPayloadSize, data::make({ 16, 64 }) * data::make({ 0, 0x14 }), tlpLength, addressOffset)
+{
+    // the avalon bursts of up to 256 byte exceed the max payload size of 128 byte
+    runBridge({ .tlpLength = size_t(tlpLength), .burst = true, .burstCountWidth = 7_b, .maxPayloadSize = 128, .addressOffset = uint32_t(addressOffset), .numReadWords = 256 });
+}
@@ -25,6 +25,7 @@
 #include <gatery/simulation/Simulator.h>
 
 #include <gatery/scl/StreamArbiter.h>
+#include <gatery/scl/StreamPipeline.h>
 
 
 using namespace boost::unit_test;
@@ -221,3 +222,280 @@ BOOST_FIXTURE_TEST_CASE(arbitrateInOrder_fuzz, UnitTestSimulationFixture)
 
     runTicks(clock.getClk(), 256);
 }
+
+BOOST_DATA_TEST_CASE_F(UnitTestSimulationFixture, StreamRegisterSlice_fullThroughput, data::xrange(4), sliceType)
+{
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+    ClockScope clkScp(clock);
+
+    scl::Stream<BVec> in;
+    in.value() = pinIn(8_b).setName("in_data");
+    in.valid = pinIn().setName("in_valid");
+    in.ready = Bit{};
+    pinOut(*in.ready).setName("in_ready");
+
+    scl::Stream<BVec> out;
+    switch (sliceType)
+    {
+    case 0: out = scl::regForward(in); break;
+    case 1: out = scl::regReady(in); break;
+    case 2: out = scl::skidBuffer(in); break;
+    default: out = scl::regPipeline(in, 3); break;
+    }
+    pinOut(out.value()).setName("out_data");
+    pinOut(*out.valid).setName("out_valid");
+    *out.ready = pinIn().setName("out_ready");
+
+    bool checked = false;
+    addSimulationProcess([&]()->SimProcess {
+        std::mt19937 rng{ 2291 };
+        size_t sent = 0;
+        size_t received = 0;
+
+        for (size_t cycle = 0; cycle < 512; ++cycle)
+        {
+            // The first half streams continuously against random backpressure, the second half also randomizes valid.
+            bool continuous = cycle < 256;
+            simu(*out.ready) = rng() % 3 != 0;
+            simu(*in.valid) = continuous || rng() % 2 == 0;
+            simu(in.value()) = uint8_t(sent);
+
+            if (simu(*in.valid) && simu(*in.ready))
+                sent++;
+
+            // No bubbles, once filled the slice offers a beat in every cycle
+            if (continuous && cycle >= 8)
+                BOOST_TEST(simu(*out.valid) == 1);
+
+            if (simu(*out.valid) && simu(*out.ready))
+            {
+                BOOST_TEST(simu(out.value()) == uint8_t(received));
+                received++;
+            }
+
+            co_await WaitClk(clock);
+        }
+
+        BOOST_TEST(received > 256);
+        BOOST_TEST(sent - received <= 6);
+        checked = true;
+    });
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+
+    runTicks(clock.getClk(), 520);
+    BOOST_TEST(checked);
+}
+
+/// Inputs of an arbiter under test, beats carry the input index in the upper and a sequence number in the lower byte.
+struct ArbiterInputs
+{
+    ArbiterInputs(size_t count, bool packets)
+    {
+        in.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            in[i].value() = pinIn(16_b).setName("in_data_" + std::to_string(i));
+            in[i].valid = pinIn().setName("in_valid_" + std::to_string(i));
+            if (packets)
+                in[i].eop = pinIn().setName("in_eop_" + std::to_string(i));
+        }
+    }
+
+    void connect(scl::Stream<BVec>& arbitrated)
+    {
+        out = &arbitrated;
+        for (size_t i = 0; i < in.size(); ++i)
+            pinOut(*in[i].ready).setName("in_ready_" + std::to_string(i));
+        pinOut(out->value()).setName("out_data");
+        pinOut(*out->valid).setName("out_valid");
+        if (out->eop)
+            pinOut(*out->eop).setName("out_eop");
+        *out->ready = pinIn().setName("out_ready");
+    }
+
+    std::vector<scl::Stream<BVec>> in;
+    scl::Stream<BVec>* out = nullptr;
+};
+
+BOOST_FIXTURE_TEST_CASE(arbitrateRoundRobin_fairness, UnitTestSimulationFixture)
+{
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+    ClockScope clkScp(clock);
+
+    ArbiterInputs inputs{ 5, false };
+    auto out = scl::arbitrateRoundRobin(inputs.in);
+    inputs.connect(out);
+
+    bool checked = false;
+    addSimulationProcess([&]()->SimProcess {
+        simu(*out.ready) = 1;
+        for (size_t i = 0; i < inputs.in.size(); ++i)
+        {
+            simu(*inputs.in[i].valid) = i != 3;
+            simu(inputs.in[i].value()) = i << 8;
+        }
+
+        // All requesting inputs are granted in turn, the idle input 3 is skipped
+        const size_t expected[] = { 0, 1, 2, 4 };
+        for (size_t cycle = 0; cycle < 32; ++cycle)
+        {
+            BOOST_TEST(simu(*out.valid) == 1);
+            BOOST_TEST(simu(out.value()) >> 8 == expected[cycle % 4]);
+            co_await WaitClk(clock);
+        }
+
+        // Backpressure holds the grant
+        size_t granted = simu(out.value()) >> 8;
+        simu(*out.ready) = 0;
+        co_await WaitClk(clock);
+        BOOST_TEST(simu(out.value()) >> 8 == granted);
+        checked = true;
+    });
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+    runTicks(clock.getClk(), 40);
+    BOOST_TEST(checked);
+}
+
+BOOST_FIXTURE_TEST_CASE(arbitrateWeightedRoundRobin_shares, UnitTestSimulationFixture)
+{
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+    ClockScope clkScp(clock);
+
+    ArbiterInputs inputs{ 3, false };
+    auto out = scl::arbitrateWeightedRoundRobin(inputs.in, { 1, 2, 3 });
+    inputs.connect(out);
+
+    bool checked = false;
+    addSimulationProcess([&]()->SimProcess {
+        simu(*out.ready) = 1;
+        for (size_t i = 0; i < inputs.in.size(); ++i)
+        {
+            simu(*inputs.in[i].valid) = 1;
+            simu(inputs.in[i].value()) = i << 8;
+        }
+
+        const size_t expected[] = { 0, 1, 1, 2, 2, 2 };
+        for (size_t cycle = 0; cycle < 36; ++cycle)
+        {
+            BOOST_TEST(simu(out.value()) >> 8 == expected[cycle % 6]);
+            co_await WaitClk(clock);
+        }
+        checked = true;
+    });
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+    runTicks(clock.getClk(), 40);
+    BOOST_TEST(checked);
+}
+
+BOOST_FIXTURE_TEST_CASE(arbitrateWeightedRoundRobin_packetShares, UnitTestSimulationFixture)
+{
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+    ClockScope clkScp(clock);
+
+    ArbiterInputs inputs{ 2, true };
+    auto out = scl::arbitrateWeightedRoundRobin(inputs.in, { 1, 2 }, true);
+    inputs.connect(out);
+
+    bool checked = false;
+    addSimulationProcess([&]()->SimProcess {
+        simu(*out.ready) = 1;
+        std::vector<size_t> sent(inputs.in.size());
+
+        // With locked packets the weights count packets of two beats each
+        const size_t expected[] = { 0, 0, 1, 1, 1, 1 };
+        for (size_t cycle = 0; cycle < 36; ++cycle)
+        {
+            for (size_t i = 0; i < inputs.in.size(); ++i)
+            {
+                simu(*inputs.in[i].valid) = 1;
+                simu(inputs.in[i].value()) = i << 8;
+                simu(*inputs.in[i].eop) = sent[i] % 2 == 1;
+            }
+            BOOST_TEST(simu(out.value()) >> 8 == expected[cycle % 6]);
+            for (size_t i = 0; i < inputs.in.size(); ++i)
+                if (simu(*inputs.in[i].ready))
+                    sent[i]++;
+            co_await WaitClk(clock);
+        }
+        checked = true;
+    });
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+    runTicks(clock.getClk(), 40);
+    BOOST_TEST(checked);
+}
+
+BOOST_DATA_TEST_CASE_F(UnitTestSimulationFixture, arbitrateRoundRobinTree_fuzz, data::make({ 0, 1, 2 }), registerInterval)
+{
+    Clock clock(ClockConfig{}.setAbsoluteFrequency(100'000'000).setName("clock"));
+    ClockScope clkScp(clock);
+
+    const size_t numInputs = 32;
+    const size_t packetLength = 3;
+    ArbiterInputs inputs{ numInputs, true };
+    auto out = scl::arbitrateRoundRobinTree(inputs.in, true, registerInterval);
+    inputs.connect(out);
+
+    bool checked = false;
+    addSimulationProcess([&]()->SimProcess {
+        std::mt19937 rng{ 5519 };
+        std::vector<size_t> sent(numInputs);
+        std::vector<size_t> received(numInputs);
+        size_t packetOwner = numInputs;
+        size_t transfers = 0;
+
+        for (size_t cycle = 0; cycle < 1024; ++cycle)
+        {
+            // Continuous requests in the first half to check for bubbles, random ones afterwards
+            bool continuous = cycle < 512;
+            simu(*out.ready) = continuous || rng() % 4 != 0;
+            for (size_t i = 0; i < numInputs; ++i)
+            {
+                simu(*inputs.in[i].valid) = continuous || rng() % 2 == 0;
+                simu(inputs.in[i].value()) = (i << 8) | (sent[i] & 0xFF);
+                simu(*inputs.in[i].eop) = sent[i] % packetLength == packetLength - 1;
+            }
+
+            for (size_t i = 0; i < numInputs; ++i)
+                if (simu(*inputs.in[i].valid) && simu(*inputs.in[i].ready))
+                    sent[i]++;
+
+            if (continuous && cycle >= 16)
+                BOOST_TEST(simu(*out.valid) == 1);
+
+            if (simu(*out.valid) && simu(*out.ready))
+            {
+                size_t value = simu(out.value());
+                size_t input = value >> 8;
+                BOOST_REQUIRE(input < numInputs);
+                BOOST_TEST((value & 0xFF) == (received[input] & 0xFF));
+                received[input]++;
+                transfers++;
+
+                // packets are never interleaved
+                if (packetOwner != numInputs)
+                    BOOST_TEST(input == packetOwner);
+                packetOwner = simu(*out.eop) ? numInputs : input;
+            }
+
+            // Every input got its share of packets while all were requesting
+            if (cycle == 511)
+                for (size_t i = 0; i < numInputs; ++i)
+                    BOOST_TEST(received[i] >= 12);
+
+            co_await WaitClk(clock);
+        }
+
+        for (size_t i = 0; i < numInputs; ++i)
+            BOOST_TEST(received[i] >= 16);
+        BOOST_TEST(transfers > 700);
+        checked = true;
+    });
+
+    design.getCircuit().postprocess(gtry::DefaultPostprocessing{});
+    runTicks(clock.getClk(), 1030);
+    BOOST_TEST(checked);
+}